@@ -5,6 +5,8 @@ namespace DJMixMaster.Audio.Managers
 {
     public class CuePointManager
     {
+        private const int MaxHotCues = 32;
+
         private readonly ILogger<CuePointManager> _logger;
 
         public CuePointManager(ILogger<CuePointManager> logger)
@@ -17,7 +19,16 @@ namespace DJMixMaster.Audio.Managers
             try
             {
                 _logger.LogInformation($"Adding cue point for deck {deckNumber}");
-                // TODO: Implement cue points in JUCE
+                // Use the first free hot cue slot at the current position
+                for (int index = 0; index < MaxHotCues; index++)
+                {
+                    if (ShredEngineInterop.GetHotCue(deckNumber, index) < 0)
+                    {
+                        ShredEngineInterop.SetHotCue(deckNumber, index);
+                        return;
+                    }
+                }
+                _logger.LogWarning($"All {MaxHotCues} hot cues are in use on deck {deckNumber}");
             }
             catch (Exception ex)
             {
@@ -31,7 +42,7 @@ namespace DJMixMaster.Audio.Managers
             try
             {
                 _logger.LogInformation($"Jumping to cue point {cueIndex} for deck {deckNumber}");
-                // TODO: Implement cue point jumping in JUCE
+                ShredEngineInterop.JumpToHotCue(deckNumber, cueIndex);
             }
             catch (Exception ex)
             {
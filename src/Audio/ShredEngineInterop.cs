@@ -126,6 +126,9 @@ namespace DJMixMaster.Audio
         [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
         public static extern void SetAutoGainReductionEnabled(bool enabled);
 
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void SetTruePeakLimiterEnabled(bool enabled);
+
         [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
         public static extern void SetBrickwallLimiterEnabled(bool enabled);
 
@@ -151,9 +154,391 @@ namespace DJMixMaster.Audio
         [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
         public static extern float GetCurrentRmsLevel();
 
+        // Output true peak, linear (20*log10 for dBTP)
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern float GetTruePeakLevel();
+
+        // Master loudness in LUFS (BS.1770), floored at -70
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern float GetMomentaryLoudness();
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern float GetShortTermLoudness();
+
         [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
         public static extern bool IsClipping();
 
+        // Frames the look-ahead limiter delays the master by (0 when off)
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int GetLimiterLatency();
+
+        // Track prefetch
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void HintTrack(string filePath, int priority);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void ClearTrackHints();
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        [return: MarshalAs(UnmanagedType.I1)]
+        public static extern bool IsTrackPrefetched(string filePath);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void SetPrefetchMemoryBudget(int megabytes);
+
+        // Engine stats
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern float GetAudioLoad();
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern float GetAudioLoadPeak();
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern float GetOutputDspLoad();
+
+        // Track memory locking and audio-thread page faults
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void SetTrackMemoryLocking(bool enabled);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern long GetAudioMinorFaults();
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern long GetAudioMajorFaults();
+
+        // Variable speed (rate -2.0..2.0; mode 0=linear, 1=Hermite, 2=sinc)
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void SetPlaybackRate(int deck, double ratio);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern double GetPlaybackRate(int deck);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void SetInterpolationMode(int deck, int mode);
+
+        // Key-lock (mode 0=WSOLA, 1=phase vocoder; latency in ms)
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void SetKeyLock(int deck, bool enabled);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void SetKeyLockMode(int deck, int mode);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern double GetKeyLockLatency(int deck);
+
+        // Key shift in semitones (-12..12); load is a fraction of block time
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void SetKeyShift(int deck, double semitones);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern double GetKeyShift(int deck);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern float GetKeyShiftLoad(int deck);
+
+        // Scratch (jog position in seconds of audio, velocity as a rate; up to 1 kHz)
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void JogTouch(int deck, bool touched);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void JogPosition(int deck, double seconds);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void JogVelocity(int deck, double ratio);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void VinylBrake(int deck, double seconds);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void VinylSpinback(int deck, double speed, double seconds);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void SetPlatterInertia(int deck, double seconds);
+
+        // Loops (points in frames; beat loops use the deck's beat grid)
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void SetBeatGrid(int deck, double bpm, double firstBeatSeconds);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void LoopIn(int deck);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void LoopOut(int deck);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void SetLoop(int deck, long inFrame, long outFrame);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void BeatLoop(int deck, double beats);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void LoopRoll(int deck, double beats);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void LoopRollRelease(int deck);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void LoopHalve(int deck);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void LoopDouble(int deck);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void LoopExit(int deck);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void Reloop(int deck);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern long GetLoopIn(int deck);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern long GetLoopOut(int deck);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        [return: MarshalAs(UnmanagedType.I1)]
+        public static extern bool IsLoopActive(int deck);
+
+        // Hot cues (index 0..31, seconds; -1 when unset)
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void SetHotCue(int deck, int index);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void SetHotCueAt(int deck, int index, double seconds);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void ClearHotCue(int deck, int index);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void JumpToHotCue(int deck, int index);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern double GetHotCue(int deck, int index);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void SetQuantize(int deck, bool enabled);
+
+        // Transport crossfade on play/pause/seek/load in ms (0..5, 0 = off)
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void SetTransportFade(int deck, double ms);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern double GetTransportFade(int deck);
+
+        // Slip mode (slip position in seconds, -1 when not slipping)
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void SetSlip(int deck, bool enabled);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        [return: MarshalAs(UnmanagedType.I1)]
+        public static extern bool GetSlip(int deck);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void SetReverse(int deck, bool enabled);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void ReleaseHotCue(int deck);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern double GetSlipPosition(int deck);
+
+        // Master clock and sync (leader 0 = internal; state 0=off, 1=no grid,
+        // 2=locking, 3=locked; phase error in beats)
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void SetMasterTempo(double bpm);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern double GetMasterTempo();
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern double GetMasterBeat();
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void SetSyncLeader(int deck);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int GetSyncLeader();
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void SetSync(int deck, bool enabled);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int GetSyncState(int deck);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern double GetPhaseError(int deck);
+
+        // Scheduled actions (action 0=play, 1=pause, 2=cue, 3=hot cue, 4=beat loop,
+        // 5=loop exit, 6=reloop; time base 0=engine frame, 1=master beat, 2=next N beats)
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        [return: MarshalAs(UnmanagedType.I1)]
+        public static extern bool ScheduleAction(int deck, int action, double value, int timeBase, double time);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void CancelScheduledActions(int deck);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern long GetEngineFrame();
+
+        // Stems (0-based, gain 0..2; count 0 for a plain stereo track)
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int GetStemCount(int deck);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void SetStemGain(int deck, int stem, float gain);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void SetStemMute(int deck, int stem, bool muted);
+
+        // Sampler (slots 0-based, gain 0..2, pitch in semitones -24..24)
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int LoadSample(int slot, string filePath);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void ClearSample(int slot);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        [return: MarshalAs(UnmanagedType.I1)]
+        public static extern bool TriggerSample(int slot, float gain, double semitones);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void StopSample(int slot);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void StopAllSamples();
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void SetSamplerVolume(float volume);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int GetSamplerSlotCount();
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int GetSamplerVoices();
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern long GetSamplerStolenVoices();
+
+        // Auto-DJ (seconds; outro -1 = mix out at the end; current deck 0 when off)
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void AutoDjEnqueue(string filePath, double introSeconds, double outroSeconds);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void AutoDjClearQueue();
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int AutoDjGetQueueLength();
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void AutoDjSetCrossfade(double seconds);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        [return: MarshalAs(UnmanagedType.I1)]
+        public static extern bool AutoDjStart(int deck, double outroSeconds);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void AutoDjStop();
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int AutoDjGetCurrentDeck();
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern long AutoDjGetHandovers();
+
+        // Channel EQ (band 0=low, 1=mid, 2=high; gain 0..2; mode 0=biquad, 1=Linkwitz-Riley)
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void SetEqGain(int deck, int band, float gain);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern float GetEqGain(int deck, int band);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void SetEqKill(int deck, int band, bool killed);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void SetEqMode(int mode);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void SetEqCrossovers(float lowHz, float highHz);
+
+        // Channel filter (position -1..1: low-pass left, high-pass right, 0 = off; resonance 0..1)
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void SetFilter(int deck, float position);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern float GetFilter(int deck);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void SetFilterResonance(int deck, float resonance);
+
+        // Effects (deck 0 = master; slots 0..2; type 0=none, 1=echo, 2=reverb, 3=flanger, 4=phaser, 5=convolution; mix and parameters 0..1)
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        [return: MarshalAs(UnmanagedType.I1)]
+        public static extern bool SetEffect(int deck, int slot, int type);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        [return: MarshalAs(UnmanagedType.I1)]
+        public static extern bool LoadConvolution(int deck, int slot, string filePath);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int GetEffect(int deck, int slot);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void SetEffectEnabled(int deck, int slot, bool enabled);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        [return: MarshalAs(UnmanagedType.I1)]
+        public static extern bool IsEffectEnabled(int deck, int slot);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void SetEffectMix(int deck, int slot, float mix);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void SetEffectParameter(int deck, int slot, int index, float value);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern float GetEffectParameter(int deck, int slot, int index);
+
+        // Headphone cue on output channels 3-4 (mix 0 = cue .. 1 = master; volume 0..2; split = cue left, master right)
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void SetCue(int deck, bool cued);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        [return: MarshalAs(UnmanagedType.I1)]
+        public static extern bool IsCued(int deck);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void SetCueMix(float mix);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void SetCueVolume(float gain);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void SetSplitCue(bool split);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        [return: MarshalAs(UnmanagedType.I1)]
+        public static extern bool HasCueOutput();
+
+        // Secondary outputs on other devices (source 0 = master, 1 = cue; returns output 1..4, 0 on failure)
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern int OpenSecondaryOutput(int device, int source);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern void CloseSecondaryOutput(int output);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern float GetSecondaryOutputFill(int output);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern double GetSecondaryOutputRatio(int output);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern long GetSecondaryOutputUnderruns(int output);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern long GetSecondaryOutputOverruns(int output);
+
         [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
         public static extern void ShutdownEngine();
 
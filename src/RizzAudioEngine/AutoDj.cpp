@@ -0,0 +1,223 @@
+#include "AutoDj.h"
+#include "ScratchBuffer.h"
+#include "CrateDigger.h"
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+
+// The audio thread never signals the worker, so it looks for a finished
+// handover this often; the next track only has to be ready by the next outro
+static const std::chrono::milliseconds kPollInterval(20);
+// Shortest handover, so even a gapless cut doesn't click (~3 ms)
+static const int kMinFadeFrames = 128;
+
+static float crossfaderSide(int deck) {
+    return deck == 0 ? -1.0f : 1.0f;
+}
+
+AutoDj::AutoDj(ScratchBuffer* deck1, ScratchBuffer* deck2, CrateDigger* crateDigger)
+    : m_crateDigger(crateDigger), m_running(true), m_active(false), m_current(0), m_armed(false), m_fading(false),
+      m_fadeFrames(kMinFadeFrames), m_crossfader(-1.0f), m_handovers(0), m_fadeStart(0), m_fadeLength(kMinFadeFrames),
+      m_fadeFrom(-1.0f), m_fadeTo(1.0f) {
+    m_decks[0] = deck1;
+    m_decks[1] = deck2;
+    m_outro[0] = m_outro[1] = -1.0;
+    m_worker = std::thread(&AutoDj::workerLoop, this);
+    std::cout << "[AutoDj] Created" << std::endl;
+}
+
+AutoDj::~AutoDj() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_running = false;
+    }
+    m_wake.notify_all();
+    if (m_worker.joinable()) {
+        m_worker.join();
+    }
+    std::cout << "[AutoDj] Destroyed" << std::endl;
+}
+
+void AutoDj::enqueue(const std::string& filePath, double introSeconds, double outroSeconds) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        // Prefetch in queue order so the next track is decoded well ahead
+        if (m_crateDigger) m_crateDigger->hint(filePath, (int)m_queue.size());
+        m_queue.push_back({filePath, std::max(0.0, introSeconds), outroSeconds});
+    }
+    m_wake.notify_all();
+    std::cout << "[AutoDj] Queued " << filePath << std::endl;
+}
+
+void AutoDj::clearQueue() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_queue.clear();
+}
+
+int AutoDj::getQueueLength() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return (int)m_queue.size();
+}
+
+void AutoDj::setCrossfade(double seconds) {
+    seconds = std::max(0.0, std::min(30.0, seconds));
+    m_fadeFrames.store(std::max(kMinFadeFrames, (int)(seconds * 44100.0)), std::memory_order_relaxed);
+}
+
+double AutoDj::getCrossfade() const {
+    int frames = m_fadeFrames.load(std::memory_order_relaxed);
+    return frames <= kMinFadeFrames ? 0.0 : frames / 44100.0;
+}
+
+bool AutoDj::start(int deck, double outroSeconds) {
+    if (deck < 0 || deck > 1 || !m_decks[deck] || m_decks[deck]->getLength() <= 0.0) {
+        return false;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_outro[deck] = outroSeconds;
+        m_armed.store(false, std::memory_order_relaxed);
+        m_fading.store(false, std::memory_order_relaxed);
+        m_current.store(deck, std::memory_order_relaxed);
+        m_crossfader.store(crossfaderSide(deck), std::memory_order_relaxed);
+        m_active.store(true, std::memory_order_release);
+    }
+    m_decks[deck]->play();
+    m_wake.notify_all();
+    std::cout << "[AutoDj] Started on deck " << (deck + 1) << std::endl;
+    return true;
+}
+
+void AutoDj::stop() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_active.store(false, std::memory_order_relaxed);
+    m_armed.store(false, std::memory_order_relaxed);
+    for (ScratchBuffer* deck : m_decks) {
+        if (deck) deck->setOutroPoint(-1);
+    }
+    std::cout << "[AutoDj] Stopped" << std::endl;
+}
+
+bool AutoDj::isActive() const {
+    return m_active.load(std::memory_order_relaxed);
+}
+
+int AutoDj::getCurrentDeck() const {
+    return m_active.load(std::memory_order_relaxed) ? m_current.load(std::memory_order_relaxed) : -1;
+}
+
+float AutoDj::getCrossfader() const {
+    return m_crossfader.load(std::memory_order_relaxed);
+}
+
+uint64_t AutoDj::getHandovers() const {
+    return m_handovers.load(std::memory_order_relaxed);
+}
+
+void AutoDj::workerLoop() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (m_running) {
+        m_wake.wait_for(lock, kPollInterval);
+        if (!m_running) break;
+        // Arm once the last handover's crossfade is over and the idle deck is free
+        if (!m_active.load(std::memory_order_relaxed) || m_armed.load(std::memory_order_relaxed) ||
+            m_fading.load(std::memory_order_relaxed) || m_queue.empty()) {
+            continue;
+        }
+        Entry entry = m_queue.front();
+        m_queue.pop_front();
+        if (!m_queue.empty() && m_crateDigger) m_crateDigger->hint(m_queue.front().path, 0);
+
+        lock.unlock();
+        auto start = std::chrono::steady_clock::now();
+        bool armed = arm(entry);
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+        lock.lock();
+        if (armed) {
+            std::cout << "[AutoDj] Armed " << entry.path << " (" << elapsed.count() << " ms)" << std::endl;
+        } else {
+            std::cout << "[AutoDj] Skipping " << entry.path << ": could not load" << std::endl;
+        }
+    }
+}
+
+bool AutoDj::arm(const Entry& entry) {
+    int current = m_current.load(std::memory_order_relaxed);
+    ScratchBuffer* playing = m_decks[current];
+    ScratchBuffer* idle = m_decks[1 - current];
+    if (!playing || !idle) return false;
+
+    std::shared_ptr<const DecodedTrack> track = m_crateDigger ? m_crateDigger->take(entry.path) : nullptr;
+    if (!track) track = ScratchBuffer::decodeFile(entry.path);
+    if (!track) return false;
+
+    idle->pause();
+    if (!idle->loadTrack(track)) return false;
+    idle->seek((long)(entry.intro * 44100.0));
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_active.load(std::memory_order_relaxed) || m_current.load(std::memory_order_relaxed) != current) {
+        return false;   // stopped or restarted while decoding
+    }
+    m_outro[1 - current] = entry.outro;
+    // Armed before the outro point is set, so a point already behind the
+    // play head hands over at once rather than being missed
+    m_armed.store(true, std::memory_order_release);
+    playing->setOutroPoint(outroFrame(playing, m_outro[current]));
+    return true;
+}
+
+int64_t AutoDj::outroFrame(ScratchBuffer* deck, double outroSeconds) const {
+    int64_t length = (int64_t)(deck->getLength() * 44100.0);
+    if (outroSeconds < 0.0) {
+        return std::max<int64_t>(0, length - m_fadeFrames.load(std::memory_order_relaxed));
+    }
+    return std::min<int64_t>(length, (int64_t)(outroSeconds * 44100.0));
+}
+
+int AutoDj::leadDeck() const {
+    return m_active.load(std::memory_order_relaxed) ? m_current.load(std::memory_order_relaxed) : 0;
+}
+
+void AutoDj::handover() {
+    if (!m_armed.load(std::memory_order_acquire)) return;
+    int current = m_current.load(std::memory_order_relaxed);
+    int64_t frame = 0;
+    if (!m_decks[current]->takeOutroCrossing(frame)) return;
+    if (!m_active.load(std::memory_order_relaxed)) return;
+
+    // The incoming deck renders after this, so its start lands in this block
+    int next = 1 - current;
+    int fade = m_fadeFrames.load(std::memory_order_relaxed);
+    m_decks[next]->schedule(ScratchBuffer::ACTION_PLAY, 0.0, ScratchBuffer::SCHEDULE_FRAME, (double)frame);
+    m_decks[current]->schedule(ScratchBuffer::ACTION_PAUSE, 0.0, ScratchBuffer::SCHEDULE_FRAME, (double)(frame + fade));
+    m_fadeStart = frame;
+    m_fadeLength = fade;
+    m_fadeFrom = crossfaderSide(current);
+    m_fadeTo = crossfaderSide(next);
+    m_current.store(next, std::memory_order_relaxed);
+    m_armed.store(false, std::memory_order_relaxed);
+    m_fading.store(true, std::memory_order_relaxed);
+    m_handovers.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool AutoDj::crossfader(int64_t blockStart, int frames, float* positions) {
+    if (!m_active.load(std::memory_order_relaxed)) return false;
+    if (!m_fading.load(std::memory_order_relaxed)) {
+        std::fill(positions, positions + frames, m_crossfader.load(std::memory_order_relaxed));
+        return true;
+    }
+    // Linear across the fade, starting on the handover frame
+    float span = m_fadeTo - m_fadeFrom;
+    double scale = 1.0 / m_fadeLength;
+    for (int i = 0; i < frames; ++i) {
+        double t = (double)(blockStart + i - m_fadeStart) * scale;
+        t = std::max(0.0, std::min(1.0, t));
+        positions[i] = m_fadeFrom + span * (float)t;
+    }
+    if (blockStart + frames >= m_fadeStart + m_fadeLength) {
+        m_fading.store(false, std::memory_order_relaxed);
+    }
+    m_crossfader.store(positions[frames - 1], std::memory_order_relaxed);
+    return true;
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <string>
+#include <deque>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <cstdint>
+
+class ScratchBuffer;
+class CrateDigger;
+
+// Unattended playback across the two decks. A worker decodes the next queued
+// track onto the idle deck, cued to its intro, and arms the playing deck's
+// outro point. The handover itself happens on the audio thread: when the
+// outro is reached the idle deck starts on that exact frame and the
+// crossfader moves over, so a busy UI can't delay or gap it.
+class AutoDj {
+public:
+    AutoDj(ScratchBuffer* deck1, ScratchBuffer* deck2, CrateDigger* crateDigger);
+    ~AutoDj();
+
+    // Control side. Intro and outro in seconds; outro < 0 mixes out so the
+    // crossfade ends on the track's last frame.
+    void enqueue(const std::string& filePath, double introSeconds, double outroSeconds);
+    void clearQueue();
+    int getQueueLength() const;
+    // Crossfade length in seconds (0..30); 0 is a gapless cut
+    void setCrossfade(double seconds);
+    double getCrossfade() const;
+    // deck: 0 or 1, the deck whose loaded track plays first
+    bool start(int deck, double outroSeconds);
+    void stop();
+    bool isActive() const;
+    int getCurrentDeck() const;   // -1 when stopped
+    float getCrossfader() const;  // -1 = deck 1, 1 = deck 2
+    uint64_t getHandovers() const;
+
+    // Audio thread. Render leadDeck() first, then call handover() before
+    // rendering the other deck so a handover lands in the same block.
+    int leadDeck() const;
+    void handover();
+    // Crossfader position for each frame of the block, false when stopped
+    bool crossfader(int64_t blockStart, int frames, float* positions);
+
+private:
+    struct Entry {
+        std::string path;
+        double intro;
+        double outro;
+    };
+
+    void workerLoop();
+    bool arm(const Entry& entry);
+    int64_t outroFrame(ScratchBuffer* deck, double outroSeconds) const;
+
+    ScratchBuffer* m_decks[2];
+    CrateDigger* m_crateDigger;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::thread m_worker;
+    bool m_running;
+    std::deque<Entry> m_queue;
+    double m_outro[2];   // outro of the track queued onto each deck
+
+    std::atomic<bool> m_active;
+    std::atomic<int> m_current;
+    std::atomic<bool> m_armed;     // next track loaded and outro point set
+    std::atomic<bool> m_fading;    // audio thread: handover crossfade running
+    std::atomic<int> m_fadeFrames;
+    std::atomic<float> m_crossfader;
+    std::atomic<uint64_t> m_handovers;
+
+    // Audio thread only
+    int64_t m_fadeStart;
+    int m_fadeLength;
+    float m_fadeFrom;
+    float m_fadeTo;
+};
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cmath>
+
+// Constant-tempo beat grid for a loaded track: tempo plus the frame of one
+// beat. bpm == 0 means the track has no grid yet.
+struct BeatGrid {
+    double bpm = 0.0;
+    double firstBeat = 0.0;   // frames at 44.1 kHz
+
+    bool valid() const { return bpm > 0.0; }
+    double framesPerBeat() const { return 44100.0 * 60.0 / bpm; }
+    double beatAt(double frame) const { return (frame - firstBeat) / framesPerBeat(); }
+    double frameAt(double beat) const { return firstBeat + beat * framesPerBeat(); }
+    // Last grid line at or before `frame`, with lines every `beats` beats
+    double snapBack(double frame, double beats) const {
+        return frameAt(std::floor(beatAt(frame) / beats + 1e-6) * beats);
+    }
+};
@@ -1,8 +1,11 @@
 #include "ClubMixer.h"
+#include "EngineStats.h"
+#include "MasterClock.h"
 #include <iostream>
 #include <algorithm>
 #include <cmath>
 #include <fstream>
+#include <chrono>
 
 static std::ofstream mixerLog("logs/clubmixer.log", std::ios::app);
 
@@ -13,38 +16,42 @@ ClubMixer::ClubMixer() : m_crossfader(0.0f), m_masterVolume(1.0f), m_curveType(0
     m_volumes[0] = 1.0f;
     m_volumes[1] = 1.0f;
 
-    // Initialize clipping protection parameters
-    m_clippingProtectionEnabled = true; // Re-enable DSP for production use
+    // Initialize clipping protection parameters. The chain starts with
+    // protection on: soft knee, brickwall and peak detection; threshold 0.9,
+    // 2:1 compression, 1 ms attack and 100 ms release.
     m_deckVolumeCapEnabled = false; // Disable artificial cap, use full range + limiter
-    m_peakDetectionEnabled = true;
-    m_softKneeCompressorEnabled = true;
-    m_lookAheadLimiterEnabled = false;
     m_rmsMonitoringEnabled = false;
-    m_autoGainReductionEnabled = false;
-    m_brickwallLimiterEnabled = true; // Enable master brickwall limiter
-    m_clippingIndicatorEnabled = false;
-
-    // Initialize thresholds
-    m_clippingThreshold = 0.9f;
-    m_compressorRatio = 2.0f; // Less aggressive compression
-    m_limiterAttackTime = 0.001f; // 1ms
-    m_limiterReleaseTime = 0.1f;   // 100ms
 
     std::cout << "[ClubMixer] Boot finish: Mixer components initialized" << std::endl;
 
     // Initialize monitoring state
-    m_currentPeakLevel = 0.0f;
-    m_currentRmsLevel = 0.0f;
-    m_isClipping = false;
+    m_currentRmsLevel.store(0.0f);
+    m_truePeakLevel.store(0.0f);
+    m_outputLoad = 0.0f;
+    m_clock = nullptr;
+    m_effectContext = {120.0, 0.0};
+    for (int deck = 0; deck < DjEq::kMaxDecks; ++deck) {
+        m_cued[deck].store(false);
+        m_cueGains[deck] = 0.0f;
+    }
+    m_cueMix.store(0.0f);
+    m_cueVolume.store(1.0f);
+    m_splitCue.store(false);
+    m_cueMixUsed = 0.0f;
+    m_cueVolumeUsed = 1.0f;
+    m_cueDelayLeft.assign(kCueDelaySize, 0.0f);
+    m_cueDelayRight.assign(kCueDelaySize, 0.0f);
+    m_cueDelayWrite = 0;
+    m_cueDelay = 0;
 
     // Initialize buffer sizes
-    m_lookAheadSamples = 512; // ~11.6ms at 44.1kHz
     m_rmsWindowSize = 441;    // ~10ms at 44.1kHz
-    m_autoGainReduction = 1.0f;
 
     // Initialize buffers
-    m_lookAheadBuffer.resize(m_lookAheadSamples, 0.0f);
     m_rmsWindow.resize(m_rmsWindowSize, 0.0f);
+    m_rmsPosition = 0;
+    m_rmsSum = 0.0;
+    initLoudness();
 
     std::cout << "[ClubMixer] Initialized with crossfader=0.0, masterVolume=1.0, volumes[0]=1.0, volumes[1]=1.0, curve=0" << std::endl;
     std::cout << "[ClubMixer] Clipping protection enabled with deck volume cap and peak detection" << std::endl;
@@ -57,57 +64,136 @@ ClubMixer::~ClubMixer() {
 void ClubMixer::mix(float* left, float* right, int frames) {
     // Crossfader as volume control: attenuates decks based on position
     // crossfader -1: left full, right off; 0: both full; 1: left off, right full
+    float left_raw = 1.0f - std::max(0.0f, m_crossfader);
+    float right_raw = 1.0f - std::max(0.0f, -m_crossfader);
+    // Apply curve (0=linear, 1=exponential, etc.)
+    float leftGain = m_volumes[0] * applyCurve(left_raw, m_curveType);
+    float rightGain = m_volumes[1] * applyCurve(right_raw, m_curveType);
     for (int i = 0; i < frames; ++i) {
-        float left_raw = 1.0f - std::max(0.0f, m_crossfader);
-        float right_raw = 1.0f - std::max(0.0f, -m_crossfader);
-        // Apply curve (0=linear, 1=exponential, etc.)
-        float left_cross_gain = applyCurve(left_raw, m_curveType);
-        float right_cross_gain = applyCurve(right_raw, m_curveType);
-
-        // Apply basic mixing
-        float l = left[i] * m_volumes[0] * left_cross_gain;
-        float r = right[i] * m_volumes[1] * right_cross_gain;
-
-        // Apply clipping protection if enabled
-        if (m_clippingProtectionEnabled) {
-            // Note: Deck volume cap removed - users control full 0-100% range
-            // Clipping protection handled by DSP algorithms below
-
-            // 2. Soft knee compression
-            if (m_softKneeCompressorEnabled) {
-                applySoftKneeCompressor(l, r);
-            }
+        left[i] *= leftGain;
+        right[i] *= rightGain;
+    }
 
-            // 3. Look-ahead limiting (requires buffering)
-            if (m_lookAheadLimiterEnabled) {
-                applyLookAheadLimiter(l, r);
-            }
+    // Note: Deck volume cap removed - users control full 0-100% range
+    // Clipping protection handled by the protection chain
+    m_protection.process({left, right, frames});
 
-            // 4. Brickwall limiting (hard limiting as final safety)
-            if (m_brickwallLimiterEnabled) {
-                applyBrickwallLimiter(l, r);
-            }
+    // Apply master volume
+    for (int i = 0; i < frames; ++i) {
+        left[i] *= m_masterVolume;
+        right[i] *= m_masterVolume;
+    }
 
-            // 5. Update monitoring
-            if (m_peakDetectionEnabled) {
-                updatePeakDetection(l, r);
-            }
-            if (m_rmsMonitoringEnabled) {
-                updateRmsMonitoring(l, r);
-            }
-            if (m_clippingIndicatorEnabled) {
-                updateClippingIndicator(l, r);
-            }
+    if (m_protection.isEnabled(ProtectionChain::PROTECTION) && m_rmsMonitoringEnabled) {
+        updateRmsMonitoring(left, right, frames);
+    }
+}
 
-            // 6. Auto gain reduction (if clipping detected)
-            if (m_autoGainReductionEnabled) {
-                applyAutoGainReduction(l, r);
-            }
+void ClubMixer::applyChannelDsp(float* const* left, float* const* right, int decks, int frames) {
+    m_eq.process(left, right, decks, frames);
+    for (int deck = 0; deck < std::min(decks, DjEq::kMaxDecks); ++deck) {
+        if (left[deck] && right[deck]) m_filters[deck].process(left[deck], right[deck], frames);
+    }
+
+    // The clock hasn't moved yet, so this is where the block starts on the
+    // beat grid; the master rack reuses it once the bus is mixed
+    if (m_clock && m_clock->bpm() > 0.0) {
+        m_effectContext = {m_clock->bpm(), m_clock->beat()};
+    } else {
+        m_effectContext = {120.0, m_effectContext.beat + frames * 120.0 / (60.0 * 44100.0)};
+    }
+    for (int deck = 0; deck < std::min(decks, DjEq::kMaxDecks); ++deck) {
+        if (left[deck] && right[deck]) m_channelEffects[deck].process(left[deck], right[deck], frames, m_effectContext);
+    }
+}
+
+void ClubMixer::setCue(int deck, bool cued) {
+    if (deck < 0 || deck >= DjEq::kMaxDecks) return;
+    m_cued[deck].store(cued, std::memory_order_relaxed);
+}
+
+bool ClubMixer::isCued(int deck) const {
+    if (deck < 0 || deck >= DjEq::kMaxDecks) return false;
+    return m_cued[deck].load(std::memory_order_relaxed);
+}
+
+void ClubMixer::setCueMix(float mix) {
+    m_cueMix.store(std::max(0.0f, std::min(1.0f, mix)), std::memory_order_relaxed);
+}
+
+void ClubMixer::setCueVolume(float gain) {
+    m_cueVolume.store(std::max(0.0f, std::min(2.0f, gain)), std::memory_order_relaxed);
+}
+
+void ClubMixer::renderCue(const float* const* left, const float* const* right, int decks, const float* masterLeft,
+                          const float* masterRight, float* cueLeft, float* cueRight, int frames) {
+    if (frames <= 0) return;
+    const float scale = 1.0f / frames;
+    std::fill(cueLeft, cueLeft + frames, 0.0f);
+    std::fill(cueRight, cueRight + frames, 0.0f);
+
+    // Pre-fader sum of the cued decks
+    for (int deck = 0; deck < std::min(decks, DjEq::kMaxDecks); ++deck) {
+        float target = m_cued[deck].load(std::memory_order_relaxed) ? 1.0f : 0.0f;
+        float gain = m_cueGains[deck];
+        m_cueGains[deck] = target;
+        if ((gain == 0.0f && target == 0.0f) || !left[deck] || !right[deck]) continue;
+        float step = (target - gain) * scale;
+        for (int i = 0; i < frames; ++i) {
+            gain += step;
+            cueLeft[i] += left[deck][i] * gain;
+            cueRight[i] += right[deck][i] * gain;
         }
+    }
 
-        // Apply master volume
-        left[i] = l * m_masterVolume;
-        right[i] = r * m_masterVolume;
+    delayCue(cueLeft, cueRight, frames);
+
+    float mix = m_cueMixUsed;
+    float volume = m_cueVolumeUsed;
+    m_cueMixUsed = m_cueMix.load(std::memory_order_relaxed);
+    m_cueVolumeUsed = m_cueVolume.load(std::memory_order_relaxed);
+    float mixStep = (m_cueMixUsed - mix) * scale;
+    float volumeStep = (m_cueVolumeUsed - volume) * scale;
+
+    // Clamped, since nothing protects the headphones otherwise
+    if (m_splitCue.load(std::memory_order_relaxed)) {
+        for (int i = 0; i < frames; ++i) {
+            volume += volumeStep;
+            float cue = 0.5f * (cueLeft[i] + cueRight[i]) * volume;
+            float master = 0.5f * (masterLeft[i] + masterRight[i]) * volume;
+            cueLeft[i] = std::max(-1.0f, std::min(1.0f, cue));
+            cueRight[i] = std::max(-1.0f, std::min(1.0f, master));
+        }
+    } else {
+        for (int i = 0; i < frames; ++i) {
+            mix += mixStep;
+            volume += volumeStep;
+            float l = (cueLeft[i] + (masterLeft[i] - cueLeft[i]) * mix) * volume;
+            float r = (cueRight[i] + (masterRight[i] - cueRight[i]) * mix) * volume;
+            cueLeft[i] = std::max(-1.0f, std::min(1.0f, l));
+            cueRight[i] = std::max(-1.0f, std::min(1.0f, r));
+        }
+    }
+}
+
+// Delay the cue sum by the protection chain's latency. A new latency
+// crossfades from the old tap to the new one across the block; the delay
+// line itself is never cleared.
+void ClubMixer::delayCue(float* left, float* right, int frames) {
+    const unsigned mask = kCueDelaySize - 1;
+    int from = m_cueDelay;
+    int to = std::min(getLookAheadLatency(), (int)mask);
+    m_cueDelay = to;
+    const float scale = 1.0f / frames;
+    for (int i = 0; i < frames; ++i) {
+        unsigned frame = m_cueDelayWrite++;
+        m_cueDelayLeft[frame & mask] = left[i];
+        m_cueDelayRight[frame & mask] = right[i];
+        unsigned a = (frame - from) & mask;
+        unsigned b = (frame - to) & mask;
+        float t = from == to ? 1.0f : (i + 1) * scale;
+        left[i] = m_cueDelayLeft[a] + (m_cueDelayLeft[b] - m_cueDelayLeft[a]) * t;
+        right[i] = m_cueDelayRight[a] + (m_cueDelayRight[b] - m_cueDelayRight[a]) * t;
     }
 }
 
@@ -202,153 +288,152 @@ void ClubMixer::applyDeckVolumeCap(float& sample, int deck) {
     }
 }
 
-void ClubMixer::updatePeakDetection(float left, float right) {
-    float peak = std::max(std::abs(left), std::abs(right));
-    m_currentPeakLevel = std::max(m_currentPeakLevel * 0.99f, peak); // Slow decay
-}
-
-void ClubMixer::applySoftKneeCompressor(float& left, float& right) {
-    left = softKneeCompress(left);
-    right = softKneeCompress(right);
-}
-
-float ClubMixer::softKneeCompress(float input) {
-    const float threshold = m_clippingThreshold * 0.8f; // Compress before hard limiting
-    const float knee = 0.1f; // Soft knee width
-
-    if (std::abs(input) < threshold) {
-        return input; // No compression
-    }
-
-    if (std::abs(input) < threshold + knee) {
-        // Soft knee region
-        float excess = std::abs(input) - threshold;
-        float ratio = 1.0f + (m_compressorRatio - 1.0f) * (excess / knee);
-        return (input > 0 ? 1 : -1) * (threshold + excess / ratio);
-    } else {
-        // Hard knee region
-        float excess = std::abs(input) - threshold;
-        return (input > 0 ? 1 : -1) * (threshold + excess / m_compressorRatio);
+void ClubMixer::updateRmsMonitoring(const float* left, const float* right, int frames) {
+    // The block is written into the ring in contiguous runs. Four
+    // independent lanes keep the sums vectorisable without fast-math.
+    int i = 0;
+    while (i < frames) {
+        int n = std::min(frames - i, m_rmsWindowSize - m_rmsPosition);
+        float* ring = m_rmsWindow.data() + m_rmsPosition;
+        float added[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+        float removed[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+        int k = 0;
+        for (; k + 4 <= n; k += 4) {
+            for (int lane = 0; lane < 4; ++lane) {
+                float peak = std::max(std::abs(left[i + k + lane]), std::abs(right[i + k + lane]));
+                removed[lane] += ring[k + lane];
+                ring[k + lane] = peak * peak;
+                added[lane] += ring[k + lane];
+            }
+        }
+        for (; k < n; ++k) {
+            float peak = std::max(std::abs(left[i + k]), std::abs(right[i + k]));
+            removed[0] += ring[k];
+            ring[k] = peak * peak;
+            added[0] += ring[k];
+        }
+        m_rmsSum += (double)(added[0] + added[1] + added[2] + added[3]) -
+                    (double)(removed[0] + removed[1] + removed[2] + removed[3]);
+
+        m_rmsPosition += n;
+        if (m_rmsPosition == m_rmsWindowSize) {
+            m_rmsPosition = 0;
+            m_rmsSum = 0.0;
+            for (float square : m_rmsWindow) m_rmsSum += square;
+        }
+        i += n;
     }
+    m_currentRmsLevel.store((float)std::sqrt(std::max(0.0, m_rmsSum) / m_rmsWindowSize), std::memory_order_relaxed);
 }
 
-void ClubMixer::applyLookAheadLimiter(float& left, float& right) {
-    // Simple look-ahead limiting using buffer
-    // This is a basic implementation - production would need more sophisticated envelope following
-
-    // Add current samples to buffer
-    m_lookAheadBuffer.push_front(std::max(std::abs(left), std::abs(right)));
-    if (m_lookAheadBuffer.size() > m_lookAheadSamples) {
-        m_lookAheadBuffer.pop_back();
-    }
-
-    // Check future peaks
-    float maxFuturePeak = 0.0f;
-    for (float peak : m_lookAheadBuffer) {
-        maxFuturePeak = std::max(maxFuturePeak, peak);
-    }
-
-    // Apply limiting if future peak exceeds threshold
-    if (maxFuturePeak > m_clippingThreshold) {
-        float ratio = m_clippingThreshold / maxFuturePeak;
-        left *= ratio;
-        right *= ratio;
-    }
+void ClubMixer::initLoudness() {
+    // BS.1770 K-weighting, designed for 44.1 kHz from the analogue
+    // prototypes behind the 48 kHz coefficients in the standard
+    const double fs = 44100.0;
+    const double pi = 3.14159265358979323846;
+
+    // Stage 1: high shelf, about +4 dB above 1.5 kHz (head effects)
+    double f0 = 1681.974450955533;
+    double gainDb = 3.999843853973347;
+    double q = 0.7071752369554196;
+    double k = std::tan(pi * f0 / fs);
+    double vh = std::pow(10.0, gainDb / 20.0);
+    double vb = std::pow(vh, 0.4996667741545416);
+    double a0 = 1.0 + k / q + k * k;
+    m_preB[0] = (vh + vb * k / q + k * k) / a0;
+    m_preB[1] = 2.0 * (k * k - vh) / a0;
+    m_preB[2] = (vh - vb * k / q + k * k) / a0;
+    m_preA[0] = 1.0;
+    m_preA[1] = 2.0 * (k * k - 1.0) / a0;
+    m_preA[2] = (1.0 - k / q + k * k) / a0;
+
+    // Stage 2: RLB high-pass at ~38 Hz
+    f0 = 38.13547087602444;
+    q = 0.5003270373238773;
+    k = std::tan(pi * f0 / fs);
+    a0 = 1.0 + k / q + k * k;
+    m_rlbB[0] = 1.0;
+    m_rlbB[1] = -2.0;
+    m_rlbB[2] = 1.0;
+    m_rlbA[0] = 1.0;
+    m_rlbA[1] = 2.0 * (k * k - 1.0) / a0;
+    m_rlbA[2] = (1.0 - k / q + k * k) / a0;
+
+    for (auto& state : m_kState) std::fill(state, state + 4, 0.0);
+    std::fill(m_loudnessBins, m_loudnessBins + kShortTermBins, 0.0);
+    m_loudnessEnergy = 0.0;
+    m_loudnessBin = 0;
+    m_loudnessBinFill = 0;
+    m_momentaryLoudness.store(-70.0f, std::memory_order_relaxed);
+    m_shortTermLoudness.store(-70.0f, std::memory_order_relaxed);
 }
 
-void ClubMixer::updateRmsMonitoring(float left, float right) {
-    // Add samples to RMS window
-    m_rmsWindow.push_back(std::max(std::abs(left), std::abs(right)));
-    if (m_rmsWindow.size() > m_rmsWindowSize) {
-        m_rmsWindow.erase(m_rmsWindow.begin());
-    }
-
-    // Calculate RMS
-    m_currentRmsLevel = calculateRms(m_rmsWindow);
+static float loudnessOf(double energy, int frames) {
+    // L/R weigh 1.0 each; -70 LUFS is the standard's absolute gate
+    double meanSquare = energy / frames;
+    if (meanSquare <= 1e-7) return -70.0f;
+    return (float)std::max(-70.0, -0.691 + 10.0 * std::log10(meanSquare));
 }
 
-float ClubMixer::calculateRms(const std::vector<float>& samples) {
-    if (samples.empty()) return 0.0f;
-
-    float sumSquares = 0.0f;
-    for (float sample : samples) {
-        sumSquares += sample * sample;
-    }
-    return std::sqrt(sumSquares / samples.size());
-}
+void ClubMixer::updateLoudness(const float* left, const float* right, int frames) {
+    for (int i = 0; i < frames; ++i) {
+        for (int ch = 0; ch < 2; ++ch) {
+            double* z = m_kState[ch];
+            double x = ch == 0 ? left[i] : right[i];
+            double y = m_preB[0] * x + z[0];
+            z[0] = m_preB[1] * x - m_preA[1] * y + z[1];
+            z[1] = m_preB[2] * x - m_preA[2] * y;
+            x = y;
+            y = m_rlbB[0] * x + z[2];
+            z[2] = m_rlbB[1] * x - m_rlbA[1] * y + z[3];
+            z[3] = m_rlbB[2] * x - m_rlbA[2] * y;
+            m_loudnessEnergy += y * y;
+        }
 
-void ClubMixer::applyAutoGainReduction(float& left, float& right) {
-    // Reduce gain if clipping detected
-    if (m_isClipping) {
-        m_autoGainReduction = std::max(0.1f, m_autoGainReduction * 0.999f); // Slow recovery
-    } else {
-        m_autoGainReduction = std::min(1.0f, m_autoGainReduction * 1.001f); // Slow increase
+        if (++m_loudnessBinFill < kLoudnessBinFrames) continue;
+
+        // A 100 ms bin is complete: publish both windows ending on it
+        m_loudnessBins[m_loudnessBin] = m_loudnessEnergy;
+        m_loudnessEnergy = 0.0;
+        m_loudnessBinFill = 0;
+        double momentary = 0.0;
+        double shortTerm = 0.0;
+        for (int b = 0; b < kShortTermBins; ++b) {
+            double energy = m_loudnessBins[(m_loudnessBin - b + kShortTermBins) % kShortTermBins];
+            if (b < kMomentaryBins) momentary += energy;
+            shortTerm += energy;
+        }
+        m_loudnessBin = (m_loudnessBin + 1) % kShortTermBins;
+        m_momentaryLoudness.store(loudnessOf(momentary, kMomentaryBins * kLoudnessBinFrames), std::memory_order_relaxed);
+        m_shortTermLoudness.store(loudnessOf(shortTerm, kShortTermBins * kLoudnessBinFrames), std::memory_order_relaxed);
     }
-
-    left *= m_autoGainReduction;
-    right *= m_autoGainReduction;
 }
 
-void ClubMixer::applyBrickwallLimiter(float& left, float& right) {
-    // Hard limiting at threshold
-    if (std::abs(left) > m_clippingThreshold) {
-        left = (left > 0) ? m_clippingThreshold : -m_clippingThreshold;
+void ClubMixer::applyOutputDSP(float* left, float* right, int frames) {
+    auto start = std::chrono::steady_clock::now();
+    m_masterEffects.process(left, right, frames, m_effectContext);
+    m_protection.process({left, right, frames});
+
+    // Meters read the finished block
+    bool protection = m_protection.isEnabled(ProtectionChain::PROTECTION);
+    if (protection && m_protection.isEnabled(ProtectionChain::PEAK_METER)) {
+        updateTruePeakMeter(left, right, frames);
     }
-    if (std::abs(right) > m_clippingThreshold) {
-        right = (right > 0) ? m_clippingThreshold : -m_clippingThreshold;
+    if (protection && m_rmsMonitoringEnabled) {
+        updateRmsMonitoring(left, right, frames);
     }
-}
+    updateLoudness(left, right, frames);
 
-void ClubMixer::updateClippingIndicator(float left, float right) {
-    bool wasClipping = m_isClipping;
-    m_isClipping = (std::abs(left) >= m_clippingThreshold || std::abs(right) >= m_clippingThreshold);
-
-    // Log clipping events (following SOP: critical events to console)
-    if (m_isClipping && !wasClipping) {
-        std::cout << "[ClubMixer] CLIPPING DETECTED - Output exceeded " << m_clippingThreshold << std::endl;
-    }
+    // Share of the block time spent in the master chain, smoothed
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    float load = frames > 0 ? (float)(elapsed * 44100.0 / frames) : 0.0f;
+    m_outputLoad += 0.05f * (load - m_outputLoad);
+    engineStats().outputDspLoad.store(m_outputLoad, std::memory_order_relaxed);
 }
 
-void ClubMixer::applyOutputDSP(float* left, float* right, int frames) {
-    for (int i = 0; i < frames; ++i) {
-        float l = left[i];
-        float r = right[i];
-
-        // Apply clipping protection if enabled
-        if (m_clippingProtectionEnabled) {
-            // Soft knee compression
-            if (m_softKneeCompressorEnabled) {
-                applySoftKneeCompressor(l, r);
-            }
-
-            // Look-ahead limiting (requires buffering)
-            if (m_lookAheadLimiterEnabled) {
-                applyLookAheadLimiter(l, r);
-            }
-
-            // Brickwall limiting (hard limiting as final safety)
-            if (m_brickwallLimiterEnabled) {
-                applyBrickwallLimiter(l, r);
-            }
-
-            // Update monitoring
-            if (m_peakDetectionEnabled) {
-                updatePeakDetection(l, r);
-            }
-            if (m_rmsMonitoringEnabled) {
-                updateRmsMonitoring(l, r);
-            }
-            if (m_clippingIndicatorEnabled) {
-                updateClippingIndicator(l, r);
-            }
-
-            // Auto gain reduction (if clipping detected)
-            if (m_autoGainReductionEnabled) {
-                applyAutoGainReduction(l, r);
-            }
-        }
-
-        left[i] = l;
-        right[i] = r;
-    }
+void ClubMixer::updateTruePeakMeter(const float* left, const float* right, int frames) {
+    float fall = std::pow(10.0f, -1.0f * frames / 44100.0f);   // 20 dB/s
+    float peak = m_truePeakMeter.processBlock(left, right, frames);
+    float level = m_truePeakLevel.load(std::memory_order_relaxed) * fall;
+    m_truePeakLevel.store(std::max(level, peak), std::memory_order_relaxed);
 }
\ No newline at end of file
@@ -1,7 +1,15 @@
 #pragma once
 
 #include <vector>
-#include <deque>
+#include <algorithm>
+#include <atomic>
+#include "TruePeak.h"
+#include "ProtectionChain.h"
+#include "DjEq.h"
+#include "DjFilter.h"
+#include "Effects.h"
+
+class MasterClock;
 
 class ClubMixer {
 public:
@@ -22,27 +30,67 @@ public:
     void setMasterVolume(float gain);
     void setCrossfaderCurve(int curveType);
 
-    // Clipping Protection Methods
-    void setClippingProtectionEnabled(bool enabled) { m_clippingProtectionEnabled = enabled; }
+    // Clipping Protection Methods. Each switch swaps in the protection
+    // chain compiled for the new set of stages.
+    void setClippingProtectionEnabled(bool enabled) { m_protection.setEnabled(ProtectionChain::PROTECTION, enabled); }
     void setDeckVolumeCapEnabled(bool enabled) { m_deckVolumeCapEnabled = enabled; }
-    void setPeakDetectionEnabled(bool enabled) { m_peakDetectionEnabled = enabled; }
-    void setSoftKneeCompressorEnabled(bool enabled) { m_softKneeCompressorEnabled = enabled; }
-    void setLookAheadLimiterEnabled(bool enabled) { m_lookAheadLimiterEnabled = enabled; }
+    void setPeakDetectionEnabled(bool enabled) { m_protection.setEnabled(ProtectionChain::PEAK_METER, enabled); }
+    void setSoftKneeCompressorEnabled(bool enabled) { m_protection.setEnabled(ProtectionChain::SOFT_KNEE, enabled); }
+    void setLookAheadLimiterEnabled(bool enabled) { m_protection.setEnabled(ProtectionChain::LOOK_AHEAD, enabled); }
+    // Look-ahead limiting on 4x-oversampled (true) peaks instead of sample
+    // peaks; runs the look-ahead limiter even when that is switched off
+    void setTruePeakLimiterEnabled(bool enabled) { m_protection.setEnabled(ProtectionChain::TRUE_PEAK, enabled); }
     void setRmsMonitoringEnabled(bool enabled) { m_rmsMonitoringEnabled = enabled; }
-    void setAutoGainReductionEnabled(bool enabled) { m_autoGainReductionEnabled = enabled; }
-    void setBrickwallLimiterEnabled(bool enabled) { m_brickwallLimiterEnabled = enabled; }
-    void setClippingIndicatorEnabled(bool enabled) { m_clippingIndicatorEnabled = enabled; }
+    void setAutoGainReductionEnabled(bool enabled) { m_protection.setEnabled(ProtectionChain::AUTO_GAIN, enabled); }
+    void setBrickwallLimiterEnabled(bool enabled) { m_protection.setEnabled(ProtectionChain::BRICKWALL, enabled); }
+    void setClippingIndicatorEnabled(bool enabled) { m_protection.setEnabled(ProtectionChain::CLIP_INDICATOR, enabled); }
 
     // Threshold setters
-    void setClippingThreshold(float threshold) { m_clippingThreshold = threshold; }
-    void setCompressorRatio(float ratio) { m_compressorRatio = ratio; }
-    void setLimiterAttackTime(float attackMs) { m_limiterAttackTime = attackMs / 1000.0f; } // Convert ms to seconds
-    void setLimiterReleaseTime(float releaseMs) { m_limiterReleaseTime = releaseMs / 1000.0f; }
+    void setClippingThreshold(float threshold) { m_protection.settings().threshold.store(threshold); }
+    void setCompressorRatio(float ratio) { m_protection.settings().compressorRatio.store(ratio); }
+    void setLimiterAttackTime(float attackMs) { m_protection.settings().attackTime.store(attackMs / 1000.0f); } // Convert ms to seconds
+    void setLimiterReleaseTime(float releaseMs) { m_protection.settings().releaseTime.store(releaseMs / 1000.0f); }
 
     // Monitoring getters
-    float getCurrentPeakLevel() const { return m_currentPeakLevel; }
-    float getCurrentRmsLevel() const { return m_currentRmsLevel; }
-    bool isClipping() const { return m_isClipping; }
+    float getCurrentPeakLevel() const { return m_protection.peakLevel(); }
+    float getCurrentRmsLevel() const { return m_currentRmsLevel.load(std::memory_order_relaxed); }
+    // Master loudness per ITU-R BS.1770 (K-weighted), updated every 100 ms;
+    // momentary over 400 ms, short-term over 3 s, floored at -70 LUFS
+    float getMomentaryLoudness() const { return m_momentaryLoudness.load(std::memory_order_relaxed); }
+    float getShortTermLoudness() const { return m_shortTermLoudness.load(std::memory_order_relaxed); }
+    bool isClipping() const { return m_protection.isClipping(); }
+    // Output true peak, linear with a 20 dB/s fall (20*log10 gives dBTP)
+    float getTruePeakLevel() const { return m_truePeakLevel.load(std::memory_order_relaxed); }
+    // Frames the look-ahead limiter delays the output by, 0 when it is off
+    int getLookAheadLatency() const { return m_protection.latency(); }
+
+    // Channel strip run on the deck buffers before they are mixed: the
+    // 3-band EQ, the sweep filter, then the effects rack (deck 0-based)
+    DjEq& eq() { return m_eq; }
+    DjFilter& filter(int deck) { return m_filters[std::max(0, std::min(DjEq::kMaxDecks - 1, deck))]; }
+    EffectRack& channelEffects(int deck) { return m_channelEffects[std::max(0, std::min(DjEq::kMaxDecks - 1, deck))]; }
+    void applyChannelDsp(float* const* left, float* const* right, int decks, int frames);
+    // Master effects run on the mixed bus ahead of the protection chain
+    EffectRack& masterEffects() { return m_masterEffects; }
+    // Tempo-synced effects follow this clock; without one they run at 120 BPM
+    void setMasterClock(const MasterClock* clock) { m_clock = clock; }
+
+    // Headphone cue. PFL takes a deck after its channel strip but before the
+    // channel fader and crossfader; the mix knob blends from cue (0) to the
+    // finished master (1). Split cue puts the cue in mono on the left and
+    // the master in mono on the right instead. Deck 0-based; any thread.
+    void setCue(int deck, bool cued);
+    bool isCued(int deck) const;
+    void setCueMix(float mix);
+    float getCueMix() const { return m_cueMix.load(std::memory_order_relaxed); }
+    void setCueVolume(float gain);
+    float getCueVolume() const { return m_cueVolume.load(std::memory_order_relaxed); }
+    void setSplitCue(bool split) { m_splitCue.store(split, std::memory_order_relaxed); }
+    bool isSplitCue() const { return m_splitCue.load(std::memory_order_relaxed); }
+    // Audio thread: build the cue bus from the channel-strip outputs and the
+    // master after applyOutputDSP, in the same pass as the master
+    void renderCue(const float* const* left, const float* const* right, int decks, const float* masterLeft,
+                   const float* masterRight, float* cueLeft, float* cueRight, int frames);
 
     float getDeckGain(int deck);
     float getDeckVolume(int deck);
@@ -58,50 +106,71 @@ private:
     float m_masterVolume;
     int m_curveType;
 
-    // Clipping Protection Parameters
-    bool m_clippingProtectionEnabled;
+    // Clipping protection: the chain owns the stage flags, settings and state
+    ProtectionChain m_protection;
     bool m_deckVolumeCapEnabled;
-    bool m_peakDetectionEnabled;
-    bool m_softKneeCompressorEnabled;
-    bool m_lookAheadLimiterEnabled;
     bool m_rmsMonitoringEnabled;
-    bool m_autoGainReductionEnabled;
-    bool m_brickwallLimiterEnabled;
-    bool m_clippingIndicatorEnabled;
-
-    // Thresholds
-    float m_clippingThreshold;
-    float m_compressorRatio;
-    float m_limiterAttackTime;
-    float m_limiterReleaseTime;
 
     // Monitoring state
-    float m_currentPeakLevel;
-    float m_currentRmsLevel;
-    bool m_isClipping;
+    std::atomic<float> m_currentRmsLevel;
+    TruePeakDetector m_truePeakMeter;
+    std::atomic<float> m_truePeakLevel;
+    float m_outputLoad;
 
-    // Look-ahead buffer for limiter
-    std::deque<float> m_lookAheadBuffer;
-    int m_lookAheadSamples;
-
-    // RMS calculation
+    // RMS calculation: squared peaks in a ring with a running sum, rebuilt
+    // each time the ring wraps so rounding can't drift
     std::vector<float> m_rmsWindow;
     int m_rmsWindowSize;
-
-    // Auto gain reduction
-    float m_autoGainReduction;
+    int m_rmsPosition;
+    double m_rmsSum;
+
+    // Loudness: K-weighting filter state per channel (pre-filter, then RLB
+    // high-pass, transposed direct form II) and the energy of the last 3 s
+    // in 100 ms bins
+    static constexpr int kLoudnessBinFrames = 4410;
+    static constexpr int kMomentaryBins = 4;
+    static constexpr int kShortTermBins = 30;
+    double m_preB[3], m_preA[3];
+    double m_rlbB[3], m_rlbA[3];
+    double m_kState[2][4];
+    double m_loudnessBins[kShortTermBins];
+    double m_loudnessEnergy;
+    int m_loudnessBin;
+    int m_loudnessBinFill;
+    std::atomic<float> m_momentaryLoudness;
+    std::atomic<float> m_shortTermLoudness;
+
+    DjEq m_eq;
+    DjFilter m_filters[DjEq::kMaxDecks];
+    EffectRack m_channelEffects[DjEq::kMaxDecks];
+    EffectRack m_masterEffects;
+    const MasterClock* m_clock;
+    EffectContext m_effectContext;   // clock at the start of the current block
+
+    // Cue bus. Gains ramp across each block from the values below, so
+    // pressing PFL or turning a knob doesn't click.
+    std::atomic<bool> m_cued[DjEq::kMaxDecks];
+    std::atomic<float> m_cueMix;
+    std::atomic<float> m_cueVolume;
+    std::atomic<bool> m_splitCue;
+    float m_cueGains[DjEq::kMaxDecks];   // audio thread only
+    float m_cueMixUsed;
+    float m_cueVolumeUsed;
+    // The master comes out of the protection chain late by its look-ahead,
+    // so the cue sum goes through a delay line to stay in step with it
+    static constexpr int kCueDelaySize = 2048;   // power of two
+    static_assert(kCueDelaySize > ProtectionChain::kMaxLatency, "cue delay can't reach the chain's latency");
+    std::vector<float> m_cueDelayLeft;
+    std::vector<float> m_cueDelayRight;
+    unsigned m_cueDelayWrite;
+    int m_cueDelay;   // frames, as of the last block
+
+    void delayCue(float* left, float* right, int frames);
 
     // DSP Methods
     void applyDeckVolumeCap(float& sample, int deck);
-    void updatePeakDetection(float left, float right);
-    void applySoftKneeCompressor(float& left, float& right);
-    void applyLookAheadLimiter(float& left, float& right);
-    void updateRmsMonitoring(float left, float right);
-    void applyAutoGainReduction(float& left, float& right);
-    void applyBrickwallLimiter(float& left, float& right);
-    void updateClippingIndicator(float left, float right);
-
-    // Helper methods
-    float softKneeCompress(float input);
-    float calculateRms(const std::vector<float>& samples);
+    void updateTruePeakMeter(const float* left, const float* right, int frames);
+    void updateRmsMonitoring(const float* left, const float* right, int frames);
+    void updateLoudness(const float* left, const float* right, int frames);
+    void initLoudness();
 };
\ No newline at end of file
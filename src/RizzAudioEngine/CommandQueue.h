@@ -0,0 +1,62 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Bounded lock-free queue for control -> audio thread messages. Any number
+// of threads may push (UI, MIDI, interop); exactly one thread pops. push()
+// never blocks and fails when full; pop() is wait-free. T must be trivially
+// copyable, nothing is allocated after construction.
+template <class T, size_t Capacity>
+class CommandQueue {
+    static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    CommandQueue() : m_head(0), m_tail(0) {
+        for (size_t i = 0; i < Capacity; ++i) {
+            m_cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    bool push(const T& value) {
+        size_t pos = m_head.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = m_cells[pos & (Capacity - 1)];
+            size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            intptr_t diff = (intptr_t)sequence - (intptr_t)pos;
+            if (diff == 0) {
+                if (m_head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    cell.value = value;
+                    cell.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false; // full
+            } else {
+                pos = m_head.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Consumer thread only
+    bool pop(T& value) {
+        Cell& cell = m_cells[m_tail & (Capacity - 1)];
+        size_t sequence = cell.sequence.load(std::memory_order_acquire);
+        if ((intptr_t)sequence - (intptr_t)(m_tail + 1) < 0) return false;
+        value = cell.value;
+        cell.sequence.store(m_tail + Capacity, std::memory_order_release);
+        ++m_tail;
+        return true;
+    }
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    Cell m_cells[Capacity];
+    alignas(64) std::atomic<size_t> m_head;
+    alignas(64) size_t m_tail;
+};
@@ -0,0 +1,327 @@
+#include "Convolver.h"
+#include "Fft.h"
+#include <chrono>
+#include <algorithm>
+
+// The audio thread never signals the worker, so it looks for a new tail
+// block this often; each block gives it a whole tail block of time
+static const std::chrono::milliseconds kPollInterval(1);
+
+// One uniformly partitioned convolution: a frequency-domain delay line of
+// input blocks, each multiplied by its partition of the response. A partial
+// block is transformed on every call, so the output has no latency; the
+// older partitions are summed once per block.
+//
+// Left and right go in as the real and imaginary parts of one transform.
+// With a mono response that is all it takes. With a stereo one the output
+// spectrum is X*(Hl + Hr)/2 + conj(X mirrored)*(Hl - Hr)/2, so each block's
+// mirrored conjugate is kept alongside it.
+class Convolver::Stage {
+public:
+    Stage(const float* left, const float* right, int length, int block)
+        : m_block(block), m_size(2 * block), m_partitions(std::max(1, (length + block - 1) / block)),
+          m_stereo(right != nullptr), m_fft(2 * block), m_current(0), m_fill(0) {
+        size_t spectra = (size_t)m_partitions * m_size;
+        m_irRe.assign(spectra, 0.0f);
+        m_irIm.assign(spectra, 0.0f);
+        m_segRe.assign(spectra, 0.0f);
+        m_segIm.assign(spectra, 0.0f);
+        if (m_stereo) {
+            m_sideRe.assign(spectra, 0.0f);
+            m_sideIm.assign(spectra, 0.0f);
+            m_mirRe.assign(spectra, 0.0f);
+            m_mirIm.assign(spectra, 0.0f);
+        }
+        m_inputLeft.assign(block, 0.0f);
+        m_inputRight.assign(block, 0.0f);
+        m_overlapLeft.assign(block, 0.0f);
+        m_overlapRight.assign(block, 0.0f);
+        m_preRe.assign(m_size, 0.0f);
+        m_preIm.assign(m_size, 0.0f);
+        m_convRe.assign(m_size, 0.0f);
+        m_convIm.assign(m_size, 0.0f);
+
+        std::vector<float> re(m_size), im(m_size);
+        for (int p = 0; p < m_partitions; ++p) {
+            int count = std::min(block, length - p * block);
+            float* hr = &m_irRe[(size_t)p * m_size];
+            float* hi = &m_irIm[(size_t)p * m_size];
+            std::fill(hr, hr + m_size, 0.0f);
+            std::fill(hi, hi + m_size, 0.0f);
+            std::copy(left + p * block, left + p * block + count, hr);
+            m_fft.forward(hr, hi);
+            if (!m_stereo) continue;
+
+            std::fill(re.begin(), re.end(), 0.0f);
+            std::fill(im.begin(), im.end(), 0.0f);
+            std::copy(right + p * block, right + p * block + count, re.begin());
+            m_fft.forward(re.data(), im.data());
+            float* sr = &m_sideRe[(size_t)p * m_size];
+            float* si = &m_sideIm[(size_t)p * m_size];
+            for (int k = 0; k < m_size; ++k) {
+                sr[k] = 0.5f * (hr[k] - re[k]);
+                si[k] = 0.5f * (hi[k] - im[k]);
+                hr[k] = 0.5f * (hr[k] + re[k]);
+                hi[k] = 0.5f * (hi[k] + im[k]);
+            }
+        }
+    }
+
+    // Back to silence: empty delay line, no overlap or partial block
+    void reset() {
+        std::fill(m_segRe.begin(), m_segRe.end(), 0.0f);
+        std::fill(m_segIm.begin(), m_segIm.end(), 0.0f);
+        std::fill(m_mirRe.begin(), m_mirRe.end(), 0.0f);
+        std::fill(m_mirIm.begin(), m_mirIm.end(), 0.0f);
+        std::fill(m_inputLeft.begin(), m_inputLeft.end(), 0.0f);
+        std::fill(m_inputRight.begin(), m_inputRight.end(), 0.0f);
+        std::fill(m_overlapLeft.begin(), m_overlapLeft.end(), 0.0f);
+        std::fill(m_overlapRight.begin(), m_overlapRight.end(), 0.0f);
+        std::fill(m_preRe.begin(), m_preRe.end(), 0.0f);
+        std::fill(m_preIm.begin(), m_preIm.end(), 0.0f);
+        m_current = 0;
+        m_fill = 0;
+    }
+
+    // Overwrites the output; the output may be the input
+    void process(const float* inLeft, const float* inRight, float* outLeft, float* outRight, int frames) {
+        for (int done = 0; done < frames; ) {
+            int n = std::min(frames - done, m_block - m_fill);
+            std::copy(inLeft + done, inLeft + done + n, m_inputLeft.begin() + m_fill);
+            std::copy(inRight + done, inRight + done + n, m_inputRight.begin() + m_fill);
+
+            // Transform the block so far into the newest slot of the delay line
+            size_t slot = (size_t)m_current * m_size;
+            float* xr = &m_segRe[slot];
+            float* xi = &m_segIm[slot];
+            std::copy(m_inputLeft.begin(), m_inputLeft.end(), xr);
+            std::copy(m_inputRight.begin(), m_inputRight.end(), xi);
+            std::fill(xr + m_block, xr + m_size, 0.0f);
+            std::fill(xi + m_block, xi + m_size, 0.0f);
+            m_fft.forward(xr, xi);
+            if (m_stereo) mirror(slot);
+
+            std::copy(m_preRe.begin(), m_preRe.end(), m_convRe.begin());
+            std::copy(m_preIm.begin(), m_preIm.end(), m_convIm.begin());
+            accumulate(0, m_current);
+            m_fft.inverse(m_convRe.data(), m_convIm.data());
+
+            for (int i = 0; i < n; ++i) {
+                outLeft[done + i] = m_convRe[m_fill + i] + m_overlapLeft[m_fill + i];
+                outRight[done + i] = m_convIm[m_fill + i] + m_overlapRight[m_fill + i];
+            }
+            m_fill += n;
+            done += n;
+            if (m_fill < m_block) continue;
+
+            // Block complete: keep what spills into the next one, step the
+            // delay line and sum every older partition ahead of time
+            std::copy(m_convRe.begin() + m_block, m_convRe.end(), m_overlapLeft.begin());
+            std::copy(m_convIm.begin() + m_block, m_convIm.end(), m_overlapRight.begin());
+            m_current = (m_current + m_partitions - 1) % m_partitions;
+            std::fill(m_convRe.begin(), m_convRe.end(), 0.0f);
+            std::fill(m_convIm.begin(), m_convIm.end(), 0.0f);
+            for (int p = 1; p < m_partitions; ++p) {
+                accumulate(p, (m_current + p) % m_partitions);
+            }
+            std::copy(m_convRe.begin(), m_convRe.end(), m_preRe.begin());
+            std::copy(m_convIm.begin(), m_convIm.end(), m_preIm.begin());
+            std::fill(m_inputLeft.begin(), m_inputLeft.end(), 0.0f);
+            std::fill(m_inputRight.begin(), m_inputRight.end(), 0.0f);
+            m_fill = 0;
+        }
+    }
+
+private:
+    void mirror(size_t slot) {
+        const float* __restrict xr = &m_segRe[slot];
+        const float* __restrict xi = &m_segIm[slot];
+        float* __restrict mr = &m_mirRe[slot];
+        float* __restrict mi = &m_mirIm[slot];
+        mr[0] = xr[0];
+        mi[0] = -xi[0];
+        for (int k = 1; k < m_size; ++k) {
+            mr[k] = xr[m_size - k];
+            mi[k] = -xi[m_size - k];
+        }
+    }
+
+    // m_conv += segment * partition (complex, element-wise)
+    void accumulate(int partition, int segment) {
+        size_t h = (size_t)partition * m_size;
+        size_t x = (size_t)segment * m_size;
+        multiplyAdd(&m_segRe[x], &m_segIm[x], &m_irRe[h], &m_irIm[h]);
+        if (m_stereo) multiplyAdd(&m_mirRe[x], &m_mirIm[x], &m_sideRe[h], &m_sideIm[h]);
+    }
+
+    void multiplyAdd(const float* __restrict xr, const float* __restrict xi, const float* __restrict hr,
+                     const float* __restrict hi) {
+        float* __restrict yr = m_convRe.data();
+        float* __restrict yi = m_convIm.data();
+        for (int k = 0; k < m_size; ++k) {
+            yr[k] += xr[k] * hr[k] - xi[k] * hi[k];
+            yi[k] += xr[k] * hi[k] + xi[k] * hr[k];
+        }
+    }
+
+    int m_block;
+    int m_size;
+    int m_partitions;
+    bool m_stereo;
+    Fft m_fft;
+    // Spectra, one run of m_size per partition / delay line slot
+    std::vector<float> m_irRe, m_irIm;       // (Hl + Hr)/2, or H for mono
+    std::vector<float> m_sideRe, m_sideIm;   // (Hl - Hr)/2
+    std::vector<float> m_segRe, m_segIm;     // input blocks; m_current is the newest
+    std::vector<float> m_mirRe, m_mirIm;     // their mirrored conjugates
+    int m_current;
+    int m_fill;
+    std::vector<float> m_inputLeft, m_inputRight;
+    std::vector<float> m_overlapLeft, m_overlapRight;
+    std::vector<float> m_preRe, m_preIm;     // older partitions, summed per block
+    std::vector<float> m_convRe, m_convIm;
+};
+
+Convolver::Convolver(const float* left, const float* right, int length, int headBlock, int tailBlock)
+    : m_length(std::max(1, length)), m_headBlock(headBlock), m_tailBlock(tailBlock), m_tailFill(0), m_farJobs(0),
+      m_farPending(false), m_farGap(false), m_farJob(0), m_farDone(0), m_lateBlocks(0), m_stallMs(0),
+      m_running(false) {
+    std::fill(m_workerRestart, m_workerRestart + kQueueBlocks, false);
+    // Stages read the response in place, so a response shorter than a
+    // partition is padded out first
+    std::vector<float> padLeft, padRight;
+    if (length < 1) {
+        padLeft.assign(1, 0.0f);
+        left = padLeft.data();
+        if (right) {
+            padRight.assign(1, 0.0f);
+            right = padRight.data();
+        }
+    }
+
+    int headLength = std::min(m_length, tailBlock);
+    m_head.reset(new Stage(left, right, headLength, headBlock));
+    m_inputLeft.assign(tailBlock, 0.0f);
+    m_inputRight.assign(tailBlock, 0.0f);
+
+    if (m_length > tailBlock) {
+        int nearLength = std::min(m_length - tailBlock, tailBlock);
+        m_near.reset(new Stage(left + tailBlock, right ? right + tailBlock : nullptr, nearLength, headBlock));
+        m_nearReadyLeft.assign(tailBlock, 0.0f);
+        m_nearReadyRight.assign(tailBlock, 0.0f);
+        m_nearNextLeft.assign(tailBlock, 0.0f);
+        m_nearNextRight.assign(tailBlock, 0.0f);
+    }
+    if (m_length > 2 * tailBlock) {
+        m_far.reset(new Stage(left + 2 * tailBlock, right ? right + 2 * tailBlock : nullptr, m_length - 2 * tailBlock,
+                              tailBlock));
+        m_farReadyLeft.assign(tailBlock, 0.0f);
+        m_farReadyRight.assign(tailBlock, 0.0f);
+        m_workerInputLeft.assign((size_t)kQueueBlocks * tailBlock, 0.0f);
+        m_workerInputRight.assign((size_t)kQueueBlocks * tailBlock, 0.0f);
+        m_workerOutputLeft.assign((size_t)kQueueBlocks * tailBlock, 0.0f);
+        m_workerOutputRight.assign((size_t)kQueueBlocks * tailBlock, 0.0f);
+        m_running.store(true);
+        m_worker = std::thread(&Convolver::workerLoop, this);
+    }
+}
+
+Convolver::~Convolver() {
+    m_running.store(false);
+    if (m_worker.joinable()) {
+        m_worker.join();
+    }
+}
+
+void Convolver::workerLoop() {
+    while (m_running.load(std::memory_order_relaxed)) {
+        uint64_t done = m_farDone.load(std::memory_order_relaxed);
+        if (m_farJob.load(std::memory_order_acquire) == done) {
+            std::this_thread::sleep_for(kPollInterval);
+            continue;
+        }
+        int stall = m_stallMs.exchange(0, std::memory_order_relaxed);
+        if (stall > 0) std::this_thread::sleep_for(std::chrono::milliseconds(stall));
+
+        // Jobs in order, so the far stage sees its input without gaps
+        uint64_t job = done + 1;
+        size_t slot = (size_t)(job % kQueueBlocks);
+        if (m_workerRestart[slot]) m_far->reset();
+        size_t offset = slot * m_tailBlock;
+        m_far->process(&m_workerInputLeft[offset], &m_workerInputRight[offset], &m_workerOutputLeft[offset],
+                       &m_workerOutputRight[offset], m_tailBlock);
+        m_farDone.store(job, std::memory_order_release);
+    }
+}
+
+void Convolver::process(const float* inLeft, const float* inRight, float* outLeft, float* outRight, int frames) {
+    for (int done = 0; done < frames; ) {
+        // Never cross a head block boundary, so the near stage gets whole blocks
+        int n = std::min(frames - done, m_headBlock - (m_tailFill % m_headBlock));
+        float* inputLeft = &m_inputLeft[m_tailFill];
+        float* inputRight = &m_inputRight[m_tailFill];
+        std::copy(inLeft + done, inLeft + done + n, inputLeft);
+        std::copy(inRight + done, inRight + done + n, inputRight);
+
+        float* l = outLeft + done;
+        float* r = outRight + done;
+        m_head->process(inputLeft, inputRight, l, r, n);
+        if (m_near) {
+            for (int i = 0; i < n; ++i) {
+                l[i] += m_nearReadyLeft[m_tailFill + i];
+                r[i] += m_nearReadyRight[m_tailFill + i];
+            }
+        }
+        if (m_far) {
+            for (int i = 0; i < n; ++i) {
+                l[i] += m_farReadyLeft[m_tailFill + i];
+                r[i] += m_farReadyRight[m_tailFill + i];
+            }
+        }
+        m_tailFill += n;
+        done += n;
+
+        if (m_near && m_tailFill % m_headBlock == 0) {
+            int offset = m_tailFill - m_headBlock;
+            m_near->process(&m_inputLeft[offset], &m_inputRight[offset], &m_nearNextLeft[offset],
+                            &m_nearNextRight[offset], m_headBlock);
+        }
+        if (m_tailFill < m_tailBlock) continue;
+
+        if (m_near) {
+            m_nearReadyLeft.swap(m_nearNextLeft);
+            m_nearReadyRight.swap(m_nearNextRight);
+        }
+        if (m_far) {
+            uint64_t done = m_farDone.load(std::memory_order_acquire);
+            if (m_farPending && done >= m_farJobs) {
+                // The worker finished the last block: play its result out
+                // over this one
+                size_t offset = (size_t)(m_farJobs % kQueueBlocks) * m_tailBlock;
+                std::copy(&m_workerOutputLeft[offset], &m_workerOutputLeft[offset] + m_tailBlock, m_farReadyLeft.begin());
+                std::copy(&m_workerOutputRight[offset], &m_workerOutputRight[offset] + m_tailBlock, m_farReadyRight.begin());
+            } else {
+                // Still busy: never wait on it here, leave this block's tail
+                // out. Its result is never played, however late it lands.
+                std::fill(m_farReadyLeft.begin(), m_farReadyLeft.end(), 0.0f);
+                std::fill(m_farReadyRight.begin(), m_farReadyRight.end(), 0.0f);
+                if (m_farPending || m_farGap) m_lateBlocks.fetch_add(1, std::memory_order_relaxed);
+            }
+
+            // Queue the block just completed whether or not the worker kept
+            // up, so the far stage's input stays continuous
+            m_farPending = m_farJobs + 1 - done < (uint64_t)kQueueBlocks;
+            if (m_farPending) {
+                size_t slot = (size_t)((m_farJobs + 1) % kQueueBlocks);
+                std::copy(m_inputLeft.begin(), m_inputLeft.end(), m_workerInputLeft.begin() + slot * m_tailBlock);
+                std::copy(m_inputRight.begin(), m_inputRight.end(), m_workerInputRight.begin() + slot * m_tailBlock);
+                m_workerRestart[slot] = m_farGap;
+                m_farGap = false;
+                m_farJob.store(++m_farJobs, std::memory_order_release);
+            } else {
+                m_farGap = true;
+            }
+        }
+        m_tailFill = 0;
+    }
+}
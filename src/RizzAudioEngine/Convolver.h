@@ -0,0 +1,85 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <cstdint>
+
+// Zero-latency stereo convolution with a long impulse response, either mono
+// (applied to both sides) or stereo (left to left, right to right).
+//
+// The response is partitioned non-uniformly. Its first `tailBlock` frames
+// are cut into small partitions of `headBlock` frames that run on the audio
+// thread, so nothing is added to the latency. The next `tailBlock` frames
+// also use small partitions but are only needed one tail block later. The
+// rest is cut into large partitions that a background thread convolves a
+// whole tail block at a time, with a full tail block of time to finish
+// each one. Every partition is convolved in the frequency domain
+// (overlap-add on a double-length FFT), with the stereo pair packed into
+// one complex transform.
+class Convolver {
+public:
+    // Off the audio thread: transforms the response and starts the worker.
+    // `right` may be null for a mono response. Both block sizes are powers
+    // of two, headBlock < tailBlock.
+    Convolver(const float* left, const float* right, int length, int headBlock = 64, int tailBlock = 2048);
+    ~Convolver();
+
+    int length() const { return m_length; }
+    // Frames of output that follow the last non-zero input
+    int64_t tailFrames() const { return (int64_t)m_length + 2 * m_tailBlock; }
+    // Tail blocks the worker didn't finish in time. Each one's far tail is
+    // left out and its late result dropped; the worker still gets every
+    // input block, so the tail after it stays aligned.
+    uint64_t lateBlocks() const { return m_lateBlocks.load(std::memory_order_relaxed); }
+
+    // For checks: the worker sleeps this long before its next job, to
+    // exercise the late path
+    void stallWorkerOnce(int milliseconds) { m_stallMs.store(milliseconds, std::memory_order_relaxed); }
+
+    // Audio thread: convolve a stereo block; the output may be the input
+    void process(const float* inLeft, const float* inRight, float* outLeft, float* outRight, int frames);
+
+private:
+    class Stage;
+
+    // Input blocks queued for the worker, and its results, by job number;
+    // a stalled worker catches up on up to this many before input is lost
+    static constexpr int kQueueBlocks = 8;
+
+    void workerLoop();
+
+    int m_length;
+    int m_headBlock;
+    int m_tailBlock;
+    std::unique_ptr<Stage> m_head;    // response [0, tailBlock)
+    std::unique_ptr<Stage> m_near;    // [tailBlock, 2 tailBlock), one tail block late
+    std::unique_ptr<Stage> m_far;     // [2 tailBlock, end), on the worker, two late
+
+    // Audio thread: input of the current tail block, and the delayed stage
+    // output being played out (ready) or built up for the next block
+    int m_tailFill;
+    std::vector<float> m_inputLeft, m_inputRight;
+    std::vector<float> m_nearReadyLeft, m_nearReadyRight;
+    std::vector<float> m_nearNextLeft, m_nearNextRight;
+    std::vector<float> m_farReadyLeft, m_farReadyRight;
+    uint64_t m_farJobs;
+    bool m_farPending;   // the last tail block went to the worker, its result is due
+    bool m_farGap;       // a tail block was lost to a full queue
+
+    // Handed to the worker: job n's input and result sit in slot
+    // n % kQueueBlocks. The audio thread fills the input and publishes n,
+    // and only reuses the slot once the worker has reported n done. The
+    // worker takes the jobs in order; a restart flag after a lost block
+    // makes it clear the far stage, since its input is no longer continuous.
+    std::vector<float> m_workerInputLeft, m_workerInputRight;
+    std::vector<float> m_workerOutputLeft, m_workerOutputRight;
+    bool m_workerRestart[kQueueBlocks];
+    std::atomic<uint64_t> m_farJob;
+    std::atomic<uint64_t> m_farDone;
+    std::atomic<uint64_t> m_lateBlocks;
+    std::atomic<int> m_stallMs;
+    std::atomic<bool> m_running;
+    std::thread m_worker;
+};
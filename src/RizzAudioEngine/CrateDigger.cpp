@@ -0,0 +1,209 @@
+#include "CrateDigger.h"
+#include "ScratchBuffer.h"
+#include "EngineStats.h"
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <chrono>
+#include <limits>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+// Bytes of physical memory the OS could hand out without swapping
+static size_t availableSystemMemory() {
+#ifdef _WIN32
+    MEMORYSTATUSEX status;
+    status.dwLength = sizeof(status);
+    if (GlobalMemoryStatusEx(&status)) {
+        return (size_t)status.ullAvailPhys;
+    }
+#elif defined(__linux__)
+    std::ifstream meminfo("/proc/meminfo");
+    std::string key;
+    size_t valueKb;
+    std::string unit;
+    while (meminfo >> key >> valueKb >> unit) {
+        if (key == "MemAvailable:") {
+            return valueKb * 1024;
+        }
+    }
+#endif
+    return std::numeric_limits<size_t>::max();
+}
+
+static void lowerCurrentThreadPriority() {
+#ifdef _WIN32
+    SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_LOWEST);
+#elif defined(__linux__)
+    sched_param param{};
+    param.sched_priority = 0;
+    pthread_setschedparam(pthread_self(), SCHED_IDLE, &param);
+#endif
+}
+
+CrateDigger::CrateDigger(size_t memoryBudgetBytes)
+    : m_running(true), m_cachedBytes(0), m_memoryBudget(memoryBudgetBytes), m_counter(0) {
+    m_worker = std::thread(&CrateDigger::workerLoop, this);
+    std::cout << "[CrateDigger] Created with budget " << (memoryBudgetBytes >> 20) << " MB" << std::endl;
+}
+
+CrateDigger::~CrateDigger() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_running = false;
+    }
+    m_wake.notify_all();
+    if (m_worker.joinable()) {
+        m_worker.join();
+    }
+    std::cout << "[CrateDigger] Destroyed" << std::endl;
+}
+
+void CrateDigger::hint(const std::string& filePath, int priority) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = std::find_if(m_hints.begin(), m_hints.end(),
+                               [&](const Hint& h) { return h.path == filePath; });
+        if (it != m_hints.end()) {
+            it->priority = priority;
+        } else {
+            m_hints.push_back({filePath, priority, m_counter++});
+        }
+    }
+    m_wake.notify_one();
+}
+
+void CrateDigger::clearHints() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_hints.clear();
+}
+
+std::shared_ptr<const DecodedTrack> CrateDigger::take(const std::string& filePath) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_cache.find(filePath);
+    if (it == m_cache.end()) {
+        return nullptr;
+    }
+    it->second.lastUse = m_counter++;
+    return it->second.track;
+}
+
+void CrateDigger::store(std::shared_ptr<const DecodedTrack> track) {
+    if (!track) return;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_cache.count(track->path) == 0 && makeRoom(track->bytes())) {
+        insert(std::move(track));
+    }
+}
+
+bool CrateDigger::isCached(const std::string& filePath) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_cache.count(filePath) != 0;
+}
+
+void CrateDigger::setMemoryBudget(size_t bytes) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_memoryBudget = bytes;
+    makeRoom(0);
+    std::cout << "[CrateDigger] Memory budget set to " << (bytes >> 20) << " MB" << std::endl;
+}
+
+size_t CrateDigger::getCachedBytes() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_cachedBytes;
+}
+
+bool CrateDigger::underPressure() const {
+    if (engineStats().audioLoad.load(std::memory_order_relaxed) > kMaxAudioLoad) {
+        return true;
+    }
+    return availableSystemMemory() < kMinFreeSystemMemory;
+}
+
+bool CrateDigger::makeRoom(size_t bytes) {
+    if (bytes > m_memoryBudget) {
+        return false;
+    }
+    // Evict least recently used tracks. A deck playing an evicted track keeps
+    // its own reference, so this only drops the cache's copy.
+    while (m_cachedBytes + bytes > m_memoryBudget && !m_cache.empty()) {
+        auto oldest = std::min_element(m_cache.begin(), m_cache.end(),
+                                       [](const auto& a, const auto& b) { return a.second.lastUse < b.second.lastUse; });
+        m_cachedBytes -= oldest->second.track->bytes();
+        m_cache.erase(oldest);
+    }
+    return m_cachedBytes + bytes <= m_memoryBudget;
+}
+
+void CrateDigger::insert(std::shared_ptr<const DecodedTrack> track) {
+    m_cachedBytes += track->bytes();
+    std::string path = track->path;
+    m_cache[path] = {std::move(track), m_counter++};
+}
+
+void CrateDigger::workerLoop() {
+    lowerCurrentThreadPriority();
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (m_running) {
+        m_wake.wait(lock, [this] { return !m_running || !m_hints.empty(); });
+        if (!m_running) break;
+
+        // Back off while the audio thread is busy or the machine is short on RAM
+        lock.unlock();
+        bool pressure = underPressure();
+        lock.lock();
+        if (pressure) {
+            m_wake.wait_for(lock, std::chrono::milliseconds(250), [this] { return !m_running; });
+            continue;
+        }
+
+        auto next = std::min_element(m_hints.begin(), m_hints.end(), [](const Hint& a, const Hint& b) {
+            return a.priority != b.priority ? a.priority < b.priority : a.order < b.order;
+        });
+        std::string path = next->path;
+        m_hints.erase(next);
+        if (m_cache.count(path) != 0) {
+            continue;
+        }
+
+        // Skip tracks that could never fit; MP3 sizes are unknown until decoded
+        FileInfo info;
+        lock.unlock();
+        bool known = ScratchBuffer::getFileInfo(path, info);
+        lock.lock();
+        if (!known) {
+            continue;
+        }
+        size_t estimate = (size_t)std::max(0L, info.lengthSamples) * std::max(0, info.channels) * sizeof(float);
+        if (info.sampleRate > 0) {
+            estimate = (size_t)(estimate * (44100.0 / info.sampleRate));
+        }
+        if (estimate > m_memoryBudget) {
+            std::cout << "[CrateDigger] Skipping " << path << ": larger than memory budget" << std::endl;
+            continue;
+        }
+
+        lock.unlock();
+        auto start = std::chrono::steady_clock::now();
+        std::shared_ptr<const DecodedTrack> track = ScratchBuffer::decodeFile(path);
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+        lock.lock();
+
+        if (!track) {
+            std::cout << "[CrateDigger] Failed to prefetch " << path << std::endl;
+            continue;
+        }
+        if (m_cache.count(path) == 0 && makeRoom(track->bytes())) {
+            insert(track);
+            std::cout << "[CrateDigger] Prefetched " << path << " (" << (track->bytes() >> 20) << " MB, "
+                      << elapsed.count() << " ms)" << std::endl;
+        }
+    }
+}
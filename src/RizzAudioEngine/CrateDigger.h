@@ -0,0 +1,64 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <cstdint>
+#include "DecodedTrack.h"
+
+// Decoded-track store with predictive prefetch. The UI hints upcoming tracks
+// (next in playlist, highlighted in the library) and a low-priority worker
+// decodes them ahead of time, so LoadFile only has to swap a pointer.
+class CrateDigger {
+public:
+    explicit CrateDigger(size_t memoryBudgetBytes = 512u * 1024u * 1024u);
+    ~CrateDigger();
+
+    // Lower priority value = decoded sooner. Re-hinting updates the priority.
+    void hint(const std::string& filePath, int priority);
+    void clearHints();
+
+    // Returns the cached track (and marks it recently used), or nullptr
+    std::shared_ptr<const DecodedTrack> take(const std::string& filePath);
+    // Keeps a track decoded elsewhere (e.g. a cache miss in LoadFile)
+    void store(std::shared_ptr<const DecodedTrack> track);
+    bool isCached(const std::string& filePath) const;
+
+    void setMemoryBudget(size_t bytes);
+    size_t getCachedBytes() const;
+
+private:
+    struct Hint {
+        std::string path;
+        int priority;
+        uint64_t order;
+    };
+    struct Entry {
+        std::shared_ptr<const DecodedTrack> track;
+        uint64_t lastUse;
+    };
+
+    void workerLoop();
+    bool underPressure() const;
+    bool makeRoom(size_t bytes);   // caller holds m_mutex
+    void insert(std::shared_ptr<const DecodedTrack> track);  // caller holds m_mutex
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::thread m_worker;
+    bool m_running;
+
+    std::vector<Hint> m_hints;
+    std::unordered_map<std::string, Entry> m_cache;
+    size_t m_cachedBytes;
+    size_t m_memoryBudget;
+    uint64_t m_counter;
+
+    // Back-off thresholds
+    static constexpr float kMaxAudioLoad = 0.6f;
+    static constexpr size_t kMinFreeSystemMemory = 256u * 1024u * 1024u;
+};
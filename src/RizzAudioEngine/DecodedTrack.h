@@ -0,0 +1,29 @@
+#pragma once
+
+#include <string>
+#include <cstddef>
+#include <atomic>
+#include "TrackMemory.h"
+
+// Fully decoded track, float at the engine rate (44.1kHz). Mono and stereo
+// are interleaved; stem files (more than two channels, taken as stereo
+// pairs) are planar, one channel after another. Never modified after it is
+// published, so decks and the prefetch cache (CrateDigger) can share one
+// copy through a shared_ptr.
+struct DecodedTrack {
+    std::string path;
+    TrackSamples samples;
+    long length = 0;        // frames
+    int channels = 0;
+    int sampleRate = 0;
+    int bitsPerSample = 0;
+    bool planar = false;
+
+    int stems() const { return planar ? (channels + 1) / 2 : 0; }
+    const float* channel(int index) const { return samples.data() + (size_t)index * length; }
+
+    // Decks that currently hold this track pinned in RAM (see TrackMemory::pin)
+    mutable std::atomic<int> pinCount{0};
+
+    size_t bytes() const { return samples.size() * sizeof(float); }
+};
@@ -0,0 +1,265 @@
+#include "DjEq.h"
+#include <iostream>
+#include <cmath>
+#include <algorithm>
+
+static const float kDefaultLowHz = 250.0f;
+static const float kDefaultHighHz = 2500.0f;
+
+DjEq::DjEq()
+    : m_mode(MODE_LINKWITZ_RILEY), m_lowHz(kDefaultLowHz), m_highHz(kDefaultHighHz), m_activeMode(-1),
+      m_activeLowHz(kDefaultLowHz), m_activeHighHz(kDefaultHighHz) {
+    for (int deck = 0; deck < kMaxDecks; ++deck) {
+        for (int band = 0; band < kBands; ++band) {
+            m_gains[deck][band].store(1.0f, std::memory_order_relaxed);
+            m_kills[deck][band].store(false, std::memory_order_relaxed);
+        }
+    }
+    std::fill(&m_laneGains[0][0], &m_laneGains[0][0] + kBands * kLanes, 1.0f);
+    resetState();
+}
+
+void DjEq::setGain(int deck, int band, float gain) {
+    if (deck < 0 || deck >= kMaxDecks || band < 0 || band >= kBands) return;
+    m_gains[deck][band].store(std::max(0.0f, std::min(2.0f, gain)), std::memory_order_relaxed);
+}
+
+float DjEq::getGain(int deck, int band) const {
+    if (deck < 0 || deck >= kMaxDecks || band < 0 || band >= kBands) return 1.0f;
+    return m_gains[deck][band].load(std::memory_order_relaxed);
+}
+
+void DjEq::setKill(int deck, int band, bool killed) {
+    if (deck < 0 || deck >= kMaxDecks || band < 0 || band >= kBands) return;
+    m_kills[deck][band].store(killed, std::memory_order_relaxed);
+}
+
+bool DjEq::isKilled(int deck, int band) const {
+    if (deck < 0 || deck >= kMaxDecks || band < 0 || band >= kBands) return false;
+    return m_kills[deck][band].load(std::memory_order_relaxed);
+}
+
+void DjEq::setMode(int mode) {
+    if (mode != MODE_BIQUAD && mode != MODE_LINKWITZ_RILEY) return;
+    m_mode.store(mode, std::memory_order_relaxed);
+    std::cout << "[DjEq] Mode set to " << (mode == MODE_BIQUAD ? "biquad (LR2)" : "Linkwitz-Riley (LR4)") << std::endl;
+}
+
+int DjEq::getMode() const {
+    return m_mode.load(std::memory_order_relaxed);
+}
+
+void DjEq::setCrossovers(float lowHz, float highHz) {
+    lowHz = std::max(20.0f, std::min(2000.0f, lowHz));
+    highHz = std::max(lowHz * 1.25f, std::min(16000.0f, highHz));
+    m_lowHz.store(lowHz, std::memory_order_relaxed);
+    m_highHz.store(highHz, std::memory_order_relaxed);
+}
+
+void DjEq::design(int mode, float lowHz, float highHz, Coeffs (&out)[kFilters][kStages]) const {
+    const double pi = 3.14159265358979323846;
+    // Bilinear-transform biquads, prewarped to the crossover frequency
+    auto pass = [&](double hz, double q, bool high, double sign) {
+        double k = std::tan(pi * hz / 44100.0);
+        double norm = 1.0 / (1.0 + k / q + k * k);
+        double b0 = high ? norm : k * k * norm;
+        Coeffs c;
+        c.b0 = (float)(sign * b0);
+        c.b1 = (float)(sign * (high ? -2.0 : 2.0) * b0);
+        c.b2 = (float)(sign * b0);
+        c.a1 = (float)(2.0 * (k * k - 1.0) * norm);
+        c.a2 = (float)((1.0 - k / q + k * k) * norm);
+        return c;
+    };
+
+    if (mode == MODE_LINKWITZ_RILEY) {
+        // LR4: each filter is a squared Butterworth, and LP + HP is the
+        // 2nd-order allpass the low band is passed through at the high split
+        const double q = std::sqrt(0.5);
+        Coeffs lp = pass(lowHz, q, false, 1.0), hp = pass(lowHz, q, true, 1.0);
+        out[LOW][0] = out[LOW][1] = lp;
+        out[REST][0] = out[REST][1] = hp;
+        lp = pass(highHz, q, false, 1.0);
+        hp = pass(highHz, q, true, 1.0);
+        out[MID][0] = out[MID][1] = lp;
+        out[HIGH][0] = out[HIGH][1] = hp;
+        Coeffs ap = lp;
+        ap.b0 = lp.a2;
+        ap.b1 = lp.a1;
+        ap.b2 = 1.0f;
+        out[LOW_ALLPASS][0] = out[LOW_ALLPASS][1] = ap;
+    } else {
+        // LR2: Q = 0.5 with the high side inverted, so LP - HP is a 1st-order
+        // allpass; the high band is inverted twice and comes out upright
+        Coeffs lp = pass(lowHz, 0.5, false, 1.0), hp = pass(lowHz, 0.5, true, -1.0);
+        out[LOW][0] = out[LOW][1] = lp;
+        out[REST][0] = out[REST][1] = hp;
+        out[MID][0] = out[MID][1] = pass(highHz, 0.5, false, 1.0);
+        out[HIGH][0] = out[HIGH][1] = pass(highHz, 0.5, true, -1.0);
+        double k = std::tan(pi * highHz / 44100.0);
+        float c = (float)((k - 1.0) / (k + 1.0));
+        out[LOW_ALLPASS][0] = out[LOW_ALLPASS][1] = {c, 1.0f, 0.0f, c, 0.0f};
+    }
+}
+
+void DjEq::resetState() {
+    for (auto& filter : m_state) {
+        for (State& state : filter) {
+            std::fill(state.z1, state.z1 + kLanes, 0.0f);
+            std::fill(state.z2, state.z2 + kLanes, 0.0f);
+        }
+    }
+}
+
+// One biquad on all lanes at once (transposed direct form II)
+static inline void biquad(float b0, float b1, float b2, float a1, float a2, float* z1, float* z2, float* v) {
+    for (int lane = 0; lane < DjEq::kLanes; ++lane) {
+        float x = v[lane];
+        float y = b0 * x + z1[lane];
+        z1[lane] = b1 * x - a1 * y + z2[lane];
+        z2[lane] = b2 * x - a2 * y;
+        v[lane] = y;
+    }
+}
+
+// The whole crossover tree runs frame by frame, so the recursions of the
+// different filters overlap instead of each waiting on its own feedback
+template <int Stages, bool Glide>
+void DjEq::renderChunk(int frames) {
+    Coeffs step[kFilters][kStages] = {};
+    if (Glide) {
+        // Coefficients move in a straight line, which stays inside the
+        // biquad stability triangle because both ends are inside it
+        float scale = 1.0f / frames;
+        for (int f = 0; f < kFilters; ++f) {
+            for (int s = 0; s < kStages; ++s) {
+                const Coeffs& from = m_coeffs[f][s];
+                const Coeffs& to = m_targets[f][s];
+                step[f][s] = {(to.b0 - from.b0) * scale, (to.b1 - from.b1) * scale, (to.b2 - from.b2) * scale,
+                              (to.a1 - from.a1) * scale, (to.a2 - from.a2) * scale};
+            }
+        }
+    }
+
+    auto run = [&](int f, int s, float* v) {
+        Coeffs& c = m_coeffs[f][s];
+        if (Glide) {
+            c.b0 += step[f][s].b0;
+            c.b1 += step[f][s].b1;
+            c.b2 += step[f][s].b2;
+            c.a1 += step[f][s].a1;
+            c.a2 += step[f][s].a2;
+        }
+        biquad(c.b0, c.b1, c.b2, c.a1, c.a2, m_state[f][s].z1, m_state[f][s].z2, v);
+    };
+
+    for (int i = 0; i < frames; ++i) {
+        alignas(32) float low[kLanes], mid[kLanes], high[kLanes];
+        std::copy(m_lanes[i], m_lanes[i] + kLanes, low);
+        std::copy(m_lanes[i], m_lanes[i] + kLanes, high);
+        run(LOW, 0, low);
+        run(REST, 0, high);
+        if (Stages > 1) {
+            run(LOW, 1, low);
+            run(REST, 1, high);
+        }
+        std::copy(high, high + kLanes, mid);
+        run(MID, 0, mid);
+        run(HIGH, 0, high);
+        if (Stages > 1) {
+            run(MID, 1, mid);
+            run(HIGH, 1, high);
+        }
+        run(LOW_ALLPASS, 0, low);
+
+        for (int lane = 0; lane < kLanes; ++lane) {
+            m_laneGains[BAND_LOW][lane] += m_gainSteps[BAND_LOW][lane];
+            m_laneGains[BAND_MID][lane] += m_gainSteps[BAND_MID][lane];
+            m_laneGains[BAND_HIGH][lane] += m_gainSteps[BAND_HIGH][lane];
+            m_lanes[i][lane] = low[lane] * m_laneGains[BAND_LOW][lane] + mid[lane] * m_laneGains[BAND_MID][lane] +
+                               high[lane] * m_laneGains[BAND_HIGH][lane];
+        }
+    }
+
+    // Flush decaying tails before they turn denormal
+    for (auto& filter : m_state) {
+        for (State& state : filter) {
+            for (int lane = 0; lane < kLanes; ++lane) {
+                if (std::abs(state.z1[lane]) < 1e-15f) state.z1[lane] = 0.0f;
+                if (std::abs(state.z2[lane]) < 1e-15f) state.z2[lane] = 0.0f;
+            }
+        }
+    }
+}
+
+void DjEq::process(float* const* left, float* const* right, int decks, int frames) {
+    decks = std::max(0, std::min(kMaxDecks, decks));
+
+    // Pick up control changes once per block. A new crossover glides over
+    // the first chunk; a new mode restarts the filters.
+    int mode = m_mode.load(std::memory_order_relaxed);
+    float lowHz = m_lowHz.load(std::memory_order_relaxed);
+    float highHz = m_highHz.load(std::memory_order_relaxed);
+    bool glide = false;
+    if (mode != m_activeMode) {
+        design(mode, lowHz, highHz, m_coeffs);
+        design(mode, lowHz, highHz, m_targets);
+        resetState();
+        m_activeMode = mode;
+    } else if (lowHz != m_activeLowHz || highHz != m_activeHighHz) {
+        design(mode, lowHz, highHz, m_targets);
+        glide = true;
+    }
+    m_activeLowHz = lowHz;
+    m_activeHighHz = highHz;
+
+    float targets[kBands][kLanes];
+    for (int deck = 0; deck < kMaxDecks; ++deck) {
+        for (int band = 0; band < kBands; ++band) {
+            float gain = m_kills[deck][band].load(std::memory_order_relaxed) ? 0.0f
+                                                                             : m_gains[deck][band].load(std::memory_order_relaxed);
+            targets[band][deck * 2] = targets[band][deck * 2 + 1] = gain;
+        }
+    }
+
+    for (int done = 0; done < frames; ) {
+        int n = std::min(kChunk, frames - done);
+
+        // Channels into lanes; missing decks run on silence
+        for (int deck = 0; deck < kMaxDecks; ++deck) {
+            bool present = deck < decks && left[deck] && right[deck];
+            for (int i = 0; i < n; ++i) {
+                m_lanes[i][deck * 2] = present ? left[deck][done + i] : 0.0f;
+                m_lanes[i][deck * 2 + 1] = present ? right[deck][done + i] : 0.0f;
+            }
+        }
+
+        // Gains that moved ramp across this chunk
+        float scale = 1.0f / n;
+        for (int band = 0; band < kBands; ++band) {
+            for (int lane = 0; lane < kLanes; ++lane) {
+                m_gainSteps[band][lane] = (targets[band][lane] - m_laneGains[band][lane]) * scale;
+            }
+        }
+        bool lr4 = m_activeMode == MODE_LINKWITZ_RILEY;
+        if (glide) {
+            if (lr4) renderChunk<2, true>(n);
+            else renderChunk<1, true>(n);
+            std::copy(&m_targets[0][0], &m_targets[0][0] + kFilters * kStages, &m_coeffs[0][0]);
+            glide = false;
+        } else {
+            if (lr4) renderChunk<2, false>(n);
+            else renderChunk<1, false>(n);
+        }
+        std::copy(&targets[0][0], &targets[0][0] + kBands * kLanes, &m_laneGains[0][0]);
+
+        for (int deck = 0; deck < decks; ++deck) {
+            if (!left[deck] || !right[deck]) continue;
+            for (int i = 0; i < n; ++i) {
+                left[deck][done + i] = m_lanes[i][deck * 2];
+                right[deck][done + i] = m_lanes[i][deck * 2 + 1];
+            }
+        }
+        done += n;
+    }
+}
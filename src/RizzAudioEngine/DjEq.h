@@ -0,0 +1,73 @@
+#pragma once
+
+#include <atomic>
+
+// Per-deck 3-band isolator EQ with full kills. Each deck is split into
+// low/mid/high by a crossover tree and the bands are summed back at their
+// gains, so unity is flat and a killed band is gone rather than just cut.
+//
+// MODE_BIQUAD uses 2nd-order Linkwitz-Riley splits (one biquad per filter,
+// 12 dB/oct, least group delay); MODE_LINKWITZ_RILEY uses 4th-order splits
+// (24 dB/oct, steeper kills). Both sum to an allpass, so the bands stay in
+// phase. All decks run through the same filters with one SIMD lane per
+// audio channel, so four stereo decks cost about as much as one.
+class DjEq {
+public:
+    static constexpr int kMaxDecks = 4;
+    static constexpr int kLanes = kMaxDecks * 2;
+    enum Band { BAND_LOW = 0, BAND_MID = 1, BAND_HIGH = 2, kBands = 3 };
+    enum Mode { MODE_BIQUAD = 0, MODE_LINKWITZ_RILEY = 1 };
+
+    DjEq();
+
+    // Control side. deck is 0-based; gain is linear 0..2 (-inf..+6 dB).
+    void setGain(int deck, int band, float gain);
+    float getGain(int deck, int band) const;
+    void setKill(int deck, int band, bool killed);
+    bool isKilled(int deck, int band) const;
+    // Switching mode restarts the filters, so it may click once
+    void setMode(int mode);
+    int getMode() const;
+    // Crossover frequencies in Hz; changes glide over the next block
+    void setCrossovers(float lowHz, float highHz);
+
+    // Audio thread: EQ each deck's stereo buffers in place. Null entries
+    // are skipped; decks beyond `decks` are not touched.
+    void process(float* const* left, float* const* right, int decks, int frames);
+
+private:
+    static constexpr int kChunk = 128;
+    static constexpr int kStages = 2;   // biquads per filter in 4th-order mode
+    enum Filter { LOW, REST, MID, HIGH, LOW_ALLPASS, kFilters };
+
+    struct Coeffs {
+        float b0, b1, b2, a1, a2;
+    };
+    // Transposed direct form II state, one lane per channel
+    struct State {
+        alignas(32) float z1[kLanes];
+        alignas(32) float z2[kLanes];
+    };
+
+    void design(int mode, float lowHz, float highHz, Coeffs (&out)[kFilters][kStages]) const;
+    template <int Stages, bool Glide>
+    void renderChunk(int frames);
+    void resetState();
+
+    std::atomic<float> m_gains[kMaxDecks][kBands];
+    std::atomic<bool> m_kills[kMaxDecks][kBands];
+    std::atomic<int> m_mode;
+    std::atomic<float> m_lowHz;
+    std::atomic<float> m_highHz;
+
+    // Audio thread only
+    int m_activeMode;
+    float m_activeLowHz;
+    float m_activeHighHz;
+    Coeffs m_coeffs[kFilters][kStages];
+    Coeffs m_targets[kFilters][kStages];
+    State m_state[kFilters][kStages];
+    float m_laneGains[kBands][kLanes];
+    float m_gainSteps[kBands][kLanes];
+    alignas(32) float m_lanes[kChunk][kLanes];
+};
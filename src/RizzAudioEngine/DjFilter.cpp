@@ -0,0 +1,99 @@
+#include "DjFilter.h"
+#include <cmath>
+#include <algorithm>
+
+// Knob travel: low-pass 20 kHz -> 80 Hz, high-pass 20 Hz -> 10 kHz
+static const float kLowPassFrom = 20000.0f;
+static const float kLowPassTo = 80.0f;
+static const float kHighPassFrom = 20.0f;
+static const float kHighPassTo = 10000.0f;
+// The filter blends in over this much of the travel from the centre
+static const float kFadeTravel = 0.1f;
+// Parameter glide, one-pole at ~10 ms
+static const float kGlide = 1.0f - std::exp(-1.0f / (0.010f * 44100.0f));
+
+DjFilter::DjFilter()
+    : m_requestedPosition(0.0f), m_requestedResonance(0.3f), m_position(0.0f), m_resonance(0.3f), m_a1(1.0f), m_a2(0.0f), m_a3(0.0f), m_k(2.0f), m_wet(0.0f),
+      m_highPass(false), m_idle(true) {
+    m_ic1[0] = m_ic1[1] = 0.0f;
+    m_ic2[0] = m_ic2[1] = 0.0f;
+    updateCoefficients();
+}
+
+void DjFilter::setPosition(float position) {
+    position = std::max(-1.0f, std::min(1.0f, position));
+    m_requestedPosition.store(position, std::memory_order_relaxed);
+}
+
+float DjFilter::getPosition() const {
+    return m_requestedPosition.load(std::memory_order_relaxed);
+}
+
+void DjFilter::setResonance(float resonance) {
+    resonance = std::max(0.0f, std::min(1.0f, resonance));
+    m_requestedResonance.store(resonance, std::memory_order_relaxed);
+}
+
+float DjFilter::getResonance() const {
+    return m_requestedResonance.load(std::memory_order_relaxed);
+}
+
+void DjFilter::updateCoefficients() {
+    float travel = std::abs(m_position);
+    m_highPass = m_position > 0.0f;
+    m_wet = std::min(1.0f, travel / kFadeTravel);
+    float cutoff = m_highPass ? kHighPassFrom * std::pow(kHighPassTo / kHighPassFrom, travel)
+                              : kLowPassFrom * std::pow(kLowPassTo / kLowPassFrom, travel);
+    // Resonance 0..1 is Q 0.5..10
+    m_k = 2.0f - 1.9f * m_resonance;
+    float g = std::tan(3.14159265f * std::min(cutoff, 20000.0f) / 44100.0f);
+    m_a1 = 1.0f / (1.0f + g * (g + m_k));
+    m_a2 = g * m_a1;
+    m_a3 = g * m_a2;
+}
+
+void DjFilter::process(float* left, float* right, int frames) {
+    const float targetPosition = m_requestedPosition.load(std::memory_order_relaxed);
+    const float targetResonance = m_requestedResonance.load(std::memory_order_relaxed);
+
+    // Centred and settled: nothing to do, and the next sweep starts clean
+    if (m_position == 0.0f && targetPosition == 0.0f) {
+        if (!m_idle) {
+            m_ic1[0] = m_ic1[1] = 0.0f;
+            m_ic2[0] = m_ic2[1] = 0.0f;
+            m_idle = true;
+        }
+        m_resonance = targetResonance;
+        return;
+    }
+    m_idle = false;
+
+    float* channels[2] = {left, right};
+    for (int i = 0; i < frames; ++i) {
+        // Glide towards the knob, with new coefficients every sample until
+        // it arrives
+        if (m_position != targetPosition || m_resonance != targetResonance) {
+            m_position += (targetPosition - m_position) * kGlide;
+            m_resonance += (targetResonance - m_resonance) * kGlide;
+            if (std::abs(targetPosition - m_position) < 1e-4f) m_position = targetPosition;
+            if (std::abs(targetResonance - m_resonance) < 1e-4f) m_resonance = targetResonance;
+            updateCoefficients();
+        }
+        for (int ch = 0; ch < 2; ++ch) {
+            float x = channels[ch][i];
+            float v3 = x - m_ic2[ch];
+            float v1 = m_a1 * m_ic1[ch] + m_a2 * v3;
+            float v2 = m_ic2[ch] + m_a2 * m_ic1[ch] + m_a3 * v3;
+            m_ic1[ch] = 2.0f * v1 - m_ic1[ch];
+            m_ic2[ch] = 2.0f * v2 - m_ic2[ch];
+            float y = m_highPass ? x - m_k * v1 - v2 : v2;
+            channels[ch][i] = x + (y - x) * m_wet;
+        }
+    }
+
+    // Flush decaying tails before they turn denormal
+    for (int ch = 0; ch < 2; ++ch) {
+        if (std::abs(m_ic1[ch]) < 1e-15f) m_ic1[ch] = 0.0f;
+        if (std::abs(m_ic2[ch]) < 1e-15f) m_ic2[ch] = 0.0f;
+    }
+}
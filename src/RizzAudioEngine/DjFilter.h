@@ -0,0 +1,44 @@
+#pragma once
+
+#include <atomic>
+
+// Single-knob DJ filter for one deck: left of centre sweeps a low-pass down
+// from 20 kHz, right of centre sweeps a high-pass up from 20 Hz. It is a
+// topology-preserving (trapezoidal) state-variable filter, which stays
+// stable when its coefficients change every sample, and both responses
+// come from the same state, so crossing the centre doesn't reset anything.
+//
+// Knob values are read by the audio thread once per block and glide there,
+// so however fast the knob moves its latest value always arrives. The filter's
+// effect fades in over the first tenth of the travel, so the centre is an
+// exact bypass and a centred filter costs nothing.
+class DjFilter {
+public:
+    DjFilter();
+
+    // Any thread, never blocks. Position -1..1 (0 = off), resonance 0..1.
+    void setPosition(float position);
+    float getPosition() const;
+    void setResonance(float resonance);
+    float getResonance() const;
+
+    // Audio thread: filter a stereo block in place
+    void process(float* left, float* right, int frames);
+
+private:
+    void updateCoefficients();
+
+    std::atomic<float> m_requestedPosition;
+    std::atomic<float> m_requestedResonance;
+
+    // Audio thread only
+    float m_position;
+    float m_resonance;
+    float m_a1, m_a2, m_a3;   // SVF coefficients from g and k
+    float m_k;
+    float m_wet;
+    bool m_highPass;
+    bool m_idle;
+    float m_ic1[2];
+    float m_ic2[2];
+};
@@ -0,0 +1,612 @@
+#include "Effects.h"
+#include "Convolver.h"
+#include "DecodedTrack.h"
+#include <thread>
+#include <chrono>
+#include <cmath>
+#include <algorithm>
+
+static const double kPi = 3.14159265358979323846;
+static const double kSampleRate = 44100.0;
+// Wet, dry and send levels move at most this much per frame (~10 ms sweep)
+static const float kRampStep = 1.0f / 441.0f;
+static const int64_t kRampFrames = 441;
+
+// Keep decaying delay lines and filter states out of the denormal range
+static inline float flush(float value) {
+    return std::abs(value) < 1e-15f ? 0.0f : value;
+}
+
+static inline float rampTowards(float value, float target) {
+    return value + std::max(-kRampStep, std::min(kRampStep, target - value));
+}
+
+// Position in an LFO cycle of `periodBeats`, 0..1, locked to the beat grid
+static inline double cyclePhase(double beat, double periodBeats) {
+    double phase = std::fmod(beat / periodBeats, 1.0);
+    return phase < 0.0 ? phase + 1.0 : phase;
+}
+
+// ---------------------------------------------------------------------------
+// Echo: tempo-synced stereo delay with damped feedback and optional ping-pong
+// ---------------------------------------------------------------------------
+
+class Echo : public Effect {
+public:
+    Echo() : Effect(ECHO, {0.6f, 0.5f, 0.3f, 0.0f}), m_left(kSize), m_right(kSize), m_write(0) { reset(); }
+
+    bool addsToDry() const override { return true; }
+
+    int64_t tailFrames(const EffectContext& context) const override {
+        double feedback = param(1) * kMaxFeedback;
+        double repeats = feedback > 0.001 ? std::log(1e-3) / std::log(feedback) : 0.0;
+        return (int64_t)(delayFor(context) * (repeats + 1.0));
+    }
+
+    void process(float* left, float* right, int frames, const EffectContext& context) override {
+        float target = (float)delayFor(context);
+        if (m_delay <= 0.0f) m_delay = target;
+        float feedback = param(1) * kMaxFeedback;
+        float damping = 1.0f - param(2) * 0.85f;
+        bool pingPong = param(3) > 0.5f;
+
+        for (int i = 0; i < frames; ++i) {
+            // A new time glides, so the repeats bend in pitch instead of clicking
+            m_delay += (target - m_delay) * kTimeGlide;
+            float position = (float)m_write - m_delay;
+            if (position < 0.0f) position += kSize;
+            int i0 = (int)position;
+            int i1 = (i0 + 1) & kMask;
+            float frac = position - i0;
+            // Anything written before the last reset reads as silence
+            float w0 = ((m_write - i0) & kMask) <= m_history ? 1.0f - frac : 0.0f;
+            float w1 = ((m_write - i1) & kMask) <= m_history ? frac : 0.0f;
+            float delayedLeft = m_left[i0] * w0 + m_left[i1] * w1;
+            float delayedRight = m_right[i0] * w0 + m_right[i1] * w1;
+
+            m_dampLeft += (delayedLeft - m_dampLeft) * damping;
+            m_dampRight += (delayedRight - m_dampRight) * damping;
+            if (pingPong) {
+                // Mono in on the left; each repeat crosses to the other side
+                m_left[m_write] = flush(0.5f * (left[i] + right[i]) + m_dampRight * feedback);
+                m_right[m_write] = flush(m_dampLeft * feedback);
+            } else {
+                m_left[m_write] = flush(left[i] + m_dampLeft * feedback);
+                m_right[m_write] = flush(right[i] + m_dampRight * feedback);
+            }
+            left[i] = delayedLeft;
+            right[i] = delayedRight;
+            m_write = (m_write + 1) & kMask;
+            m_history += m_history < kSize ? 1 : 0;
+        }
+        m_dampLeft = flush(m_dampLeft);
+        m_dampRight = flush(m_dampRight);
+    }
+
+    // Runs on the audio thread when a tail ends, so the 2 MB of delay line
+    // isn't cleared; reads just stop reaching back past this point
+    void reset() override {
+        m_history = 0;
+        m_delay = 0.0f;
+        m_dampLeft = m_dampRight = 0.0f;
+    }
+
+private:
+    static constexpr int kSize = 1 << 18;   // ~5.9 s, four beats down to 45 BPM
+    static constexpr int kMask = kSize - 1;
+    static constexpr float kMaxFeedback = 0.95f;
+    static constexpr float kTimeGlide = 1.0f / 2205.0f;   // ~50 ms
+
+    double delayFor(const EffectContext& context) const {
+        double frames = beatsFor(param(0), 0.125, 4.0) * 60.0 / context.bpm * kSampleRate;
+        return std::max(1.0, std::min((double)kSize - 2.0, frames));
+    }
+
+    std::vector<float> m_left;
+    std::vector<float> m_right;
+    int m_write;
+    int m_history;   // frames written since the last reset, up to kSize
+    float m_delay;
+    float m_dampLeft;
+    float m_dampRight;
+};
+
+// ---------------------------------------------------------------------------
+// Reverb: Freeverb (Schroeder-Moorer), eight damped combs into four allpasses
+// per side, with the right side's delays spread for stereo width
+// ---------------------------------------------------------------------------
+
+class Reverb : public Effect {
+public:
+    Reverb() : Effect(REVERB, {0.6f, 0.5f, 1.0f, 0.0f}) {
+        static const int kCombTuning[kCombs] = {1116, 1188, 1277, 1356, 1422, 1491, 1557, 1617};
+        static const int kAllpassTuning[kAllpasses] = {556, 441, 341, 225};
+        for (int ch = 0; ch < 2; ++ch) {
+            int spread = ch == 0 ? 0 : kStereoSpread;
+            for (int c = 0; c < kCombs; ++c) m_combs[ch][c].buffer.resize(kCombTuning[c] + spread);
+            for (int a = 0; a < kAllpasses; ++a) m_allpasses[ch][a].buffer.resize(kAllpassTuning[a] + spread);
+        }
+        reset();
+    }
+
+    bool addsToDry() const override { return true; }
+
+    int64_t tailFrames(const EffectContext&) const override {
+        // RT60 of the longest comb
+        double feedback = roomFeedback();
+        return (int64_t)((1617 + kStereoSpread) * std::log(1e-3) / std::log(feedback));
+    }
+
+    void process(float* left, float* right, int frames, const EffectContext&) override {
+        float feedback = roomFeedback();
+        float damping = param(1) * 0.4f;
+        float width = param(2);
+        float wet1 = kWetScale * (0.5f + width * 0.5f);
+        float wet2 = kWetScale * (0.5f - width * 0.5f);
+
+        for (int i = 0; i < frames; ++i) {
+            float input = (left[i] + right[i]) * kInputGain;
+            float out[2];
+            for (int ch = 0; ch < 2; ++ch) {
+                float sum = 0.0f;
+                for (Comb& comb : m_combs[ch]) {
+                    float y = comb.buffer[comb.index];
+                    comb.store = y * (1.0f - damping) + comb.store * damping;
+                    comb.buffer[comb.index] = flush(input + comb.store * feedback);
+                    if (++comb.index == (int)comb.buffer.size()) comb.index = 0;
+                    sum += y;
+                }
+                for (Allpass& allpass : m_allpasses[ch]) {
+                    float delayed = allpass.buffer[allpass.index];
+                    allpass.buffer[allpass.index] = flush(sum + delayed * 0.5f);
+                    if (++allpass.index == (int)allpass.buffer.size()) allpass.index = 0;
+                    sum = delayed - sum;
+                }
+                out[ch] = sum;
+            }
+            left[i] = out[0] * wet1 + out[1] * wet2;
+            right[i] = out[1] * wet1 + out[0] * wet2;
+        }
+        for (auto& side : m_combs) {
+            for (Comb& comb : side) comb.store = flush(comb.store);
+        }
+    }
+
+    void reset() override {
+        for (int ch = 0; ch < 2; ++ch) {
+            for (Comb& comb : m_combs[ch]) {
+                std::fill(comb.buffer.begin(), comb.buffer.end(), 0.0f);
+                comb.index = 0;
+                comb.store = 0.0f;
+            }
+            for (Allpass& allpass : m_allpasses[ch]) {
+                std::fill(allpass.buffer.begin(), allpass.buffer.end(), 0.0f);
+                allpass.index = 0;
+            }
+        }
+    }
+
+private:
+    static constexpr int kCombs = 8;
+    static constexpr int kAllpasses = 4;
+    static constexpr int kStereoSpread = 23;
+    static constexpr float kInputGain = 0.015f;
+    static constexpr float kWetScale = 3.0f;
+
+    struct Comb {
+        std::vector<float> buffer;
+        int index;
+        float store;
+    };
+    struct Allpass {
+        std::vector<float> buffer;
+        int index;
+    };
+
+    float roomFeedback() const { return 0.7f + 0.28f * param(0); }
+
+    Comb m_combs[2][kCombs];
+    Allpass m_allpasses[2][kAllpasses];
+};
+
+// ---------------------------------------------------------------------------
+// Flanger: short modulated delay summed with the input, the sweep locked to
+// the beat and the right side a quarter cycle ahead
+// ---------------------------------------------------------------------------
+
+class Flanger : public Effect {
+public:
+    Flanger() : Effect(FLANGER, {0.6f, 0.7f, 0.5f, 0.2f}), m_left(kSize), m_right(kSize) { reset(); }
+
+    bool addsToDry() const override { return false; }
+
+    int64_t tailFrames(const EffectContext&) const override { return kSize; }
+
+    void process(float* left, float* right, int frames, const EffectContext& context) override {
+        double period = beatsFor(param(0), 0.5, 16.0);
+        double step = 2.0 * kPi * context.bpm / (60.0 * kSampleRate) / period;
+        double phase = 2.0 * kPi * cyclePhase(context.beat, period);
+        // Sine and cosine by rotation, restarted from the clock every block
+        float s = (float)std::sin(phase), c = (float)std::cos(phase);
+        float ds = (float)std::sin(step), dc = (float)std::cos(step);
+        // 1..5 ms centre, up to 5 ms of sweep
+        float base = 44.0f + param(3) * 176.0f;
+        float sweep = param(1) * 110.0f;
+        float feedback = param(2) * kMaxFeedback;
+
+        for (int i = 0; i < frames; ++i) {
+            float delays[2] = {base + sweep * (1.0f + s), base + sweep * (1.0f + c)};
+            float* lines[2] = {m_left.data(), m_right.data()};
+            float* io[2] = {left + i, right + i};
+            for (int ch = 0; ch < 2; ++ch) {
+                float position = (float)m_write - delays[ch];
+                if (position < 0.0f) position += kSize;
+                int i0 = (int)position;
+                int i1 = (i0 + 1) & kMask;
+                float frac = position - i0;
+                float delayed = lines[ch][i0] + (lines[ch][i1] - lines[ch][i0]) * frac;
+                float x = *io[ch];
+                lines[ch][m_write] = flush(x + delayed * feedback);
+                *io[ch] = 0.5f * (x + delayed);
+            }
+            m_write = (m_write + 1) & kMask;
+            float ns = s * dc + c * ds;
+            c = c * dc - s * ds;
+            s = ns;
+        }
+    }
+
+    void reset() override {
+        std::fill(m_left.begin(), m_left.end(), 0.0f);
+        std::fill(m_right.begin(), m_right.end(), 0.0f);
+        m_write = 0;
+    }
+
+private:
+    static constexpr int kSize = 1024;
+    static constexpr int kMask = kSize - 1;
+    static constexpr float kMaxFeedback = 0.7f;
+
+    std::vector<float> m_left;
+    std::vector<float> m_right;
+    int m_write;
+};
+
+// ---------------------------------------------------------------------------
+// Phaser: a chain of first-order allpasses whose break frequency follows the
+// beat-locked LFO, mixed back with the input to cut moving notches
+// ---------------------------------------------------------------------------
+
+class Phaser : public Effect {
+public:
+    Phaser() : Effect(PHASER, {0.6f, 0.7f, 0.5f, 0.35f}) { reset(); }
+
+    bool addsToDry() const override { return false; }
+
+    int64_t tailFrames(const EffectContext&) const override { return kUpdateFrames; }
+
+    void process(float* left, float* right, int frames, const EffectContext& context) override {
+        double period = beatsFor(param(0), 0.5, 16.0);
+        double beatsPerFrame = context.bpm / (60.0 * kSampleRate);
+        float depth = param(1);
+        float feedback = param(2) * kMaxFeedback;
+        int stages = 2 * (1 + (int)std::lround(param(3) * 3.0f));
+
+        for (int done = 0; done < frames; done += kUpdateFrames) {
+            int n = std::min(kUpdateFrames, frames - done);
+            double phase = 2.0 * kPi * cyclePhase(context.beat + done * beatsPerFrame, period);
+            float lfo[2] = {(float)(0.5 + 0.5 * std::sin(phase)), (float)(0.5 + 0.5 * std::cos(phase))};
+            float a[2];
+            for (int ch = 0; ch < 2; ++ch) {
+                double hz = kMinHz * std::pow(kMaxHz / kMinHz, depth * lfo[ch]);
+                double t = std::tan(kPi * hz / kSampleRate);
+                a[ch] = (float)((t - 1.0) / (t + 1.0));
+            }
+            // Both sides in one pass, so their allpass chains overlap
+            for (int i = done; i < done + n; ++i) {
+                float x[2] = {left[i] + m_last[0] * feedback, right[i] + m_last[1] * feedback};
+                for (int s = 0; s < stages; ++s) {
+                    for (int ch = 0; ch < 2; ++ch) {
+                        float y = a[ch] * x[ch] + m_state[ch][s];
+                        m_state[ch][s] = x[ch] - a[ch] * y;
+                        x[ch] = y;
+                    }
+                }
+                m_last[0] = x[0];
+                m_last[1] = x[1];
+                left[i] = 0.5f * (left[i] + x[0]);
+                right[i] = 0.5f * (right[i] + x[1]);
+            }
+        }
+        for (int ch = 0; ch < 2; ++ch) {
+            for (float& z : m_state[ch]) z = flush(z);
+            m_last[ch] = flush(m_last[ch]);
+        }
+    }
+
+    void reset() override {
+        for (int ch = 0; ch < 2; ++ch) {
+            std::fill(m_state[ch], m_state[ch] + kMaxStages, 0.0f);
+            m_last[ch] = 0.0f;
+        }
+    }
+
+private:
+    static constexpr int kMaxStages = 8;
+    static constexpr int kUpdateFrames = 8;
+    static constexpr double kMinHz = 200.0;
+    static constexpr double kMaxHz = 6400.0;
+    static constexpr float kMaxFeedback = 0.7f;
+
+    float m_state[2][kMaxStages];
+    float m_last[2];
+};
+
+// ---------------------------------------------------------------------------
+// Convolution: an impulse response through the partitioned convolver, so a
+// multi-second venue response adds no latency and little audio-thread time
+// ---------------------------------------------------------------------------
+
+class Convolution : public Effect {
+public:
+    Convolution(const float* left, const float* right, int length)
+        : Effect(CONVOLUTION, {}), m_convolver(left, right, length) {}
+
+    bool addsToDry() const override { return true; }
+
+    int64_t tailFrames(const EffectContext&) const override { return m_convolver.tailFrames(); }
+
+    void process(float* left, float* right, int frames, const EffectContext&) override {
+        m_convolver.process(left, right, left, right, frames);
+    }
+
+    // The rack only resets once the input has been silent for the whole
+    // tail, by which point every partition has already drained to zero
+    void reset() override {}
+
+private:
+    Convolver m_convolver;
+};
+
+// ---------------------------------------------------------------------------
+// Effect
+// ---------------------------------------------------------------------------
+
+Effect::Effect(int type, std::initializer_list<float> defaults) : m_type(type) {
+    int index = 0;
+    for (float value : defaults) {
+        if (index < kMaxParams) m_params[index++].store(value, std::memory_order_relaxed);
+    }
+    while (index < kMaxParams) m_params[index++].store(0.0f, std::memory_order_relaxed);
+}
+
+std::unique_ptr<Effect> Effect::create(int type) {
+    switch (type) {
+        case ECHO: return std::unique_ptr<Effect>(new Echo());
+        case REVERB: return std::unique_ptr<Effect>(new Reverb());
+        case FLANGER: return std::unique_ptr<Effect>(new Flanger());
+        case PHASER: return std::unique_ptr<Effect>(new Phaser());
+        default: return nullptr;
+    }
+}
+
+std::unique_ptr<Effect> Effect::createConvolution(const DecodedTrack& impulse) {
+    const long kMaxLength = 10 * 44100;
+    long length = std::min(impulse.length, kMaxLength);
+    if (length <= 0 || impulse.channels <= 0) return nullptr;
+
+    std::vector<float> left(length), right(length);
+    bool stereo = impulse.channels > 1;
+    for (long i = 0; i < length; ++i) {
+        if (impulse.planar) {
+            left[i] = impulse.channel(0)[i];
+            right[i] = stereo ? impulse.channel(1)[i] : left[i];
+        } else {
+            left[i] = impulse.samples[i * impulse.channels];
+            right[i] = stereo ? impulse.samples[i * impulse.channels + 1] : left[i];
+        }
+    }
+
+    // Unit energy per side, so noise comes out at the level it went in
+    // whatever the response was recorded at
+    double energy = 0.0;
+    for (long i = 0; i < length; ++i) energy += left[i] * left[i] + right[i] * right[i];
+    if (energy <= 0.0) return nullptr;
+    float scale = (float)(1.0 / std::sqrt(energy * 0.5));
+    for (long i = 0; i < length; ++i) {
+        left[i] *= scale;
+        right[i] *= scale;
+    }
+    return std::unique_ptr<Effect>(new Convolution(left.data(), stereo ? right.data() : nullptr, (int)length));
+}
+
+void Effect::setParameter(int index, float value) {
+    if (index < 0 || index >= kMaxParams) return;
+    m_params[index].store(std::max(0.0f, std::min(1.0f, value)), std::memory_order_relaxed);
+}
+
+float Effect::getParameter(int index) const {
+    if (index < 0 || index >= kMaxParams) return 0.0f;
+    return m_params[index].load(std::memory_order_relaxed);
+}
+
+double Effect::beatsFor(float value, double shortest, double longest) {
+    double steps = std::round(std::log2(longest / shortest));
+    return shortest * std::pow(2.0, std::round(value * steps));
+}
+
+// ---------------------------------------------------------------------------
+// EffectRack
+// ---------------------------------------------------------------------------
+
+EffectRack::EffectRack() {
+    std::fill(m_wetLeft, m_wetLeft + kChunk, 0.0f);
+    std::fill(m_wetRight, m_wetRight + kChunk, 0.0f);
+}
+
+EffectRack::~EffectRack() = default;
+
+bool EffectRack::setEffect(int slot, int type) {
+    if (slot < 0 || slot >= kSlots) return false;
+    // Build (and allocate) before taking the lock
+    std::unique_ptr<Effect> effect = Effect::create(type);
+    if (type != Effect::NONE && !effect) return false;
+    return setEffect(slot, std::move(effect));
+}
+
+bool EffectRack::setEffect(int slot, std::unique_ptr<Effect> effect) {
+    if (slot < 0 || slot >= kSlots) return false;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Slot& s = m_slots[slot];
+    std::unique_ptr<Effect> previous = std::move(s.effect);
+    s.effect = std::move(effect);
+    s.active.store(s.effect.get(), std::memory_order_release);
+    uint64_t switchCount = s.switches.fetch_add(1, std::memory_order_release) + 1;
+    if (!previous) return true;
+    if (waitForSwitch(s, switchCount)) {
+        s.retired.clear();
+    } else {
+        // The stream isn't running; the audio thread may still pick it up
+        s.retired.push_back(std::move(previous));
+    }
+    return true;
+}
+
+bool EffectRack::waitForSwitch(Slot& slot, uint64_t switchCount) {
+    // Give up after a few buffers' worth of time if nothing is rendering
+    for (int i = 0; i < 50; ++i) {
+        if (slot.rendered.load(std::memory_order_acquire) >= switchCount) {
+            return true;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+    return false;
+}
+
+int EffectRack::getEffect(int slot) const {
+    if (slot < 0 || slot >= kSlots) return Effect::NONE;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_slots[slot].effect ? m_slots[slot].effect->getType() : Effect::NONE;
+}
+
+void EffectRack::setParameter(int slot, int index, float value) {
+    if (slot < 0 || slot >= kSlots) return;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_slots[slot].effect) m_slots[slot].effect->setParameter(index, value);
+}
+
+float EffectRack::getParameter(int slot, int index) const {
+    if (slot < 0 || slot >= kSlots) return 0.0f;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_slots[slot].effect ? m_slots[slot].effect->getParameter(index) : 0.0f;
+}
+
+void EffectRack::setEnabled(int slot, bool enabled) {
+    if (slot < 0 || slot >= kSlots) return;
+    m_slots[slot].enabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool EffectRack::isEnabled(int slot) const {
+    if (slot < 0 || slot >= kSlots) return false;
+    return m_slots[slot].enabled.load(std::memory_order_relaxed);
+}
+
+void EffectRack::setMix(int slot, float mix) {
+    if (slot < 0 || slot >= kSlots) return;
+    m_slots[slot].mix.store(std::max(0.0f, std::min(1.0f, mix)), std::memory_order_relaxed);
+}
+
+float EffectRack::getMix(int slot) const {
+    if (slot < 0 || slot >= kSlots) return 0.0f;
+    return m_slots[slot].mix.load(std::memory_order_relaxed);
+}
+
+void EffectRack::process(float* left, float* right, int frames, const EffectContext& context) {
+    for (Slot& slot : m_slots) {
+        processSlot(slot, left, right, frames, context);
+    }
+}
+
+void EffectRack::processSlot(Slot& slot, float* left, float* right, int frames, const EffectContext& context) {
+    // Pick up a new effect. The count is read first, so the effect seen is at
+    // least as new as the switch being acknowledged; the old one is dropped
+    // on the spot and never touched again.
+    uint64_t switchCount = slot.switches.load(std::memory_order_acquire);
+    if (slot.rendered.load(std::memory_order_relaxed) != switchCount) {
+        slot.current = slot.active.load(std::memory_order_acquire);
+        slot.running = false;
+        slot.tail = -1;
+        slot.rendered.store(switchCount, std::memory_order_release);
+    }
+
+    Effect* effect = slot.current;
+    bool enabled = slot.enabled.load(std::memory_order_relaxed);
+    if (!effect || (!enabled && !slot.running)) return;
+
+    if (!slot.running) {
+        slot.running = true;
+        slot.send = 0.0f;
+        slot.wet = 0.0f;
+        slot.dry = 1.0f;
+    }
+
+    // Dry stays full up to half mix and wet reaches full at half mix, so
+    // the middle of the knob is both at unity
+    float mix = slot.mix.load(std::memory_order_relaxed);
+    float wetLevel = std::min(1.0f, 2.0f * mix);
+    float dryLevel = std::min(1.0f, 2.0f * (1.0f - mix));
+    bool addsToDry = effect->addsToDry();
+    float sendTarget, wetTarget, dryTarget;
+    if (enabled) {
+        slot.tail = -1;
+        sendTarget = 1.0f;
+        wetTarget = wetLevel;
+        dryTarget = dryLevel;
+    } else {
+        // Bypassed: echo and reverb stop being fed but keep ringing at the
+        // same level; inserts fade back to the dry signal
+        if (slot.tail < 0) slot.tail = effect->tailFrames(context) + kRampFrames;
+        sendTarget = addsToDry ? 0.0f : 1.0f;
+        wetTarget = addsToDry ? slot.wet : 0.0f;
+        dryTarget = 1.0f;
+    }
+
+    double beatsPerFrame = context.bpm / (60.0 * kSampleRate);
+    for (int done = 0; done < frames; ) {
+        int n = std::min(kChunk, frames - done);
+        float* l = left + done;
+        float* r = right + done;
+
+        float send = slot.send;
+        for (int i = 0; i < n; ++i) {
+            send = rampTowards(send, sendTarget);
+            m_wetLeft[i] = l[i] * send;
+            m_wetRight[i] = r[i] * send;
+        }
+        slot.send = send;
+
+        EffectContext chunkContext = {context.bpm, context.beat + done * beatsPerFrame};
+        effect->process(m_wetLeft, m_wetRight, n, chunkContext);
+
+        float wet = slot.wet, dry = slot.dry;
+        for (int i = 0; i < n; ++i) {
+            wet = rampTowards(wet, wetTarget);
+            dry = rampTowards(dry, dryTarget);
+            l[i] = l[i] * dry + m_wetLeft[i] * wet;
+            r[i] = r[i] * dry + m_wetRight[i] * wet;
+        }
+        slot.wet = wet;
+        slot.dry = dry;
+        done += n;
+    }
+
+    // Once the tail has died away the slot goes idle and costs nothing
+    if (!enabled) {
+        slot.tail -= frames;
+        if (slot.tail <= 0) {
+            effect->reset();
+            slot.running = false;
+            slot.tail = -1;
+        }
+    }
+}
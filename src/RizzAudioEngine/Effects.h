@@ -0,0 +1,125 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <cstdint>
+#include <initializer_list>
+
+struct DecodedTrack;
+
+// Master clock state at the start of the block being processed
+struct EffectContext {
+    double bpm;
+    double beat;
+};
+
+// One insert effect. Its constructor allocates every delay line and buffer
+// it will use, so it is built on a control thread and the audio thread only
+// ever runs it. Parameters are 0..1 and can be set from any thread:
+//   ECHO     0 time (1/8..4 beats)  1 feedback  2 damping  3 ping-pong (> 0.5)
+//   REVERB   0 size  1 damping  2 width
+//   FLANGER  0 period (1/2..16 beats)  1 depth  2 feedback  3 delay
+//   PHASER   0 period (1/2..16 beats)  1 depth  2 feedback  3 stages (2..8)
+//   CONVOLUTION  none; the sound is the impulse response it was built from
+class Effect {
+public:
+    enum Type { NONE = 0, ECHO = 1, REVERB = 2, FLANGER = 3, PHASER = 4, CONVOLUTION = 5 };
+    static constexpr int kMaxParams = 4;
+
+    // nullptr for NONE, CONVOLUTION or an unknown type
+    static std::unique_ptr<Effect> create(int type);
+    // Convolution reverb or cabinet from an impulse response at the engine
+    // rate (first two channels, up to 10 s), normalised to unit energy;
+    // nullptr if it is empty
+    static std::unique_ptr<Effect> createConvolution(const DecodedTrack& impulse);
+    virtual ~Effect() {}
+
+    int getType() const { return m_type; }
+    void setParameter(int index, float value);
+    float getParameter(int index) const;
+
+    // Echo and reverb add their wet signal on top of the dry one; the
+    // others replace it, so wet/dry crossfades between the two
+    virtual bool addsToDry() const = 0;
+    // How long the effect keeps sounding once its input stops
+    virtual int64_t tailFrames(const EffectContext& context) const = 0;
+    // Audio thread: turn the input into the wet signal in place
+    virtual void process(float* left, float* right, int frames, const EffectContext& context) = 0;
+    // Audio thread: silence every delay line and filter
+    virtual void reset() = 0;
+
+protected:
+    Effect(int type, std::initializer_list<float> defaults);
+    float param(int index) const { return m_params[index].load(std::memory_order_relaxed); }
+    // Beats from a 0..1 parameter, in powers of two from `shortest`
+    static double beatsFor(float value, double shortest, double longest);
+
+private:
+    const int m_type;
+    std::atomic<float> m_params[kMaxParams];
+};
+
+// A chain of insert slots for one deck or the master. Slots run in series;
+// an empty or switched-off slot costs nothing. Switching a slot off stops
+// feeding it but lets echo and reverb ring out before it goes idle.
+class EffectRack {
+public:
+    static constexpr int kSlots = 3;
+
+    EffectRack();
+    ~EffectRack();
+
+    // Control side: builds the effect (allocating its buffers) and swaps it
+    // into the slot; NONE empties the slot. The old effect is cut off.
+    bool setEffect(int slot, int type);
+    // Same, for an effect built elsewhere (e.g. createConvolution)
+    bool setEffect(int slot, std::unique_ptr<Effect> effect);
+    int getEffect(int slot) const;
+    void setParameter(int slot, int index, float value);
+    float getParameter(int slot, int index) const;
+
+    // Any thread
+    void setEnabled(int slot, bool enabled);
+    bool isEnabled(int slot) const;
+    void setMix(int slot, float mix);
+    float getMix(int slot) const;
+
+    // Audio thread: run the chain on a stereo block in place
+    void process(float* left, float* right, int frames, const EffectContext& context);
+
+private:
+    static constexpr int kChunk = 256;
+
+    struct Slot {
+        // Control side, under m_mutex. The audio thread only sees `active`;
+        // each change bumps `switches`, and the audio thread copies the
+        // count into `rendered` once it has stopped using the old effect.
+        std::unique_ptr<Effect> effect;
+        std::vector<std::unique_ptr<Effect>> retired;
+        std::atomic<Effect*> active{nullptr};
+        std::atomic<uint64_t> switches{0};
+        std::atomic<uint64_t> rendered{0};
+        std::atomic<bool> enabled{false};
+        std::atomic<float> mix{0.5f};
+
+        // Audio thread only
+        Effect* current = nullptr;
+        bool running = false;
+        int64_t tail = -1;   // frames left to ring out once bypassed
+        float send = 0.0f;
+        float wet = 0.0f;
+        float dry = 1.0f;
+    };
+
+    void processSlot(Slot& slot, float* left, float* right, int frames, const EffectContext& context);
+    bool waitForSwitch(Slot& slot, uint64_t switchCount);
+
+    mutable std::mutex m_mutex;
+    Slot m_slots[kSlots];
+
+    // Audio thread scratch for the wet signal
+    float m_wetLeft[kChunk];
+    float m_wetRight[kChunk];
+};
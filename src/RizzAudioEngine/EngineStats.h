@@ -0,0 +1,23 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// Counters published by the audio callback. Written only from the audio
+// thread, read from anywhere without locking.
+struct EngineStats {
+    static constexpr int kMaxDecks = 4;
+
+    std::atomic<float> audioLoad{0.0f};      // smoothed callback time / buffer time
+    std::atomic<float> audioLoadPeak{0.0f};  // worst single callback since last read
+    std::atomic<uint64_t> callbackCount{0};
+    std::atomic<uint64_t> audioMinorFaults{0};  // page faults inside the callback
+    std::atomic<uint64_t> audioMajorFaults{0};
+    std::atomic<float> deckShiftLoad[kMaxDecks] = {};  // key-lock/shift time / block time
+    std::atomic<float> outputDspLoad{0.0f};  // master protection chain time / block time
+};
+
+inline EngineStats& engineStats() {
+    static EngineStats stats;
+    return stats;
+}
@@ -0,0 +1,67 @@
+#include "Fft.h"
+#include <cmath>
+#include <utility>
+
+Fft::Fft(int size) : m_size(size), m_bitReverse(size), m_twRe(size), m_twImForward(size), m_twImInverse(size) {
+    int bits = 0;
+    while ((1 << bits) < size) ++bits;
+    for (int i = 0; i < size; ++i) {
+        int r = 0;
+        for (int b = 0; b < bits; ++b) {
+            if (i & (1 << b)) r |= 1 << (bits - 1 - b);
+        }
+        m_bitReverse[i] = r;
+    }
+
+    const double pi = 3.14159265358979323846;
+    for (int half = 1; half < size; half <<= 1) {
+        for (int j = 0; j < half; ++j) {
+            double angle = pi * j / half;
+            m_twRe[half - 1 + j] = (float)std::cos(angle);
+            m_twImForward[half - 1 + j] = (float)-std::sin(angle);
+            m_twImInverse[half - 1 + j] = (float)std::sin(angle);
+        }
+    }
+}
+
+void Fft::forward(float* re, float* im) const {
+    transform(re, im, m_twImForward.data());
+}
+
+void Fft::inverse(float* re, float* im) const {
+    transform(re, im, m_twImInverse.data());
+    const float scale = 1.0f / m_size;
+    for (int i = 0; i < m_size; ++i) {
+        re[i] *= scale;
+        im[i] *= scale;
+    }
+}
+
+void Fft::transform(float* re, float* im, const float* twIm) const {
+    for (int i = 0; i < m_size; ++i) {
+        int j = m_bitReverse[i];
+        if (j > i) {
+            std::swap(re[i], re[j]);
+            std::swap(im[i], im[j]);
+        }
+    }
+
+    for (int half = 1; half < m_size; half <<= 1) {
+        const float* __restrict wr = m_twRe.data() + half - 1;
+        const float* __restrict wi = twIm + half - 1;
+        for (int start = 0; start < m_size; start += 2 * half) {
+            float* __restrict ar = re + start;
+            float* __restrict ai = im + start;
+            float* __restrict br = re + start + half;
+            float* __restrict bi = im + start + half;
+            for (int j = 0; j < half; ++j) {
+                float tr = br[j] * wr[j] - bi[j] * wi[j];
+                float ti = br[j] * wi[j] + bi[j] * wr[j];
+                br[j] = ar[j] - tr;
+                bi[j] = ai[j] - ti;
+                ar[j] += tr;
+                ai[j] += ti;
+            }
+        }
+    }
+}
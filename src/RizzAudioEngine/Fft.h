@@ -0,0 +1,26 @@
+#pragma once
+
+#include <vector>
+
+// Radix-2 complex FFT on split real/imaginary arrays. Twiddles are stored
+// per stage so every butterfly loop walks contiguous memory and vectorizes.
+// Construct off the audio thread; forward/inverse never allocate.
+class Fft {
+public:
+    explicit Fft(int size);
+
+    int size() const { return m_size; }
+
+    // In place. inverse() includes the 1/N scaling.
+    void forward(float* re, float* im) const;
+    void inverse(float* re, float* im) const;
+
+private:
+    void transform(float* re, float* im, const float* twIm) const;
+
+    int m_size;
+    std::vector<int> m_bitReverse;
+    std::vector<float> m_twRe;          // stage h uses entries [h - 1, 2h - 1)
+    std::vector<float> m_twImForward;
+    std::vector<float> m_twImInverse;
+};
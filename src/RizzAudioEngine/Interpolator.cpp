@@ -0,0 +1,45 @@
+#include "Interpolator.h"
+#include <cmath>
+
+// Zeroth-order modified Bessel function, for the Kaiser window
+static double besselI0(double x) {
+    double sum = 1.0;
+    double term = 1.0;
+    for (int k = 1; k < 32; ++k) {
+        term *= (x / (2.0 * k)) * (x / (2.0 * k));
+        sum += term;
+    }
+    return sum;
+}
+
+const SincTable& SincTable::instance() {
+    static const SincTable table;
+    return table;
+}
+
+SincTable::SincTable() {
+    const double pi = 3.14159265358979323846;
+    const double beta = 8.0;
+    const double halfWidth = kTaps / 2.0;
+    const int before = kTaps / 2 - 1;
+
+    for (int c = 0; c < kCutoffs; ++c) {
+        double cutoff = 0.9 / (double)(1 << c);
+        for (int phase = 0; phase <= kPhases; ++phase) {
+            double frac = (double)phase / kPhases;
+            double sum = 0.0;
+            for (int i = 0; i < kTaps; ++i) {
+                double x = (i - before) - frac;
+                double s = (x == 0.0) ? 1.0 : std::sin(pi * cutoff * x) / (pi * cutoff * x);
+                double r = x / halfWidth;
+                double window = (std::abs(r) >= 1.0) ? 0.0 : besselI0(beta * std::sqrt(1.0 - r * r)) / besselI0(beta);
+                m_table[c][phase][i] = (float)(s * window);
+                sum += s * window;
+            }
+            // Unity gain at DC for every phase
+            for (int i = 0; i < kTaps; ++i) {
+                m_table[c][phase][i] = (float)(m_table[c][phase][i] / sum);
+            }
+        }
+    }
+}
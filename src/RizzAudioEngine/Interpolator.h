@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+// Fractional read kernels for variable-rate playback. Positions are 32.32
+// fixed point; each kernel turns the 32-bit fraction into a small set of tap
+// weights, then a plain dot product (which the compiler vectorizes) applies
+// them to however many channels share that position.
+enum InterpolationMode { INTERP_LINEAR = 0, INTERP_HERMITE = 1, INTERP_SINC = 2 };
+
+static constexpr int kFixedShift = 32;
+static constexpr int64_t kFixedOne = (int64_t)1 << kFixedShift;
+static constexpr float kFracScale = 1.0f / 4294967296.0f;
+
+inline int64_t toFixed(double value) { return (int64_t)(value * (double)kFixedOne); }
+inline double fromFixed(int64_t value) { return (double)value / (double)kFixedOne; }
+
+struct LinearInterp {
+    static constexpr int kBefore = 0;
+    static constexpr int kTaps = 2;
+    static inline void weights(uint32_t frac, float* w) {
+        float f = frac * kFracScale;
+        w[0] = 1.0f - f;
+        w[1] = f;
+    }
+};
+
+// 4-point, 3rd-order Hermite (Catmull-Rom)
+struct HermiteInterp {
+    static constexpr int kBefore = 1;
+    static constexpr int kTaps = 4;
+    static inline void weights(uint32_t frac, float* w) {
+        float t = frac * kFracScale;
+        float t2 = t * t;
+        float t3 = t2 * t;
+        w[0] = -0.5f * t3 + t2 - 0.5f * t;
+        w[1] = 1.5f * t3 - 2.5f * t2 + 1.0f;
+        w[2] = -1.5f * t3 + 2.0f * t2 + 0.5f * t;
+        w[3] = 0.5f * t3 - 0.5f * t2;
+    }
+};
+
+// 16-tap Kaiser-windowed sinc from a precomputed polyphase table, with linear
+// blending between adjacent phases. Tables exist for several cutoffs so
+// callers can band-limit when reading faster than 1x.
+class SincTable {
+public:
+    static constexpr int kTaps = 16;
+    static constexpr int kPhases = 256;
+    static constexpr int kCutoffs = 4;   // cutoff = 0.9 * Nyquist / 2^n
+
+    static const SincTable& instance();
+
+    // Row for a phase (kPhases + 1 rows so phase + 1 is always valid)
+    const float* row(int cutoff, int phase) const { return m_table[cutoff][phase]; }
+
+private:
+    SincTable();
+    alignas(32) float m_table[kCutoffs][kPhases + 1][kTaps];
+};
+
+template <int Cutoff = 0>
+struct SincInterp {
+    static constexpr int kBefore = SincTable::kTaps / 2 - 1;
+    static constexpr int kTaps = SincTable::kTaps;
+    static inline void weights(uint32_t frac, float* w) {
+        const SincTable& table = SincTable::instance();
+        int phase = (int)(frac >> 24);
+        float t = (frac & 0xFFFFFF) * (1.0f / 16777216.0f);
+        const float* a = table.row(Cutoff, phase);
+        const float* b = table.row(Cutoff, phase + 1);
+        for (int i = 0; i < kTaps; ++i) {
+            w[i] = a[i] + t * (b[i] - a[i]);
+        }
+    }
+};
+
+// Dot product of kTaps weights against samples spaced `stride` apart
+template <int Taps>
+inline float applyTaps(const float* p, ptrdiff_t stride, const float* w) {
+    float sum = 0.0f;
+    for (int i = 0; i < Taps; ++i) {
+        sum += w[i] * p[i * stride];
+    }
+    return sum;
+}
@@ -0,0 +1,78 @@
+#include "MasterClock.h"
+#include <cmath>
+#include <algorithm>
+
+static const double kSampleRate = 44100.0;
+static const double kDefaultTempo = 120.0;
+// Loop bandwidth (rad/s): fast enough to pull a deck in within about a
+// second, slow enough to ride over key-lock's hop-sized position jitter
+static const double kLockOmega = 3.0;
+
+MasterClock::MasterClock() : m_tempo(kDefaultTempo), m_publishedBpm(kDefaultTempo), m_publishedBeat(0.0),
+                             m_publishedFrame(0), m_bpm(kDefaultTempo), m_beat(0.0), m_frame(0) {
+}
+
+void MasterClock::setTempo(double bpm) {
+    m_tempo = std::max(20.0, std::min(300.0, bpm));
+}
+
+double MasterClock::getTempo() const {
+    return m_publishedBpm.load(std::memory_order_relaxed);
+}
+
+double MasterClock::getBeat() const {
+    return m_publishedBeat.load(std::memory_order_relaxed);
+}
+
+int64_t MasterClock::getFrame() const {
+    return m_publishedFrame.load(std::memory_order_relaxed);
+}
+
+int64_t MasterClock::frameAtBeat(double beat) const {
+    double frames = (beat - m_beat) * 60.0 * kSampleRate / m_bpm;
+    return m_frame + (int64_t)std::ceil(frames - 1e-6);
+}
+
+void MasterClock::advance(int frames) {
+    m_bpm = m_tempo.load(std::memory_order_relaxed);
+    m_beat += frames * m_bpm / (60.0 * kSampleRate);
+    m_frame += frames;
+    publish();
+}
+
+void MasterClock::follow(double bpm, double beat, int frames) {
+    m_bpm = bpm;
+    m_beat = beat;
+    m_frame += frames;
+    // Keep the leader's tempo if it stops, so the clock carries on from there
+    m_tempo.store(bpm, std::memory_order_relaxed);
+    publish();
+}
+
+void MasterClock::publish() {
+    m_publishedBpm.store(m_bpm, std::memory_order_relaxed);
+    m_publishedBeat.store(m_beat, std::memory_order_relaxed);
+    m_publishedFrame.store(m_frame, std::memory_order_relaxed);
+}
+
+PhaseLock::PhaseLock() : m_integral(0.0) {
+}
+
+void PhaseLock::reset() {
+    m_integral = 0.0;
+}
+
+double PhaseLock::update(double error, double beatsPerSecond, double seconds) {
+    if (beatsPerSecond <= 0.0) return 0.0;
+    // Phase error closes at correction * beatsPerSecond beats per second:
+    // proportional 2*omega (critical damping) plus integral omega^2
+    double proportional = 2.0 * kLockOmega * error;
+    double integral = m_integral + kLockOmega * kLockOmega * error * seconds;
+    double correction = (proportional + integral) / beatsPerSecond;
+    if (std::abs(correction) <= kMaxCorrection) {
+        m_integral = integral;   // no windup while clamped
+    } else {
+        correction = correction > 0.0 ? kMaxCorrection : -kMaxCorrection;
+    }
+    return correction;
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// Engine-wide beat clock that synced decks lock to. It free-runs at the set
+// tempo, or follows a leader deck's tempo and beat while that deck plays.
+// It also counts engine frames, the timeline scheduled actions use. Only
+// the audio thread moves it; the tempo can be set from anywhere.
+class MasterClock {
+public:
+    MasterClock();
+
+    // Any thread
+    void setTempo(double bpm);
+    double getTempo() const;     // tempo the clock is running at
+    double getBeat() const;      // published beat position
+    int64_t getFrame() const;    // engine frame the next block starts at
+
+    // Audio thread, once per block after the decks have rendered: move to
+    // the start of the next block, either free-running or following a leader
+    // whose beat has just been read at that point
+    void advance(int frames);
+    void follow(double bpm, double beat, int frames);
+
+    // Audio thread: beat position and frame at the start of the current block
+    double beat() const { return m_beat; }
+    double bpm() const { return m_bpm; }
+    int64_t frame() const { return m_frame; }
+    // First frame at or after `beat`, assuming the current tempo holds
+    int64_t frameAtBeat(double beat) const;
+
+private:
+    void publish();
+
+    std::atomic<double> m_tempo;
+    std::atomic<double> m_publishedBpm;
+    std::atomic<double> m_publishedBeat;
+    std::atomic<int64_t> m_publishedFrame;
+    double m_bpm;
+    double m_beat;
+    int64_t m_frame;
+};
+
+// Phase-locked loop for one deck: a PI controller on the beat-phase error
+// (in beats) that returns a fractional rate correction. Tuned critically
+// damped, so a deck settles onto the clock in about a second without
+// overshooting, and clamped so corrections stay a small pitch bend.
+class PhaseLock {
+public:
+    static constexpr double kMaxCorrection = 0.03;
+
+    PhaseLock();
+    void reset();
+    // error: clock beat minus deck beat, wrapped to [-0.5, 0.5); beatsPerSecond
+    // of the clock; seconds of audio since the last update
+    double update(double error, double beatsPerSecond, double seconds);
+
+private:
+    double m_integral;
+};
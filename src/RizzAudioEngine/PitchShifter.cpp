@@ -0,0 +1,34 @@
+#include "PitchShifter.h"
+
+PitchShifter::PitchShifter() : m_bufferCount(0), m_readPos(HermiteInterp::kBefore) {
+    for (int ch = 0; ch < 2; ++ch) {
+        m_buffer[ch].assign(kBufferCapacity, 0.0f);
+    }
+    m_sourceLeft.assign(kSourceChunk, 0.0f);
+    m_sourceRight.assign(kSourceChunk, 0.0f);
+    reset();
+}
+
+void PitchShifter::setMode(TimeStretcher::Mode mode) {
+    m_stretcher.setMode(mode);
+    reset();
+}
+
+void PitchShifter::reset() {
+    m_stretcher.reset();
+    // Start with one silent sample of kernel history so the first output
+    // frame lands exactly on the first stretched sample
+    for (int ch = 0; ch < 2; ++ch) {
+        std::fill(m_buffer[ch].begin(), m_buffer[ch].begin() + HermiteInterp::kBefore, 0.0f);
+    }
+    m_bufferCount = HermiteInterp::kBefore;
+    m_readPos = HermiteInterp::kBefore;
+}
+
+double PitchShifter::readAheadFrames(double tempo, double pitch) const {
+    // Stretcher read-ahead plus the resampler kernel's look-ahead, which is
+    // counted in stretched frames worth tempo / pitch source frames each
+    double stretchRatio = tempo / pitch;
+    int lookAhead = HermiteInterp::kTaps - HermiteInterp::kBefore - 1;
+    return m_stretcher.readAheadFrames(stretchRatio) + lookAhead * stretchRatio;
+}
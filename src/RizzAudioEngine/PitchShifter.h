@@ -0,0 +1,110 @@
+#pragma once
+
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include "TimeStretcher.h"
+#include "Interpolator.h"
+
+// Independent tempo and pitch for a deck: time-stretch the source by
+// tempo / pitch, then resample the stretched stream by `pitch`. With
+// pitch == 1 the resampler reads whole samples, so key-lock alone costs
+// nothing extra.
+class PitchShifter {
+public:
+    PitchShifter();
+
+    void setMode(TimeStretcher::Mode mode);  // also resets
+    TimeStretcher::Mode getMode() const { return m_stretcher.getMode(); }
+    void reset();
+
+    // Source frames read ahead of what is audible, for position reporting
+    double readAheadFrames(double tempo, double pitch) const;
+
+    // Right after a reset: source frames to back up by, then preroll() to
+    // run them through the stretcher and drop the result, so render()
+    // starts at full level from the original point
+    int prerollFrames(double tempo, double pitch) const { return m_stretcher.prerollFrames(tempo / pitch); }
+    template <class ReadSource>
+    void preroll(double tempo, double pitch, ReadSource&& readSource);
+
+    // Render `frames` of output. readSource(left, right, n) must supply the
+    // next n source frames (already in playback direction).
+    template <class ReadSource>
+    void render(float* left, float* right, int frames, double tempo, double pitch, ReadSource&& readSource);
+
+private:
+    static constexpr int kBufferCapacity = 8192;
+    static constexpr int kSourceChunk = 1024;
+
+    TimeStretcher m_stretcher;
+
+    // Stretched audio awaiting resampling; m_readPos indexes it (>= 1 so the
+    // Hermite kernel always has one sample of history)
+    std::vector<float> m_buffer[2];
+    int m_bufferCount;
+    double m_readPos;
+
+    std::vector<float> m_sourceLeft, m_sourceRight;
+};
+
+template <class ReadSource>
+void PitchShifter::preroll(double tempo, double pitch, ReadSource&& readSource) {
+    const double stretchRatio = tempo / pitch;
+    for (int hop = 0; hop < m_stretcher.prerollHops(); ++hop) {
+        for (int need = m_stretcher.inputNeeded(); need > 0; ) {
+            int n = std::min(need, kSourceChunk);
+            readSource(m_sourceLeft.data(), m_sourceRight.data(), n);
+            m_stretcher.feed(m_sourceLeft.data(), m_sourceRight.data(), n);
+            need -= n;
+        }
+        m_stretcher.synthesize(stretchRatio);
+        while (m_stretcher.available() > 0) {
+            m_stretcher.read(m_sourceLeft.data(), m_sourceRight.data(), std::min(m_stretcher.available(), kSourceChunk));
+        }
+    }
+}
+
+template <class ReadSource>
+void PitchShifter::render(float* left, float* right, int frames, double tempo, double pitch, ReadSource&& readSource) {
+    const double stretchRatio = tempo / pitch;
+    const int needed = std::min(kBufferCapacity, (int)std::floor(m_readPos + (frames - 1) * pitch) + HermiteInterp::kTaps - HermiteInterp::kBefore);
+
+    while (m_bufferCount < needed) {
+        while (m_stretcher.available() == 0) {
+            int need = m_stretcher.inputNeeded();
+            while (need > 0) {
+                int n = std::min(need, kSourceChunk);
+                readSource(m_sourceLeft.data(), m_sourceRight.data(), n);
+                m_stretcher.feed(m_sourceLeft.data(), m_sourceRight.data(), n);
+                need -= n;
+            }
+            m_stretcher.synthesize(stretchRatio);
+        }
+        int n = std::min(m_stretcher.available(), kBufferCapacity - m_bufferCount);
+        if (n <= 0) break;
+        m_stretcher.read(m_buffer[0].data() + m_bufferCount, m_buffer[1].data() + m_bufferCount, n);
+        m_bufferCount += n;
+    }
+
+    float w[HermiteInterp::kTaps];
+    const float* bl = m_buffer[0].data();
+    const float* br = m_buffer[1].data();
+    double pos = m_readPos;
+    for (int i = 0; i < frames; ++i) {
+        int idx = (int)pos;
+        HermiteInterp::weights((uint32_t)((pos - idx) * 4294967296.0), w);
+        int base = std::min(idx - HermiteInterp::kBefore, m_bufferCount - HermiteInterp::kTaps);
+        left[i] = applyTaps<HermiteInterp::kTaps>(bl + base, 1, w);
+        right[i] = applyTaps<HermiteInterp::kTaps>(br + base, 1, w);
+        pos += pitch;
+    }
+
+    // Drop everything older than the kernel's history
+    int consumed = std::max(0, std::min((int)pos - HermiteInterp::kBefore, m_bufferCount));
+    for (int ch = 0; ch < 2; ++ch) {
+        std::copy(m_buffer[ch].begin() + consumed, m_buffer[ch].begin() + m_bufferCount, m_buffer[ch].begin());
+    }
+    m_bufferCount -= consumed;
+    m_readPos = pos - consumed;
+}
@@ -0,0 +1,160 @@
+#include "Platter.h"
+#include <cmath>
+#include <algorithm>
+
+static const double kSampleRate = 44100.0;
+// Hand velocity smoothing (~4 ms) hides the jitter of 1 kHz jog reports
+static const double kHandSmoothing = 1.0 - std::exp(-1.0 / (0.004 * kSampleRate));
+// A touched platter with no jog report for this long is being held still
+static const int kJogTimeoutFrames = (int)(0.02 * kSampleRate);
+// Position lock: how hard the platter is pulled onto the hand's position
+// (per second of error), so velocity estimates can't drift over a scratch
+static const double kPositionLock = 20.0;
+static const double kDefaultInertiaSeconds = 0.3;
+
+static double clampVelocity(double v) {
+    return std::max(-Platter::kMaxVelocity, std::min(Platter::kMaxVelocity, v));
+}
+
+Platter::Platter() : m_pending(), m_hasPending(false), m_lastBlockNs(0), m_active(false), m_touched(false),
+                     m_braking(false), m_stopped(false), m_velocity(0.0), m_handVelocity(0.0), m_framesSinceJog(0),
+                     m_motorAccel(1.0 / (kDefaultInertiaSeconds * kSampleRate)), m_brakeAccel(0.0),
+                     m_haveJogPosition(false), m_jogPosition(0.0), m_jogTimeNs(0), m_jogOrigin(0.0),
+                     m_handTravel(0.0), m_platterTravel(0.0) {
+}
+
+bool Platter::post(const JogEvent& event) {
+    return m_queue.push(event);
+}
+
+bool Platter::takeStopped() {
+    bool stopped = m_stopped;
+    m_stopped = false;
+    return stopped;
+}
+
+void Platter::settle() {
+    if (m_touched || m_braking) return;
+    m_active = false;
+}
+
+bool Platter::process(double motor, double startVelocity, int frames, int64_t nowNs, double* velocity) {
+    if (!m_active && !m_hasPending) {
+        if (!m_queue.pop(m_pending)) {
+            m_lastBlockNs = nowNs;
+            return false;
+        }
+        m_hasPending = true;
+    }
+    if (!m_active) {
+        m_active = true;
+        m_velocity = startVelocity;
+    }
+
+    // This block covers controller time [previous block, now)
+    int64_t start = m_lastBlockNs;
+    if (start <= 0 || start >= nowNs) start = nowNs - (int64_t)(frames * 1e9 / kSampleRate);
+    const double framesPerNs = frames / (double)(nowNs - start);
+
+    int i = 0;
+    for (;;) {
+        if (!m_hasPending) m_hasPending = m_queue.pop(m_pending);
+        // Events stamped after `now` belong to the next block
+        int offset = frames;
+        if (m_hasPending && m_pending.timeNs < nowNs) {
+            offset = (int)std::max(0.0, std::min((double)(frames - 1), (m_pending.timeNs - start) * framesPerNs));
+        }
+        for (; i < offset; ++i) {
+            velocity[i] = step(motor);
+        }
+        if (offset >= frames) break;
+        apply(m_pending);
+        m_hasPending = false;
+    }
+    m_lastBlockNs = nowNs;
+
+    if (!m_touched && !m_braking && m_velocity == motor && !m_hasPending) m_active = false;
+    return true;
+}
+
+double Platter::step(double motor) {
+    if (m_touched) {
+        if (++m_framesSinceJog > kJogTimeoutFrames) m_handVelocity = 0.0;
+        double target = m_handVelocity;
+        if (m_haveJogPosition) {
+            // Where the hand should be by now, extrapolated from the last report
+            double hand = m_handTravel + m_handVelocity * (m_framesSinceJog / kSampleRate);
+            target = clampVelocity(target + kPositionLock * (hand - m_platterTravel));
+        }
+        m_velocity += kHandSmoothing * (target - m_velocity);
+        m_platterTravel += m_velocity / kSampleRate;
+        return m_velocity;
+    }
+
+    // Untouched: the motor (or the brake) pulls the platter with limited torque
+    double target = m_braking ? 0.0 : motor;
+    double accel = m_braking ? m_brakeAccel : m_motorAccel;
+    double diff = target - m_velocity;
+    if (std::abs(diff) <= accel) m_velocity = target;
+    else m_velocity += diff > 0.0 ? accel : -accel;
+    if (m_braking && m_velocity == 0.0) {
+        m_braking = false;
+        m_stopped = true;
+    }
+    return m_velocity;
+}
+
+void Platter::apply(const JogEvent& event) {
+    switch (event.type) {
+    case JogEvent::TOUCH:
+        // A hand on the record holds it until it moves
+        m_touched = true;
+        m_braking = false;
+        m_handVelocity = 0.0;
+        m_framesSinceJog = 0;
+        m_haveJogPosition = false;
+        break;
+    case JogEvent::RELEASE:
+        m_touched = false;
+        break;
+    case JogEvent::POSITION: {
+        if (!m_touched) break;
+        if (!m_haveJogPosition) {
+            // First report after touch: the record is where the hand is
+            m_jogOrigin = event.value;
+            m_platterTravel = 0.0;
+        } else {
+            double dt = (event.timeNs - m_jogTimeNs) * 1e-9;
+            if (dt < 0.0002) break; // same report twice; wait for a usable interval
+            m_handVelocity = dt < 0.1 ? clampVelocity((event.value - m_jogPosition) / dt) : 0.0;
+        }
+        m_handTravel = event.value - m_jogOrigin;
+        m_framesSinceJog = 0;
+        m_jogPosition = event.value;
+        m_jogTimeNs = event.timeNs;
+        m_haveJogPosition = true;
+        break;
+    }
+    case JogEvent::VELOCITY:
+        // Velocity-only controllers get no position lock
+        if (!m_touched) break;
+        m_handVelocity = clampVelocity(event.value);
+        m_haveJogPosition = false;
+        m_framesSinceJog = 0;
+        break;
+    case JogEvent::BRAKE:
+        m_touched = false;
+        m_braking = true;
+        m_brakeAccel = std::max(std::abs(m_velocity), 1e-3) / (std::max(event.value, 0.01) * kSampleRate);
+        break;
+    case JogEvent::SPINBACK:
+        m_touched = false;
+        m_braking = true;
+        m_velocity = -clampVelocity(std::abs(event.value));
+        m_brakeAccel = std::abs(m_velocity) / (std::max(event.duration, 0.01) * kSampleRate);
+        break;
+    case JogEvent::INERTIA:
+        m_motorAccel = event.value > 0.0 ? 1.0 / (event.value * kSampleRate) : kMaxVelocity * 2.0;
+        break;
+    }
+}
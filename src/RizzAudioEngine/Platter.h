@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstdint>
+#include "CommandQueue.h"
+
+// One message from the jog wheel or transport, stamped with the
+// steady_clock time it was read so the audio thread can place it on the
+// right frame.
+struct JogEvent {
+    enum Type { TOUCH, RELEASE, POSITION, VELOCITY, BRAKE, SPINBACK, INERTIA };
+    Type type;
+    double value;     // POSITION: seconds of audio; VELOCITY, SPINBACK: rate; BRAKE, INERTIA: seconds
+    double duration;  // SPINBACK: seconds until the platter stops
+    int64_t timeNs;
+};
+
+// Turntable model for scratching. While touched, the platter follows the
+// hand: velocity estimated from jog position (or given directly), smoothed
+// over a few ms, plus a weak position lock so the record ends up exactly
+// where the hand put it. Once released it spins back to motor speed at a limited
+// acceleration (inertia). Brake and spinback run the platter down to a stop.
+//
+// Jog events arrive through a lock-free queue at up to ~1 kHz. The audio
+// thread renders one block behind the controller clock, so every event is
+// applied on the frame matching its timestamp and the velocity is produced
+// per frame.
+class Platter {
+public:
+    static constexpr double kMaxVelocity = 8.0;
+
+    Platter();
+
+    // Any thread; false if the queue is full
+    bool post(const JogEvent& event);
+
+    // Audio thread. Returns false, doing nothing else, while the platter just
+    // follows the motor and no event is waiting; otherwise fills one velocity
+    // per frame. `motor` is the rate the deck would play at untouched and
+    // `startVelocity` the rate it is playing at now.
+    bool process(double motor, double startVelocity, int frames, int64_t nowNs, double* velocity);
+
+    // True once after a brake or spinback has brought the platter to rest
+    bool takeStopped();
+
+    // Audio thread: touched, braking or spinning back
+    bool held() const { return m_touched || m_braking; }
+
+    // Audio thread: skip the spin back up to motor speed (slip return)
+    void settle();
+
+private:
+    void apply(const JogEvent& event);
+    double step(double motor);
+
+    CommandQueue<JogEvent, 1024> m_queue;
+    JogEvent m_pending;
+    bool m_hasPending;
+    int64_t m_lastBlockNs;
+
+    bool m_active;
+    bool m_touched;
+    bool m_braking;
+    bool m_stopped;
+    double m_velocity;
+    double m_handVelocity;
+    int m_framesSinceJog;
+    double m_motorAccel;   // per-frame rate change when spinning back up
+    double m_brakeAccel;
+
+    // Hand and platter travel since the first position report of a touch
+    bool m_haveJogPosition;
+    double m_jogPosition;
+    int64_t m_jogTimeNs;
+    double m_jogOrigin;
+    double m_handTravel;
+    double m_platterTravel;
+};
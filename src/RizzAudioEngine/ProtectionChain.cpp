@@ -0,0 +1,279 @@
+#include "ProtectionChain.h"
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+
+// ============================================================================
+// Stages
+// ============================================================================
+
+void SoftKneeCompressor::process(StereoSpan block) {
+    const float threshold = m_settings.threshold.load(std::memory_order_relaxed) * 0.8f;   // before hard limiting
+    const float knee = 0.1f;
+    const float ratio = m_settings.compressorRatio.load(std::memory_order_relaxed);
+    float* channels[2] = {block.left, block.right};
+    for (float* x : channels) {
+        // Every branch is computed and the right one selected, so the loop
+        // vectorises; lanes below the threshold pass through untouched
+        for (int i = 0; i < block.frames; ++i) {
+            float magnitude = std::abs(x[i]);
+            float excess = magnitude - threshold;
+            float kneeRatio = 1.0f + (ratio - 1.0f) * (excess / knee);
+            float compressed = threshold + excess / (magnitude < threshold + knee ? kneeRatio : ratio);
+            x[i] = magnitude < threshold ? x[i] : std::copysign(compressed, x[i]);
+        }
+    }
+}
+
+LookAheadLimiter::LookAheadLimiter(const ProtectionSettings& settings)
+    : m_settings(settings), m_peakHead(0), m_peakTail(0), m_frame(0), m_running(false), m_truePeak(false),
+      m_length(0), m_delay(0), m_fadeFrom(0), m_fadeRemaining(0), m_gainSum(0.0), m_gain(1.0f),
+      m_releaseCoeff(0.0f), m_releaseTimeUsed(-1.0f) {
+    std::fill(m_left, m_left + kMaxLookAhead, 0.0f);
+    std::fill(m_right, m_right + kMaxLookAhead, 0.0f);
+    std::fill(m_gains, m_gains + kMaxLookAhead, 1.0f);
+}
+
+int LookAheadLimiter::lookAheadLength() const {
+    // The look-ahead is the attack time: the gain reaches its target over
+    // exactly the frames before the peak is heard
+    int length = (int)std::lround(m_settings.attackTime.load(std::memory_order_relaxed) * 44100.0f);
+    return std::max(1, std::min(kMaxLookAhead - 1 - TruePeakDetector::kDelay, length));
+}
+
+int LookAheadLimiter::latency(bool truePeak) const {
+    return lookAheadLength() + (truePeak ? TruePeakDetector::kDelay : 0);
+}
+
+// Switched on: the gain history starts clean, the audio history stays
+void LookAheadLimiter::start() {
+    std::fill(m_gains, m_gains + kMaxLookAhead, 1.0f);
+    m_peakHead = m_peakTail = 0;
+    m_gain = 1.0f;
+    m_truePeakDetector.reset();
+    m_length = 0;
+    m_running = true;
+}
+
+// New look-ahead window over the gains already recorded
+void LookAheadLimiter::resize(int length) {
+    m_gainSum = 0.0;
+    for (int k = 1; k <= length; ++k) {
+        m_gainSum += m_gains[(m_frame - k) & (kMaxLookAhead - 1)];
+    }
+    m_length = length;
+}
+
+// Move the read tap; a move during a fade waits for the fade to finish
+void LookAheadLimiter::retap(int delay) {
+    if (delay == m_delay || m_fadeRemaining > 0) return;
+    m_fadeFrom = m_delay;
+    m_delay = delay;
+    m_fadeRemaining = kTapFade;
+}
+
+inline void LookAheadLimiter::tap(unsigned frame, float& left, float& right, float gain, float targetGain) {
+    const unsigned mask = kMaxLookAhead - 1;
+    unsigned slot = frame & mask;
+    m_left[slot] = left;
+    m_right[slot] = right;
+    unsigned delayed = (frame - m_delay) & mask;
+    if (m_fadeRemaining == 0) {
+        left = m_left[delayed] * targetGain;
+        right = m_right[delayed] * targetGain;
+        return;
+    }
+    float t = (float)(kTapFade - m_fadeRemaining + 1) / (kTapFade + 1);
+    unsigned from = (frame - m_fadeFrom) & mask;
+    left = m_left[from] * gain * (1.0f - t) + m_left[delayed] * targetGain * t;
+    right = m_right[from] * gain * (1.0f - t) + m_right[delayed] * targetGain * t;
+    --m_fadeRemaining;
+}
+
+void LookAheadLimiter::idle(StereoSpan block) {
+    if (m_running) {
+        m_running = false;
+        m_fadeRemaining = 0;   // fade straight out of whatever tap is playing
+        retap(0);
+    }
+    for (int i = 0; i < block.frames; ++i) {
+        if (m_fadeRemaining == 0) m_gain = 1.0f;
+        tap(m_frame++, block.left[i], block.right[i], m_gain, 1.0f);
+    }
+}
+
+template <bool TruePeak>
+void LookAheadLimiter::process(StereoSpan block) {
+    const unsigned mask = kMaxLookAhead - 1;
+    if (!m_running) start();
+    if (TruePeak != m_truePeak) {
+        m_truePeak = TruePeak;
+        m_truePeakDetector.reset();
+    }
+    const int length = lookAheadLength();
+    if (length != m_length) resize(length);
+    retap(latency(TruePeak));
+    float releaseTime = m_settings.releaseTime.load(std::memory_order_relaxed);
+    if (releaseTime != m_releaseTimeUsed) {
+        m_releaseTimeUsed = releaseTime;
+        m_releaseCoeff = 1.0f - std::exp(-1.0f / (std::max(0.001f, releaseTime) * 44100.0f));
+    }
+    const float threshold = m_settings.threshold.load(std::memory_order_relaxed);
+
+    for (int i = 0; i < block.frames; ++i) {
+        float left = block.left[i];
+        float right = block.right[i];
+        unsigned frame = m_frame++;
+
+        // Loudest input over the last length + 1 frames, so every gain
+        // averaged below for the frame leaving the delay line has already
+        // seen its peak. True peaks arrive kDelay frames late, and the audio
+        // is delayed to match.
+        float peak = TruePeak ? m_truePeakDetector.process(left, right) : std::max(std::abs(left), std::abs(right));
+        while (m_peakTail != m_peakHead && m_peakValues[(m_peakTail - 1) & mask] <= peak) {
+            --m_peakTail;
+        }
+        m_peakFrames[m_peakTail & mask] = frame;
+        m_peakValues[m_peakTail & mask] = peak;
+        ++m_peakTail;
+        while (frame - m_peakFrames[m_peakHead & mask] > (unsigned)length) {
+            ++m_peakHead;
+        }
+        float maxPeak = m_peakValues[m_peakHead & mask];
+        float target = maxPeak > threshold ? threshold / maxPeak : 1.0f;
+
+        // Averaging the windowed gains over the look-ahead gives a smooth
+        // attack that lands on the target as the peak comes out. The sum is
+        // rebuilt once per ring so rounding can't drift.
+        unsigned slot = frame & mask;
+        unsigned oldest = (frame - length) & mask;
+        m_gainSum += target - m_gains[oldest];
+        m_gains[slot] = target;
+        if (slot == 0) {
+            m_gainSum = 0.0;
+            for (int k = 0; k < length; ++k) {
+                m_gainSum += m_gains[(frame - k) & mask];
+            }
+        }
+        float gain = (float)(m_gainSum / length);
+        if (gain < m_gain) {
+            m_gain = gain;
+        } else {
+            m_gain += (gain - m_gain) * m_releaseCoeff;
+        }
+
+        tap(frame, left, right, m_gain, m_gain);
+        block.left[i] = left;
+        block.right[i] = right;
+    }
+}
+
+template void LookAheadLimiter::process<false>(StereoSpan block);
+template void LookAheadLimiter::process<true>(StereoSpan block);
+
+void BrickwallLimiter::process(StereoSpan block) {
+    const float threshold = m_settings.threshold.load(std::memory_order_relaxed);
+    for (int i = 0; i < block.frames; ++i) {
+        block.left[i] = std::max(-threshold, std::min(threshold, block.left[i]));
+        block.right[i] = std::max(-threshold, std::min(threshold, block.right[i]));
+    }
+}
+
+void PeakMeter::process(StereoSpan block) {
+    float level = m_level.load(std::memory_order_relaxed);
+    for (int i = 0; i < block.frames; ++i) {
+        float peak = std::max(std::abs(block.left[i]), std::abs(block.right[i]));
+        level = std::max(level * 0.99f, peak);   // slow decay
+    }
+    m_level.store(level, std::memory_order_relaxed);
+}
+
+void ClipIndicator::process(StereoSpan block) {
+    const float threshold = m_settings.threshold.load(std::memory_order_relaxed);
+    bool clipping = m_clipping.load(std::memory_order_relaxed);
+    bool started = false;
+    for (int i = 0; i < block.frames; ++i) {
+        bool now = std::abs(block.left[i]) >= threshold || std::abs(block.right[i]) >= threshold;
+        started |= now && !clipping;
+        clipping = now;
+    }
+    m_clipping.store(clipping, std::memory_order_relaxed);
+
+    // Log clipping events (following SOP: critical events to console)
+    if (started) {
+        std::cout << "[ClubMixer] CLIPPING DETECTED - Output exceeded " << threshold << std::endl;
+    }
+}
+
+void AutoGain::process(StereoSpan block) {
+    const float threshold = m_settings.threshold.load(std::memory_order_relaxed);
+    float gain = m_gain;
+    for (int i = 0; i < block.frames; ++i) {
+        bool clipping = std::abs(block.left[i]) >= threshold || std::abs(block.right[i]) >= threshold;
+        // Down 0.1% per clipped sample to -20 dB, back up 0.1% per clean one
+        gain = clipping ? std::max(0.1f, gain * 0.999f) : std::min(1.0f, gain * 1.001f);
+        block.left[i] *= gain;
+        block.right[i] *= gain;
+    }
+    m_gain = gain;
+}
+
+// ============================================================================
+// ProtectionChain
+// ============================================================================
+
+ProtectionChain::ProtectionChain()
+    : m_softKnee(m_settings), m_lookAhead(m_settings), m_brickwall(m_settings), m_clipIndicator(m_settings),
+      m_autoGain(m_settings), m_flags(PROTECTION | SOFT_KNEE | BRICKWALL | PEAK_METER) {
+    m_active.store(chainFor(m_flags.load()));
+}
+
+template <unsigned Stages>
+void ProtectionChain::run(ProtectionChain& chain, StereoSpan block) {
+    if constexpr ((Stages & SOFT_KNEE) != 0) chain.m_softKnee.process(block);
+    if constexpr ((Stages & TRUE_PEAK) != 0) {
+        chain.m_lookAhead.process<true>(block);
+    } else if constexpr ((Stages & LOOK_AHEAD) != 0) {
+        chain.m_lookAhead.process<false>(block);
+    } else {
+        chain.m_lookAhead.idle(block);
+    }
+    if constexpr ((Stages & BRICKWALL) != 0) chain.m_brickwall.process(block);
+    if constexpr ((Stages & PEAK_METER) != 0) chain.m_peakMeter.process(block);
+    if constexpr ((Stages & CLIP_INDICATOR) != 0) chain.m_clipIndicator.process(block);
+    if constexpr ((Stages & AUTO_GAIN) != 0) chain.m_autoGain.process(block);
+}
+
+template <unsigned... Sets>
+std::array<ProtectionChain::ChainFn, sizeof...(Sets)> ProtectionChain::makeChains(std::integer_sequence<unsigned, Sets...>) {
+    return {{&ProtectionChain::run<Sets>...}};
+}
+
+ProtectionChain::ChainFn ProtectionChain::chainFor(unsigned flags) {
+    // One chain per stage set, all compiled in; never first reached from
+    // the audio thread
+    static const auto chains = makeChains(std::make_integer_sequence<unsigned, 1u << kStageBits>());
+    return (flags & PROTECTION) ? chains[flags & ((1u << kStageBits) - 1)] : chains[0];
+}
+
+void ProtectionChain::setEnabled(unsigned stage, bool enabled) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    unsigned flags = m_flags.load(std::memory_order_relaxed);
+    flags = enabled ? (flags | stage) : (flags & ~stage);
+    m_flags.store(flags, std::memory_order_relaxed);
+    m_active.store(chainFor(flags), std::memory_order_release);
+}
+
+bool ProtectionChain::isEnabled(unsigned stage) const {
+    return (m_flags.load(std::memory_order_relaxed) & stage) != 0;
+}
+
+int ProtectionChain::latency() const {
+    unsigned flags = m_flags.load(std::memory_order_relaxed);
+    if (!(flags & PROTECTION) || !(flags & (LOOK_AHEAD | TRUE_PEAK))) return 0;
+    return m_lookAhead.latency((flags & TRUE_PEAK) != 0);
+}
+
+void ProtectionChain::process(StereoSpan block) {
+    m_active.load(std::memory_order_acquire)(*this, block);
+}
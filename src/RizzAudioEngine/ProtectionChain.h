@@ -0,0 +1,189 @@
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <array>
+#include <utility>
+#include "TruePeak.h"
+
+// A stereo block, processed in place
+struct StereoSpan {
+    float* left;
+    float* right;
+    int frames;
+};
+
+// Protection settings: written from any thread, read by the stages once
+// per block
+struct ProtectionSettings {
+    std::atomic<float> threshold{0.9f};
+    std::atomic<float> compressorRatio{2.0f};
+    std::atomic<float> attackTime{0.001f};    // seconds, also the look-ahead
+    std::atomic<float> releaseTime{0.1f};     // seconds
+};
+
+// Compresses above 80% of the threshold, with a soft knee 0.1 wide
+class SoftKneeCompressor {
+public:
+    explicit SoftKneeCompressor(const ProtectionSettings& settings) : m_settings(settings) {}
+    void process(StereoSpan block);
+
+private:
+    const ProtectionSettings& m_settings;
+};
+
+// Look-ahead limiter. The output is delayed by the attack time (plus the
+// detector's delay on true peaks) so the gain has ramped down by the time a
+// peak leaves the delay line. Peaks go through a monotonic deque for an
+// O(1) sliding maximum; the gains it gives are box-filtered over the same
+// window. The delay line always holds the latest input and is never
+// cleared: a new delay moves the read tap with a short crossfade, and
+// switching the limiter on or off crossfades to or from the dry input.
+class LookAheadLimiter {
+public:
+    explicit LookAheadLimiter(const ProtectionSettings& settings);
+
+    // Limit on sample peaks, or on 4x-oversampled (true) peaks
+    template <bool TruePeak>
+    void process(StereoSpan block);
+    // Not in the chain: pass the block through (after fading out of the
+    // limited signal if it was just switched off), keeping the delay line fed
+    void idle(StereoSpan block);
+    // Frames the output is delayed by in the given mode
+    int latency(bool truePeak) const;
+
+    static constexpr int kMaxLookAhead = 2048;   // ring size, power of two
+    static constexpr int kMaxLatency = kMaxLookAhead - 1;
+
+private:
+    static constexpr int kTapFade = 128;         // frames to move the read tap
+
+    int lookAheadLength() const;
+    void start();
+    void resize(int length);
+    void retap(int delay);
+    // Write a frame into the delay line and read the (crossfading) tap
+    inline void tap(unsigned frame, float& left, float& right, float gain, float targetGain);
+
+    const ProtectionSettings& m_settings;
+    float m_left[kMaxLookAhead];
+    float m_right[kMaxLookAhead];
+    float m_gains[kMaxLookAhead];
+    unsigned m_peakFrames[kMaxLookAhead];
+    float m_peakValues[kMaxLookAhead];
+    unsigned m_peakHead;
+    unsigned m_peakTail;
+    unsigned m_frame;
+    bool m_running;
+    bool m_truePeak;
+    int m_length;
+    int m_delay;          // 0 reads the dry input
+    int m_fadeFrom;       // the tap being faded out of
+    int m_fadeRemaining;
+    TruePeakDetector m_truePeakDetector;
+    double m_gainSum;
+    float m_gain;
+    float m_releaseCoeff;
+    float m_releaseTimeUsed;
+};
+
+// Clips at the threshold; the last line of defence
+class BrickwallLimiter {
+public:
+    explicit BrickwallLimiter(const ProtectionSettings& settings) : m_settings(settings) {}
+    void process(StereoSpan block);
+
+private:
+    const ProtectionSettings& m_settings;
+};
+
+// Sample peak with a slow per-sample decay
+class PeakMeter {
+public:
+    PeakMeter() : m_level(0.0f) {}
+    void process(StereoSpan block);
+    float level() const { return m_level.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<float> m_level;
+};
+
+// Whether the last sample reached the threshold; logs each new clip
+class ClipIndicator {
+public:
+    explicit ClipIndicator(const ProtectionSettings& settings) : m_settings(settings), m_clipping(false) {}
+    void process(StereoSpan block);
+    bool isClipping() const { return m_clipping.load(std::memory_order_relaxed); }
+
+private:
+    const ProtectionSettings& m_settings;
+    std::atomic<bool> m_clipping;
+};
+
+// Rides the gain down slowly while the output sits at the threshold and
+// back up once it doesn't
+class AutoGain {
+public:
+    explicit AutoGain(const ProtectionSettings& settings) : m_settings(settings), m_gain(1.0f) {}
+    void process(StereoSpan block);
+
+private:
+    const ProtectionSettings& m_settings;
+    float m_gain;
+};
+
+// The master protection chain. Each set of enabled stages has its own chain
+// compiled for it, so the audio thread runs straight-line block loops with
+// no per-sample flag tests. Turning a stage on or off swaps the chain used
+// for the next block; the stages keep their state across swaps.
+class ProtectionChain {
+public:
+    enum Stage : unsigned {
+        SOFT_KNEE = 1u << 0,
+        LOOK_AHEAD = 1u << 1,
+        TRUE_PEAK = 1u << 2,        // look-ahead on true peaks; implies LOOK_AHEAD
+        BRICKWALL = 1u << 3,
+        PEAK_METER = 1u << 4,
+        CLIP_INDICATOR = 1u << 5,
+        AUTO_GAIN = 1u << 6,
+        kStageBits = 7,
+        PROTECTION = 1u << 7,       // master switch; off runs an empty chain
+    };
+
+    ProtectionChain();
+
+    // Any thread
+    void setEnabled(unsigned stage, bool enabled);
+    bool isEnabled(unsigned stage) const;
+    ProtectionSettings& settings() { return m_settings; }
+    float peakLevel() const { return m_peakMeter.level(); }
+    bool isClipping() const { return m_clipIndicator.isClipping(); }
+    // Frames the look-ahead limiter delays the output by, 0 when it is off;
+    // never more than kMaxLatency
+    int latency() const;
+    static constexpr int kMaxLatency = LookAheadLimiter::kMaxLatency;
+
+    // Audio thread
+    void process(StereoSpan block);
+
+private:
+    using ChainFn = void (*)(ProtectionChain&, StereoSpan);
+
+    template <unsigned Stages>
+    static void run(ProtectionChain& chain, StereoSpan block);
+    template <unsigned... Sets>
+    static std::array<ChainFn, sizeof...(Sets)> makeChains(std::integer_sequence<unsigned, Sets...>);
+    static ChainFn chainFor(unsigned flags);
+
+    ProtectionSettings m_settings;
+    SoftKneeCompressor m_softKnee;
+    LookAheadLimiter m_lookAhead;
+    BrickwallLimiter m_brickwall;
+    PeakMeter m_peakMeter;
+    ClipIndicator m_clipIndicator;
+    AutoGain m_autoGain;
+
+    std::mutex m_mutex;                // serialises setEnabled
+    std::atomic<unsigned> m_flags;
+    std::atomic<ChainFn> m_active;
+};
@@ -0,0 +1,304 @@
+#include "Sampler.h"
+#include "Interpolator.h"
+#include <iostream>
+#include <cmath>
+#include <algorithm>
+#include <thread>
+#include <chrono>
+
+// Stopped, stolen and replaced voices fade out over this many frames (~1.5 ms)
+static const int kReleaseFrames = 64;
+
+Sampler::Sampler(int slots)
+    : m_slotCount(std::max(kMinSlots, std::min(kMaxSlots, slots))), m_triggerCount(0), m_volume(1.0f),
+      m_activeVoices(0), m_stolenVoices(0) {
+    for (Voice& voice : m_voices) {
+        voice.play.sample = nullptr;
+        voice.tail.sample = nullptr;
+        voice.started = 0;
+    }
+    for (int i = 0; i < kMaxSlots; ++i) {
+        m_active[i].store(nullptr, std::memory_order_relaxed);
+        m_switches[i].store(0, std::memory_order_relaxed);
+        m_rendered[i].store(0, std::memory_order_relaxed);
+    }
+    std::cout << "[Sampler] Created with " << m_slotCount << " slots, " << kMaxVoices << " voices" << std::endl;
+}
+
+Sampler::~Sampler() {
+    // The stream is stopped by now, so nothing reads the slots
+    for (int i = 0; i < m_slotCount; ++i) {
+        if (m_slots[i]) unpinSample(*m_slots[i]);
+    }
+}
+
+bool Sampler::loadSlot(int slot, std::shared_ptr<const DecodedTrack> sample) {
+    if (slot < 0 || slot >= m_slotCount || !sample || sample->length <= 0) {
+        return false;
+    }
+    if (sample->channels != 1 && sample->channels != 2) {
+        std::cout << "[Sampler] Unsupported channel count " << sample->channels << " for " << sample->path << std::endl;
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(m_slotMutex);
+    pinSample(*sample);
+    replaceSlot(slot, sample);
+    std::cout << "[Sampler] Slot " << slot << " loaded: " << sample->path << " (" << sample->length << " frames)" << std::endl;
+    return true;
+}
+
+void Sampler::clearSlot(int slot) {
+    if (slot < 0 || slot >= m_slotCount) return;
+    std::lock_guard<std::mutex> lock(m_slotMutex);
+    if (m_slots[slot]) replaceSlot(slot, nullptr);
+}
+
+bool Sampler::isSlotLoaded(int slot) const {
+    if (slot < 0 || slot >= m_slotCount) return false;
+    return m_active[slot].load(std::memory_order_relaxed) != nullptr;
+}
+
+void Sampler::replaceSlot(int slot, std::shared_ptr<const DecodedTrack> sample) {
+    // Publish the new sample, then hold the old one until the audio thread
+    // has faded out every voice that might still be reading it
+    std::shared_ptr<const DecodedTrack> previous = std::move(m_slots[slot]);
+    m_slots[slot] = std::move(sample);
+    m_active[slot].store(m_slots[slot].get(), std::memory_order_release);
+    uint64_t switchCount = m_switches[slot].fetch_add(1, std::memory_order_release) + 1;
+    if (!previous) return;
+    if (waitForSlotSwitch(slot, switchCount)) {
+        m_retired[slot].clear();
+    } else {
+        // The stream isn't running; a voice may still fade it out on resume
+        m_retired[slot].push_back(previous);
+    }
+    unpinSample(*previous);
+}
+
+bool Sampler::waitForSlotSwitch(int slot, uint64_t switchCount) {
+    // If the stream is not running nothing is reading, so give up after a
+    // few buffers' worth of time instead of blocking the caller forever.
+    for (int i = 0; i < 50; ++i) {
+        if (m_rendered[slot].load(std::memory_order_acquire) >= switchCount) {
+            return true;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+    return false;
+}
+
+void Sampler::pinSample(const DecodedTrack& sample) {
+    // Decks may hold the same file pinned; only the first pin does the work
+    if (sample.pinCount.fetch_add(1) == 0) {
+        TrackMemory::pin(sample.samples.data(), sample.bytes());
+    }
+}
+
+void Sampler::unpinSample(const DecodedTrack& sample) {
+    if (sample.pinCount.fetch_sub(1) == 1) {
+        TrackMemory::unpin(sample.samples.data(), sample.bytes());
+    }
+}
+
+bool Sampler::trigger(int slot, float gain, double semitones) {
+    if (slot < 0 || slot >= m_slotCount || !m_active[slot].load(std::memory_order_relaxed)) {
+        return false;
+    }
+    double rate = std::pow(2.0, std::max(-24.0, std::min(24.0, semitones)) / 12.0);
+    return m_commands.push({Command::TRIGGER, slot, std::max(0.0f, std::min(2.0f, gain)), rate});
+}
+
+void Sampler::stopSlot(int slot) {
+    if (slot < 0 || slot >= m_slotCount) return;
+    m_commands.push({Command::STOP_SLOT, slot, 0.0f, 0.0});
+}
+
+void Sampler::stopAll() {
+    m_commands.push({Command::STOP_ALL, -1, 0.0f, 0.0});
+}
+
+void Sampler::setVolume(float volume) {
+    m_volume.store(std::max(0.0f, std::min(1.0f, volume)), std::memory_order_relaxed);
+}
+
+float Sampler::getVolume() const {
+    return m_volume.load(std::memory_order_relaxed);
+}
+
+int Sampler::getActiveVoices() const {
+    return m_activeVoices.load(std::memory_order_relaxed);
+}
+
+uint64_t Sampler::getStolenVoices() const {
+    return m_stolenVoices.load(std::memory_order_relaxed);
+}
+
+void Sampler::applyCommand(const Command& command) {
+    switch (command.type) {
+    case Command::TRIGGER:
+        startVoice(command.slot, command.gain, command.rate);
+        break;
+    case Command::STOP_SLOT:
+        for (Voice& voice : m_voices) {
+            if (voice.play.sample && voice.play.slot == command.slot) release(voice);
+        }
+        break;
+    case Command::STOP_ALL:
+        for (Voice& voice : m_voices) release(voice);
+        break;
+    }
+}
+
+void Sampler::startVoice(int slot, float gain, double rate) {
+    const DecodedTrack* sample = m_active[slot].load(std::memory_order_acquire);
+    if (!sample) return;
+
+    // Prefer a silent voice, then one that is only fading out a tail, and
+    // otherwise steal the oldest
+    Voice* chosen = nullptr;
+    for (Voice& voice : m_voices) {
+        if (!voice.play.sample && !voice.tail.sample) {
+            chosen = &voice;
+            break;
+        }
+        if (!voice.play.sample) {
+            if (!chosen || chosen->play.sample) chosen = &voice;
+        } else if (!chosen || (chosen->play.sample && voice.started < chosen->started)) {
+            chosen = &voice;
+        }
+    }
+    if (chosen->play.sample) {
+        release(*chosen);
+        m_stolenVoices.fetch_add(1, std::memory_order_relaxed);
+    }
+    chosen->play = {sample, slot, 0, toFixed(rate), gain, -1};
+    chosen->started = ++m_triggerCount;
+}
+
+void Sampler::release(Voice& voice) {
+    if (!voice.play.sample) return;
+    voice.tail = voice.play;
+    voice.tail.fade = kReleaseFrames;
+    voice.play.sample = nullptr;
+}
+
+void Sampler::releaseStale() {
+    for (Voice& voice : m_voices) {
+        if (voice.play.sample && voice.play.sample != m_active[voice.play.slot].load(std::memory_order_relaxed)) {
+            release(voice);
+        }
+    }
+}
+
+void Sampler::publishRendered() {
+    // A slot has switched once no voice or tail reads anything but its
+    // current sample. The count is read first, so the sample compared
+    // against is at least as new as the switch being acknowledged.
+    for (int slot = 0; slot < m_slotCount; ++slot) {
+        uint64_t switchCount = m_switches[slot].load(std::memory_order_acquire);
+        if (m_rendered[slot].load(std::memory_order_relaxed) == switchCount) continue;
+        const DecodedTrack* current = m_active[slot].load(std::memory_order_acquire);
+        bool stale = false;
+        for (const Voice& voice : m_voices) {
+            if ((voice.play.sample && voice.play.slot == slot && voice.play.sample != current) ||
+                (voice.tail.sample && voice.tail.slot == slot && voice.tail.sample != current)) {
+                stale = true;
+                break;
+            }
+        }
+        if (!stale) m_rendered[slot].store(switchCount, std::memory_order_release);
+    }
+}
+
+void Sampler::process(float* left, float* right, int frames) {
+    Command command;
+    while (m_commands.pop(command)) {
+        applyCommand(command);
+    }
+    releaseStale();
+
+    std::fill(left, left + frames, 0.0f);
+    std::fill(right, right + frames, 0.0f);
+    int active = 0;
+    for (Voice& voice : m_voices) {
+        for (Play* play : {&voice.tail, &voice.play}) {
+            if (!play->sample) continue;
+            bool playing = play->sample->channels == 2 ? mixPlay<2>(*play, left, right, frames)
+                                                       : mixPlay<1>(*play, left, right, frames);
+            if (!playing) play->sample = nullptr;
+        }
+        if (voice.play.sample || voice.tail.sample) ++active;
+    }
+
+    float volume = m_volume.load(std::memory_order_relaxed);
+    if (volume != 1.0f) {
+        for (int i = 0; i < frames; ++i) {
+            left[i] *= volume;
+            right[i] *= volume;
+        }
+    }
+    m_activeVoices.store(active, std::memory_order_relaxed);
+    publishRendered();
+}
+
+// The one mix kernel: Hermite-resampled read of a play, summed into the
+// bus at its gain, ramped down while fading. False once the play is done.
+template <int Channels>
+bool Sampler::mixPlay(Play& play, float* left, float* right, int frames) {
+    const float* data = play.sample->samples.data();
+    const int64_t length = play.sample->length;
+
+    int n = frames;
+    if (play.fade >= 0) n = std::min(n, play.fade);
+    int64_t remaining = ((length << kFixedShift) - play.position + play.increment - 1) / play.increment;
+    n = (int)std::max<int64_t>(0, std::min<int64_t>(n, remaining));
+
+    float gain = play.gain;
+    float step = 0.0f;
+    if (play.fade >= 0) {
+        step = play.gain / kReleaseFrames;
+        gain = step * play.fade;
+    }
+
+    // One bounds check per block: the attack and the last few frames gather
+    // their taps, silent outside the sample
+    int64_t pos = play.position;
+    int64_t first = (pos >> kFixedShift) - HermiteInterp::kBefore;
+    int64_t last = ((pos + play.increment * n) >> kFixedShift) + (HermiteInterp::kTaps - HermiteInterp::kBefore);
+    bool inside = first >= 0 && last < length;
+
+    float w[HermiteInterp::kTaps];
+    if (inside) {
+        for (int i = 0; i < n; ++i) {
+            HermiteInterp::weights((uint32_t)pos, w);
+            const float* p = data + ((pos >> kFixedShift) - HermiteInterp::kBefore) * Channels;
+            float l = applyTaps<HermiteInterp::kTaps>(p, Channels, w);
+            float r = Channels == 2 ? applyTaps<HermiteInterp::kTaps>(p + 1, Channels, w) : l;
+            left[i] += l * gain;
+            right[i] += r * gain;
+            gain -= step;
+            pos += play.increment;
+        }
+    } else {
+        float taps[Channels][HermiteInterp::kTaps];
+        for (int i = 0; i < n; ++i) {
+            HermiteInterp::weights((uint32_t)pos, w);
+            int64_t base = (pos >> kFixedShift) - HermiteInterp::kBefore;
+            for (int t = 0; t < HermiteInterp::kTaps; ++t) {
+                int64_t idx = base + t;
+                bool valid = idx >= 0 && idx < length;
+                for (int ch = 0; ch < Channels; ++ch) {
+                    taps[ch][t] = valid ? data[idx * Channels + ch] : 0.0f;
+                }
+            }
+            left[i] += applyTaps<HermiteInterp::kTaps>(taps[0], 1, w) * gain;
+            right[i] += applyTaps<HermiteInterp::kTaps>(taps[Channels - 1], 1, w) * gain;
+            gain -= step;
+            pos += play.increment;
+        }
+    }
+
+    play.position = pos;
+    if (play.fade >= 0) play.fade -= n;
+    return n == frames && play.fade != 0;
+}
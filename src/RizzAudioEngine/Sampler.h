@@ -0,0 +1,105 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include "DecodedTrack.h"
+#include "CommandQueue.h"
+
+// Sample bank for drops and one-shots: 16..64 slots of resident samples
+// played through a fixed pool of voices. Triggers from any thread go
+// through a lock-free queue; the audio thread picks a voice (stealing the
+// oldest when all are busy) and mixes every voice in one pass.
+class Sampler {
+public:
+    static constexpr int kMinSlots = 16;
+    static constexpr int kMaxSlots = 64;
+    static constexpr int kMaxVoices = 32;
+
+    explicit Sampler(int slots = 32);
+    ~Sampler();
+
+    int getSlotCount() const { return m_slotCount; }
+
+    // Control side. Samples are pinned in RAM while loaded; replacing or
+    // clearing a slot fades out any voice still playing the old sample.
+    bool loadSlot(int slot, std::shared_ptr<const DecodedTrack> sample);
+    void clearSlot(int slot);
+    bool isSlotLoaded(int slot) const;
+
+    // Any thread, never blocks. Gain is linear (0..2), pitch in semitones
+    // (-24..24, resampled). False if the slot is empty or the queue is full.
+    bool trigger(int slot, float gain, double semitones);
+    void stopSlot(int slot);
+    void stopAll();
+    void setVolume(float volume);
+    float getVolume() const;
+    int getActiveVoices() const;
+    uint64_t getStolenVoices() const;
+
+    // Audio thread: overwrite left/right with the mix of all voices
+    void process(float* left, float* right, int frames);
+
+private:
+    struct Command {
+        enum Type { TRIGGER, STOP_SLOT, STOP_ALL };
+        Type type;
+        int slot;
+        float gain;
+        double rate;
+    };
+    // One sample being read. fade < 0 while it plays on; otherwise it is
+    // fading out and ends after `fade` more frames.
+    struct Play {
+        const DecodedTrack* sample;
+        int slot;
+        int64_t position;    // 32.32
+        int64_t increment;
+        float gain;
+        int fade;
+    };
+    // A voice keeps the play it was stolen from (or stopped) as a tail, so
+    // the old sound fades out under the new one instead of clicking off
+    struct Voice {
+        Play play;
+        Play tail;
+        uint64_t started;
+    };
+
+    void applyCommand(const Command& command);
+    void startVoice(int slot, float gain, double rate);
+    void release(Voice& voice);
+    void releaseStale();
+    void publishRendered();
+    template <int Channels>
+    bool mixPlay(Play& play, float* left, float* right, int frames);
+    bool waitForSlotSwitch(int slot, uint64_t switchCount);
+    void replaceSlot(int slot, std::shared_ptr<const DecodedTrack> sample);
+    static void pinSample(const DecodedTrack& sample);
+    static void unpinSample(const DecodedTrack& sample);
+
+    const int m_slotCount;
+
+    // Audio thread only
+    CommandQueue<Command, 256> m_commands;
+    Voice m_voices[kMaxVoices];
+    uint64_t m_triggerCount;
+
+    std::atomic<float> m_volume;
+    std::atomic<int> m_activeVoices;
+    std::atomic<uint64_t> m_stolenVoices;
+
+    // Owned on the control side; the audio thread only sees m_active. Each
+    // change bumps m_switches, and the audio thread copies the count into
+    // m_rendered once no voice still reads an older sample. m_retired keeps
+    // replaced samples alive while the stream is stopped and so could still
+    // fade them out when it resumes.
+    std::mutex m_slotMutex;
+    std::shared_ptr<const DecodedTrack> m_slots[kMaxSlots];
+    std::vector<std::shared_ptr<const DecodedTrack>> m_retired[kMaxSlots];
+    std::atomic<const DecodedTrack*> m_active[kMaxSlots];
+    std::atomic<uint64_t> m_switches[kMaxSlots];
+    std::atomic<uint64_t> m_rendered[kMaxSlots];
+};
@@ -4,17 +4,26 @@
 #include <cstring>
 #include <cmath>
 #include <cstdint>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <algorithm>
+#include "EngineStats.h"
 #define DR_MP3_IMPLEMENTATION
 #include "dr_mp3.h"
 
 static std::ofstream debugLog("scratchbuffer_debug.log", std::ios::app);
+static std::mutex debugLogMutex; // decodes also run on the prefetch thread
 
-void resampleAudio(std::vector<float>& data, int channels, int srcRate, int dstRate) {
+void resampleAudio(TrackSamples& data, int channels, int srcRate, int dstRate) {
     if (srcRate == dstRate) return;
-    debugLog << "[resampleAudio] Resampling from " << srcRate << " to " << dstRate << std::endl;
+    {
+        std::lock_guard<std::mutex> lock(debugLogMutex);
+        debugLog << "[resampleAudio] Resampling from " << srcRate << " to " << dstRate << std::endl;
+    }
     size_t srcSamples = data.size() / channels;
     size_t dstSamples = (size_t)(srcSamples * (double)dstRate / srcRate);
-    std::vector<float> newData(dstSamples * channels);
+    TrackSamples newData(dstSamples * channels);
     for (size_t i = 0; i < dstSamples; ++i) {
         double srcPos = (double)i * srcRate / dstRate;
         size_t srcIdx = (size_t)srcPos;
@@ -32,6 +41,22 @@ void resampleAudio(std::vector<float>& data, int channels, int srcRate, int dstR
     data = std::move(newData);
 }
 
+// Stem files are kept planar so the deck's stem mix reads each channel
+// as one contiguous run
+static void toPlanar(DecodedTrack& track) {
+    const size_t length = (size_t)track.length;
+    const int channels = track.channels;
+    TrackSamples planar(length * channels);
+    for (int ch = 0; ch < channels; ++ch) {
+        float* out = planar.data() + ch * length;
+        for (size_t i = 0; i < length; ++i) {
+            out[i] = track.samples[i * channels + ch];
+        }
+    }
+    track.samples = std::move(planar);
+    track.planar = true;
+}
+
 bool ScratchBuffer::getFileInfo(const std::string& filePath, FileInfo& info) {
     std::ifstream file(filePath, std::ios::binary);
     if (!file) {
@@ -71,7 +96,17 @@ bool ScratchBuffer::getFileInfo(const std::string& filePath, FileInfo& info) {
                 info.sampleRate = sampleRate;
                 info.bitsPerSample = bits;
                 info.audioFormat = audioFormat;
-                file.seekg(chunkSize - 16, std::ios::cur);
+                uint32_t consumed = 16;
+                if (audioFormat == 0xFFFE && chunkSize >= 40) {
+                    // WAVE_FORMAT_EXTENSIBLE (most multichannel files): the
+                    // sub-format GUID starts with the real format code
+                    uint16_t subFormat;
+                    file.seekg(8, std::ios::cur);
+                    file.read(reinterpret_cast<char*>(&subFormat), 2);
+                    info.audioFormat = subFormat;
+                    consumed = 26;
+                }
+                file.seekg(chunkSize - consumed, std::ios::cur);
                 break;
             } else {
                 file.seekg(chunkSize, std::ios::cur);
@@ -108,13 +143,38 @@ bool ScratchBuffer::getFileInfo(const std::string& filePath, FileInfo& info) {
     return false;
 }
 
-ScratchBuffer::ScratchBuffer() : m_stream(nullptr), m_isPlaying(false), m_currentFrame(0), m_speed(1.0), m_length(0), m_channels(0) {
+ScratchBuffer::ScratchBuffer(int statsSlot) : m_stream(nullptr), m_isPlaying(false), m_speed(1.0), m_interpolation(INTERP_HERMITE),
+                                 m_playhead(0), m_increment(kFixedOne), m_seekPending(false), m_seekTarget(0), m_position(0),
+                                 m_keyLock(false), m_keyLockMode(TimeStretcher::WSOLA), m_keyShift(0.0), m_stretchActive(false),
+                                 m_shiftSpeed(1.0), m_shiftPitch(1.0),
+                                 m_shifter(std::make_unique<PitchShifter>()), m_statsSlot(statsSlot), m_shiftLoad(0.0f),
+                                 m_loopSet(false), m_loopActive(false), m_loopStart(-1), m_loopEnd(-1), m_rollActive(false),
+                                 m_rollRestoreLoop(false), m_rollRestoreActive(false), m_rollRestoreStart(-1),
+                                 m_rollRestoreEnd(-1), m_seamRemaining(0), m_seamLength(0), m_seamOffset(0),
+                                 m_loopInFrame(-1), m_loopOutFrame(-1), m_loopActivePublished(false),
+                                 m_slip(false), m_reverse(false), m_slipping(false), m_cueHeld(false), m_slipShadow(0),
+                                 m_slipIncrement(0), m_slipPosition(-1),
+                                 m_clock(nullptr), m_sync(false), m_syncLeader(false), m_syncState(SYNC_OFF), m_phaseError(0.0f),
+                                 m_blockSpeed(1.0), m_frameCounter(0), m_scheduledCount(0), m_outroPoint(-1), m_outroCrossing(-1),
+                                 m_stemRampBase(0.0), m_stemRampScale(0.0),
+                                 m_transportFadeFrames(132), m_renderTrack(nullptr), m_audible(false), m_platterEngaged(false),
+                                 m_fadeRemaining(0), m_fadeLength(0), m_fadeCorrelation(0.0f), m_quantize(false),
+                                 m_activeTrack(nullptr), m_renderedTrack(nullptr), m_blocksRendered(0), m_memoryLocked(false), m_trackPinned(false) {
+    for (auto& cue : m_hotCues) cue.store(-1, std::memory_order_relaxed);
+    for (int i = 0; i < kMaxStems; ++i) {
+        m_stemGain[i].store(1.0f, std::memory_order_relaxed);
+        m_stemMute[i].store(false, std::memory_order_relaxed);
+        m_stemFrom[i] = m_stemTo[i] = 1.0f;
+    }
     debugLog << "Starting ScratchBuffer boot" << std::endl;
     debugLog.flush();
     std::cout << "[ScratchBuffer] Created" << std::endl;
 }
 
 ScratchBuffer::~ScratchBuffer() {
+    if (m_track && m_trackPinned) {
+        unpinTrack(*m_track);
+    }
     std::cout << "[ScratchBuffer] Destroyed" << std::endl;
 }
 
@@ -124,50 +184,159 @@ bool ScratchBuffer::initialize(void* stream) {
     return true;
 }
 
-bool ScratchBuffer::loadFile(const std::string& filePath) {
+std::shared_ptr<DecodedTrack> ScratchBuffer::decodeFile(const std::string& filePath) {
     FileInfo info;
     if (!getFileInfo(filePath, info)) {
         std::cout << "[ScratchBuffer] Unsupported file format: " << filePath << std::endl;
-        return false;
+        return nullptr;
     }
 
     // Log file info
-    debugLog << "[ScratchBuffer] File info: " << filePath << " - Format: " << info.format
-             << ", SampleRate: " << info.sampleRate << ", Channels: " << info.channels
-             << ", Bits: " << info.bitsPerSample << ", Length: " << info.lengthSamples
-             << " samples (" << info.duration << "s)" << std::endl;
-    debugLog.flush();
+    {
+        std::lock_guard<std::mutex> lock(debugLogMutex);
+        debugLog << "[ScratchBuffer] File info: " << filePath << " - Format: " << info.format
+                 << ", SampleRate: " << info.sampleRate << ", Channels: " << info.channels
+                 << ", Bits: " << info.bitsPerSample << ", Length: " << info.lengthSamples
+                 << " samples (" << info.duration << "s)" << std::endl;
+        debugLog.flush();
+
+        // Validate
+        if (info.sampleRate != 44100 && info.sampleRate != 48000) {
+            debugLog << "[ScratchBuffer] Warning: Unusual sample rate " << info.sampleRate << " Hz" << std::endl;
+        }
+        if (info.channels < 1 || info.channels > kMaxStems * 2) {
+            debugLog << "[ScratchBuffer] Warning: Unsupported channel count " << info.channels << std::endl;
+            return nullptr;
+        }
+        if (info.bitsPerSample != 16) {
+            debugLog << "[ScratchBuffer] Warning: Non-16-bit files may not load correctly" << std::endl;
+        }
+    }
+
+    auto track = std::make_shared<DecodedTrack>();
+    track->path = filePath;
+    bool ok = false;
+    if (info.format == "WAV") {
+        ok = loadWAV(filePath, info, *track);
+    } else if (info.format == "MP3") {
+        ok = loadMP3(filePath, info, *track);
+    }
+
+    return ok ? track : nullptr;
+}
 
-    // Validate
-    if (info.sampleRate != 44100 && info.sampleRate != 48000) {
-        debugLog << "[ScratchBuffer] Warning: Unusual sample rate " << info.sampleRate << " Hz" << std::endl;
+bool ScratchBuffer::loadFile(const std::string& filePath) {
+    auto track = decodeFile(filePath);
+    if (!track) {
+        return false;
     }
-    if (info.channels < 1 || info.channels > 2) {
-        debugLog << "[ScratchBuffer] Warning: Unsupported channel count " << info.channels << std::endl;
+    return loadTrack(std::move(track));
+}
+
+bool ScratchBuffer::loadTrack(std::shared_ptr<const DecodedTrack> track) {
+    if (!track || track->length <= 0) {
         return false;
     }
-    if (info.bitsPerSample != 16) {
-        debugLog << "[ScratchBuffer] Warning: Non-16-bit files may not load correctly" << std::endl;
+
+    // Hot cues and their locked windows belong to the outgoing track
+    std::lock_guard<std::mutex> cueLock(m_cueMutex);
+    for (auto& cue : m_hotCues) {
+        int64_t frame = cue.exchange(-1, std::memory_order_relaxed);
+        if (frame >= 0 && m_track) pinCueWindow(*m_track, frame, false);
     }
+    m_controlGrid = BeatGrid();
+    m_outroPoint.store(-1, std::memory_order_relaxed);
 
-    if (info.format == "WAV") {
-        return loadWAV(filePath, info);
-    } else if (info.format == "MP3") {
-        return loadMP3(filePath, info);
+    // Publish the new track, then hold the old one until the audio thread
+    // has finished any block that might still be reading it.
+    std::shared_ptr<const DecodedTrack> previous = std::move(m_track);
+    bool previousPinned = m_trackPinned;
+    m_track = std::move(track);
+    m_trackPinned = false;
+    if (m_memoryLocked) {
+        pinTrack(*m_track);
+        m_trackPinned = true;
+    }
+    m_seekTarget.store(0, std::memory_order_relaxed);
+    m_seekPending.store(true, std::memory_order_relaxed);
+    m_position.store(0, std::memory_order_relaxed);
+    m_activeTrack.store(m_track.get(), std::memory_order_release);
+    post(DeckCommand::TRACK_LOADED); // drops the old track's loops and grid
+    if (previous) {
+        if (waitForTrackSwitch(m_track.get())) {
+            m_retiredTrack.reset();
+        } else {
+            // The stream isn't running; keep whatever it last played, which
+            // it fades out when it resumes
+            const DecodedTrack* last = m_renderedTrack.load(std::memory_order_acquire);
+            if (last == previous.get()) m_retiredTrack = previous;
+            else if (last != m_retiredTrack.get()) m_retiredTrack.reset();
+        }
+        if (previousPinned) {
+            unpinTrack(*previous);
+        }
     }
 
+    std::cout << "[ScratchBuffer] Track ready: " << m_track->path << " (" << m_track->length << " frames)" << std::endl;
+    return true;
+}
+
+bool ScratchBuffer::waitForTrackSwitch(const DecodedTrack* track) {
+    // If the stream is not running nothing is reading, so give up after a
+    // few buffers' worth of time instead of blocking the caller forever.
+    for (int i = 0; i < 50; ++i) {
+        if (m_renderedTrack.load(std::memory_order_acquire) == track) {
+            return true;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
     return false;
 }
 
-bool ScratchBuffer::loadWAV(const std::string& filePath, const FileInfo& info) {
-    debugLog << "Starting file load boot for " << filePath << std::endl;
-    debugLog.flush();
-    debugLog << "[ScratchBuffer] loadWAV start" << std::endl;
-    debugLog << "[ScratchBuffer] loadWAV called for " << filePath << std::endl;
-    m_channels = info.channels;
-    m_sampleRate = info.sampleRate;
-    m_bitsPerSample = info.bitsPerSample;
-    m_length = info.lengthSamples;
+void ScratchBuffer::setMemoryLocked(bool locked) {
+    std::lock_guard<std::mutex> cueLock(m_cueMutex);
+    m_memoryLocked = locked;
+    if (!m_track) return;
+    if (locked && !m_trackPinned) {
+        pinTrack(*m_track);
+        m_trackPinned = true;
+    } else if (!locked && m_trackPinned) {
+        unpinTrack(*m_track);
+        m_trackPinned = false;
+        // The whole-track unlock released the cue windows too
+        for (auto& cue : m_hotCues) {
+            int64_t frame = cue.load(std::memory_order_relaxed);
+            if (frame >= 0) pinCueWindow(*m_track, frame, true);
+        }
+    }
+    std::cout << "[ScratchBuffer] Track memory " << (locked ? "locked" : "unlocked") << std::endl;
+}
+
+void ScratchBuffer::pinTrack(const DecodedTrack& track) {
+    // Both decks may hold the same track; only the first pin does the work
+    if (track.pinCount.fetch_add(1) == 0) {
+        TrackMemory::pin(track.samples.data(), track.bytes());
+    }
+}
+
+void ScratchBuffer::unpinTrack(const DecodedTrack& track) {
+    if (track.pinCount.fetch_sub(1) == 1) {
+        TrackMemory::unpin(track.samples.data(), track.bytes());
+    }
+}
+
+bool ScratchBuffer::loadWAV(const std::string& filePath, const FileInfo& info, DecodedTrack& track) {
+    {
+        std::lock_guard<std::mutex> lock(debugLogMutex);
+        debugLog << "Starting file load boot for " << filePath << std::endl;
+        debugLog.flush();
+        debugLog << "[ScratchBuffer] loadWAV start" << std::endl;
+        debugLog << "[ScratchBuffer] loadWAV called for " << filePath << std::endl;
+    }
+    track.channels = info.channels;
+    track.sampleRate = info.sampleRate;
+    track.bitsPerSample = info.bitsPerSample;
+    track.length = info.lengthSamples;
 
     std::ifstream file(filePath, std::ios::binary);
     if (!file) {
@@ -184,32 +353,41 @@ bool ScratchBuffer::loadWAV(const std::string& filePath, const FileInfo& info) {
         uint32_t chunkSize;
         file.read(reinterpret_cast<char*>(&chunkSize), 4);
         if (std::memcmp(chunkId, "data", 4) == 0) {
-            m_audioData.resize(m_length * m_channels);
-            if (m_bitsPerSample == 16) {
-                std::vector<int16_t> rawData(m_length * m_channels);
+            track.samples.resize(track.length * track.channels);
+            if (track.bitsPerSample == 16) {
+                std::vector<int16_t> rawData(track.length * track.channels);
                 file.read(reinterpret_cast<char*>(rawData.data()), chunkSize);
                 for (size_t i = 0; i < rawData.size(); ++i) {
-                    m_audioData[i] = rawData[i] / 32768.0f;
+                    track.samples[i] = rawData[i] / 32768.0f;
                 }
-            } else if (m_bitsPerSample == 32) {
+            } else if (track.bitsPerSample == 24) {
+                std::vector<uint8_t> rawData(track.length * track.channels * 3);
+                file.read(reinterpret_cast<char*>(rawData.data()), rawData.size());
+                for (size_t i = 0; i < track.samples.size(); ++i) {
+                    const uint8_t* b = &rawData[i * 3];
+                    int32_t value = (int32_t)((uint32_t)b[0] << 8 | (uint32_t)b[1] << 16 | (uint32_t)b[2] << 24);
+                    track.samples[i] = value / 2147483648.0f;
+                }
+            } else if (track.bitsPerSample == 32) {
                 if (info.audioFormat == 3) {
                     // float
-                    file.read(reinterpret_cast<char*>(m_audioData.data()), chunkSize);
+                    file.read(reinterpret_cast<char*>(track.samples.data()), chunkSize);
                 } else {
                     // int32 PCM
-                    std::vector<int32_t> rawData(m_length * m_channels);
+                    std::vector<int32_t> rawData(track.length * track.channels);
                     file.read(reinterpret_cast<char*>(rawData.data()), chunkSize);
                     for (size_t i = 0; i < rawData.size(); ++i) {
-                        m_audioData[i] = rawData[i] / 2147483648.0f;
+                        track.samples[i] = rawData[i] / 2147483648.0f;
                     }
                 }
             }
             // Resample to 44100 Hz
-            debugLog << "[ScratchBuffer] Before resample, rate=" << m_sampleRate << std::endl;
-            resampleAudio(m_audioData, m_channels, m_sampleRate, 44100);
-            m_sampleRate = 44100;
-            m_length = m_audioData.size() / m_channels;
-            debugLog << "[ScratchBuffer] Loaded and resampled WAV data, length=" << m_length << ", channels=" << m_channels << ", rate=" << m_sampleRate << ", bits=" << m_bitsPerSample << std::endl;
+            resampleAudio(track.samples, track.channels, track.sampleRate, 44100);
+            track.sampleRate = 44100;
+            track.length = track.samples.size() / track.channels;
+            if (track.channels > 2) toPlanar(track);
+            std::lock_guard<std::mutex> lock(debugLogMutex);
+            debugLog << "[ScratchBuffer] Loaded and resampled WAV data, length=" << track.length << ", channels=" << track.channels << ", rate=" << track.sampleRate << ", bits=" << track.bitsPerSample << std::endl;
             return true;
         } else {
             file.seekg(chunkSize, std::ios::cur);
@@ -220,23 +398,27 @@ bool ScratchBuffer::loadWAV(const std::string& filePath, const FileInfo& info) {
     return false;
 }
 
-bool ScratchBuffer::loadMP3(const std::string& filePath, const FileInfo& info) {
-    debugLog << "Starting file load boot for " << filePath << std::endl;
-    debugLog.flush();
+bool ScratchBuffer::loadMP3(const std::string& filePath, const FileInfo& info, DecodedTrack& track) {
+    (void)info;
+    {
+        std::lock_guard<std::mutex> lock(debugLogMutex);
+        debugLog << "Starting file load boot for " << filePath << std::endl;
+        debugLog.flush();
+    }
     drmp3 mp3;
     if (!drmp3_init_file(&mp3, filePath.c_str(), NULL)) {
         std::cout << "[ScratchBuffer] Failed to open MP3 file: " << filePath << std::endl;
         return false;
     }
 
-    m_channels = mp3.channels;
-    m_sampleRate = mp3.sampleRate;
-    m_bitsPerSample = 32; // float
+    track.channels = mp3.channels;
+    track.sampleRate = mp3.sampleRate;
+    track.bitsPerSample = 32; // float
     drmp3_uint64 totalFrames = drmp3_get_pcm_frame_count(&mp3);
-    m_length = totalFrames;
-    m_audioData.resize(totalFrames * m_channels);
+    track.length = totalFrames;
+    track.samples.resize(totalFrames * track.channels);
 
-    size_t framesRead = drmp3_read_pcm_frames_f32(&mp3, totalFrames, m_audioData.data());
+    size_t framesRead = drmp3_read_pcm_frames_f32(&mp3, totalFrames, track.samples.data());
     if (framesRead != totalFrames) {
         std::cout << "[ScratchBuffer] Failed to read all MP3 frames" << std::endl;
         drmp3_uninit(&mp3);
@@ -245,43 +427,805 @@ bool ScratchBuffer::loadMP3(const std::string& filePath, const FileInfo& info) {
 
     drmp3_uninit(&mp3);
     // Resample to 44100 Hz if needed
-    if (m_sampleRate != 44100) {
-        resampleAudio(m_audioData, m_channels, m_sampleRate, 44100);
-        m_sampleRate = 44100;
-        m_length = m_audioData.size() / m_channels;
+    if (track.sampleRate != 44100) {
+        resampleAudio(track.samples, track.channels, track.sampleRate, 44100);
+        track.sampleRate = 44100;
+        track.length = track.samples.size() / track.channels;
     }
-    debugLog << "[ScratchBuffer] Loaded and resampled MP3 data, length=" << m_length << ", channels=" << m_channels << ", rate=" << m_sampleRate << std::endl;
+    std::lock_guard<std::mutex> lock(debugLogMutex);
+    debugLog << "[ScratchBuffer] Loaded and resampled MP3 data, length=" << track.length << ", channels=" << track.channels << ", rate=" << track.sampleRate << std::endl;
     return true;
 }
 
+static int64_t steadyNowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Equal-power fade-in curve for loop seams; the fade-out is its mirror
+static const int kSeamGainPoints = 128;
+static const float* seamGain() {
+    static float gain[kSeamGainPoints];
+    static bool ready = [] {
+        for (int i = 0; i < kSeamGainPoints; ++i) gain[i] = (float)std::sin(1.5707963267948966 * (i + 0.5) / kSeamGainPoints);
+        return true;
+    }();
+    (void)ready;
+    return gain;
+}
+
 void ScratchBuffer::getAudio(float* left, float* right, int frames) {
-    if (!m_isPlaying || m_audioData.empty()) {
+    if (frames <= 0) return;
+    // The engine clock is the timeline; without one the deck counts alone
+    if (m_clock) m_frameCounter = m_clock->frame();
+    takeScheduled();
+    while (frames > 0) {
+        // Run what is due, and stop the chunk where the next action lands
+        int n = std::min(frames, kMaxRenderFrames);
+        while (m_scheduledCount > 0) {
+            int next = 0;
+            int64_t due = dueFrame(m_scheduled[0]);
+            for (int i = 1; i < m_scheduledCount; ++i) {
+                int64_t d = dueFrame(m_scheduled[i]);
+                if (d < due) {
+                    due = d;
+                    next = i;
+                }
+            }
+            if (due > m_frameCounter) {
+                n = (int)std::min<int64_t>(n, due - m_frameCounter);
+                break;
+            }
+            ScheduledAction action = m_scheduled[next];
+            std::copy(m_scheduled + next + 1, m_scheduled + m_scheduledCount, m_scheduled + next);
+            --m_scheduledCount;
+            applyCommand(action.command, m_activeTrack.load(std::memory_order_acquire));
+        }
+        bool outro = m_outroPoint.load(std::memory_order_relaxed) >= 0;
+        int64_t before = outro ? audiblePosition() : 0;
+        bool playing = outro && m_isPlaying.load(std::memory_order_relaxed);
+        renderChunk(left, right, n);
+        if (outro) checkOutro(m_activeTrack.load(std::memory_order_acquire), before, playing, n);
+        m_frameCounter += n;
+        left += n;
+        right += n;
+        frames -= n;
+    }
+}
+
+void ScratchBuffer::takeScheduled() {
+    ScheduledAction action;
+    while (m_scheduledCount < kMaxScheduled && m_scheduleQueue.pop(action)) {
+        if (action.timeBase == SCHEDULE_NEXT_BEATS) {
+            // Quantize against the clock as it is now, not when it was posted
+            double quantum = action.time > 0.0 ? action.time : 1.0;
+            action.time = m_clock ? std::ceil(m_clock->beat() / quantum - 1e-9) * quantum : 0.0;
+            action.timeBase = SCHEDULE_BEAT;
+        }
+        if (action.command.type == DeckCommand::CANCEL_SCHEDULED) {
+            m_scheduledCount = 0;   // everything posted before the cancel
+            continue;
+        }
+        m_scheduled[m_scheduledCount++] = action;
+    }
+}
+
+void ScratchBuffer::checkOutro(const DecodedTrack* track, int64_t before, bool playing, int frames) {
+    // Fires while playing forward, or once the track has run out; a point
+    // already behind the play head fires at the start of the chunk
+    int64_t point = m_outroPoint.load(std::memory_order_relaxed);
+    int64_t after = audiblePosition();
+    if (!track || point < 0 || (after >> kFixedShift) < point) return;
+    if (!playing && (after >> kFixedShift) < track->length) return;
+    if (!m_outroPoint.compare_exchange_strong(point, -1, std::memory_order_relaxed)) return;
+
+    // First frame at or past the point, taking the chunk's rate as even
+    int64_t offset = 0;
+    double from = fromFixed(before), to = fromFixed(after);
+    if (from < point && to > from) {
+        offset = (int64_t)std::ceil((point - from) * frames / (to - from) - 1e-9);
+        offset = std::max<int64_t>(0, std::min<int64_t>(frames - 1, offset));
+    }
+    m_outroCrossing = m_frameCounter + offset;
+}
+
+bool ScratchBuffer::takeOutroCrossing(int64_t& engineFrame) {
+    if (m_outroCrossing < 0) return false;
+    engineFrame = m_outroCrossing;
+    m_outroCrossing = -1;
+    return true;
+}
+
+void ScratchBuffer::setOutroPoint(int64_t frame) {
+    m_outroPoint.store(frame < 0 ? -1 : frame, std::memory_order_relaxed);
+}
+
+void ScratchBuffer::setStemGain(int stem, float gain) {
+    if (stem < 0 || stem >= kMaxStems) return;
+    m_stemGain[stem].store(std::max(0.0f, std::min(2.0f, gain)), std::memory_order_relaxed);
+}
+
+void ScratchBuffer::setStemMute(int stem, bool muted) {
+    if (stem < 0 || stem >= kMaxStems) return;
+    m_stemMute[stem].store(muted, std::memory_order_relaxed);
+}
+
+float ScratchBuffer::getStemGain(int stem) const {
+    if (stem < 0 || stem >= kMaxStems) return 0.0f;
+    return m_stemGain[stem].load(std::memory_order_relaxed);
+}
+
+int ScratchBuffer::getStemCount() const {
+    return m_track ? m_track->stems() : 0;
+}
+
+bool ScratchBuffer::isPlaying() const {
+    return m_isPlaying.load(std::memory_order_relaxed);
+}
+
+int64_t ScratchBuffer::dueFrame(const ScheduledAction& action) const {
+    if (action.timeBase == SCHEDULE_FRAME) return (int64_t)action.time;
+    // Beats need the clock; without one they run straight away
+    return m_clock ? m_clock->frameAtBeat(action.time) : m_frameCounter;
+}
+
+void ScratchBuffer::renderChunk(float* left, float* right, int frames) {
+    const DecodedTrack* track = m_activeTrack.load(std::memory_order_acquire);
+    bool seeking = m_seekPending.exchange(false, std::memory_order_acq_rel);
+    bool playing = m_isPlaying.load(std::memory_order_relaxed);
+    if (track && track->planar) updateStemGains(track, frames);
+    beginTransportFade(track, seeking, playing);
+    if (track != m_renderTrack) {
+        m_renderTrack = track;
+        m_renderedTrack.store(track, std::memory_order_release);
+    }
+    if (seeking) {
+        m_playhead = m_seekTarget.load(std::memory_order_relaxed);
+        m_stretchActive = false; // restart the stretcher at the new position
+        m_seamRemaining = 0;
+        m_slipShadow = m_playhead;
+    }
+    const int64_t blockStart = audiblePosition();
+    applyCommands(track);
+    if (m_slipping && !slipHeld()) endSlip(track);
+    m_blockSpeed = m_speed.load(std::memory_order_relaxed);
+    if (m_sync.load(std::memory_order_relaxed) && m_clock && !m_syncLeader.load(std::memory_order_relaxed)) {
+        m_blockSpeed = syncSpeed(track, playing, blockStart, frames);
+    } else if (m_syncState.load(std::memory_order_relaxed) != SYNC_OFF) {
+        m_pll.reset();
+        publishSync(SYNC_OFF, 0.0);
+    }
+    renderBlock(track, playing, left, right, frames);
+    advanceSlip(blockStart, playing, frames);
+    if (m_fadeRemaining > 0) mixTransportFade(left, right, frames);
+}
+
+double ScratchBuffer::syncSpeed(const DecodedTrack* track, bool playing, int64_t position, int frames) {
+    // Phase-align to within this many beats by jumping, and call the deck
+    // locked within the second (~5 ms at 120 BPM)
+    static constexpr double kSnapBeats = 0.1;
+    static constexpr double kLockedBeats = 0.01;
+    double speed = m_speed.load(std::memory_order_relaxed);
+    if (!track || !m_grid.valid()) {
+        m_pll.reset();
+        publishSync(SYNC_NO_GRID, 0.0);
+        return speed;
+    }
+
+    double base = m_clock->bpm() / m_grid.bpm;
+    double error = m_clock->beat() - m_grid.beatAt(fromFixed(position));
+    error -= std::floor(error + 0.5);
+    // A paused or held deck just matches tempo; the lock resumes afterwards
+    bool held = !playing || m_loopActive || m_rollActive || m_cueHeld || m_platterEngaged ||
+                m_reverse.load(std::memory_order_relaxed);
+    if (held) {
+        m_pll.reset();
+        publishSync(SYNC_LOCKING, error);
+        return std::min(2.0, base);
+    }
+
+    if (std::abs(error) > kSnapBeats) {
+        // Engaging sync, a seek or a scratch left the deck well off the beat
+        int64_t target = position + toFixed(error * m_grid.framesPerBeat());
+        m_stretchActive = false;
+        jumpWithSeam(std::max<int64_t>(0, std::min(track->length << kFixedShift, target)));
+        m_pll.reset();
+        error = 0.0;
+    }
+    double correction = m_pll.update(error, m_clock->bpm() / 60.0, frames / 44100.0);
+    publishSync(std::abs(error) <= kLockedBeats ? SYNC_LOCKED : SYNC_LOCKING, error);
+    return std::min(2.0, base * (1.0 + correction));
+}
+
+void ScratchBuffer::publishSync(int state, double error) {
+    m_syncState.store(state, std::memory_order_relaxed);
+    m_phaseError.store((float)error, std::memory_order_relaxed);
+}
+
+bool ScratchBuffer::beatClock(double& bpm, double& beat) const {
+    if (!m_audible || !m_grid.valid() || m_blockSpeed <= 0.0 || m_reverse.load(std::memory_order_relaxed)) return false;
+    bpm = m_grid.bpm * m_blockSpeed;
+    beat = m_grid.beatAt(fromFixed(m_position.load(std::memory_order_relaxed)));
+    return true;
+}
+
+int64_t ScratchBuffer::audiblePosition() const {
+    // Key-lock reads ahead of what is heard
+    return m_stretchActive ? m_position.load(std::memory_order_relaxed) : m_playhead;
+}
+
+bool ScratchBuffer::slipHeld() const {
+    if (m_rollActive) return true;
+    if (!m_slip.load(std::memory_order_relaxed)) return false;
+    return m_loopActive || m_cueHeld || m_reverse.load(std::memory_order_relaxed) || m_platter.held();
+}
+
+void ScratchBuffer::beginSlip(int64_t from) {
+    if (m_slipping) return;
+    m_slipShadow = from;
+    m_slipping = true;
+}
+
+void ScratchBuffer::advanceSlip(int64_t blockStart, bool playing, int frames) {
+    // The shadow moves the way the deck would with nothing held: at the
+    // motor rate, ramped across the block like the varispeed path
+    int64_t motor = playing ? toFixed(m_blockSpeed) : 0;
+    int64_t step = (motor - m_slipIncrement) / frames;
+    int64_t advance = frames * m_slipIncrement + step * ((int64_t)frames * (frames - 1) / 2);
+    m_slipIncrement = motor;
+    if (!m_slipping && slipHeld()) {
+        // Held from the start of this block (scratch or reverse)
+        beginSlip(blockStart);
+    }
+    if (m_slipping) m_slipShadow += advance;
+    m_slipPosition.store(m_slipping ? m_slipShadow : -1, std::memory_order_relaxed);
+}
+
+void ScratchBuffer::endSlip(const DecodedTrack* track) {
+    m_slipping = false;
+    m_slipPosition.store(-1, std::memory_order_relaxed);
+    // Turning slip off mid-action just stops tracking
+    if (!track || !m_slip.load(std::memory_order_relaxed)) return;
+    // Come back at the shadow's rate, not ramping from a scratch or reverse
+    m_platter.settle();
+    m_increment = m_slipIncrement;
+    m_stretchActive = false;
+    jumpWithSeam(std::max<int64_t>(0, std::min(track->length << kFixedShift, m_slipShadow)));
+}
+
+void ScratchBuffer::renderBlock(const DecodedTrack* track, bool playing, float* left, float* right, int frames) {
+    int64_t targetIncrement = toFixed(m_blockSpeed);
+    if (m_reverse.load(std::memory_order_relaxed)) targetIncrement = -targetIncrement;
+
+    // The platter takes over while touched, settling, braking or spinning
+    // back, and can move a paused deck
+    if (track) {
+        int64_t nowNs = steadyNowNs();
+        double motor = playing ? fromFixed(targetIncrement) : 0.0;
+        double current = playing ? fromFixed(m_increment) : 0.0;
+        if (m_platter.process(motor, current, frames, nowNs, m_platterVelocity)) {
+            m_audible = true;
+            m_platterEngaged = true;
+            renderScratch(*track, left, right, frames);
+            if (m_platter.takeStopped()) {
+                m_isPlaying = false;
+                m_audible = false;
+            }
+            m_position.store(m_playhead, std::memory_order_relaxed);
+            m_blocksRendered.fetch_add(1, std::memory_order_release);
+            return;
+        }
+    }
+
+    m_platterEngaged = false;
+    if (!playing || !track) {
+        m_audible = false;
         // Fill with silence
         for (int i = 0; i < frames; ++i) {
             left[i] = 0.0f;
             right[i] = 0.0f;
         }
+        m_increment = targetIncrement;
+        m_blocksRendered.fetch_add(1, std::memory_order_release);
+        return;
+    }
+
+    // Key-lock and key shift both run through the shifter: tempo follows the
+    // rate, pitch is the key shift times either 1 (key-lock) or the rate.
+    // Very slow rates fall back to plain varispeed; stretching a near-frozen
+    // play head only smears one grain.
+    double speed = fromFixed(targetIncrement);
+    double shift = std::exp2(m_keyShift.load(std::memory_order_relaxed) / 12.0);
+    bool keyLock = m_keyLock.load(std::memory_order_relaxed);
+    if ((keyLock || shift != 1.0) && std::abs(speed) >= 0.1) {
+        double pitch = keyLock ? shift : shift * std::abs(speed);
+        m_audible = true;
+        renderShifted(*track, left, right, frames, speed, pitch);
+        m_increment = targetIncrement;
+
+        // What is audible trails the read head; after a loop wrap it is
+        // still the end of the previous pass
+        int64_t lead = toFixed(m_shifter->readAheadFrames(std::abs(speed), pitch));
+        int64_t audible = speed >= 0 ? m_playhead - lead : m_playhead + lead;
+        if (m_loopActive && m_playhead >= m_loopStart && m_playhead < m_loopEnd) {
+            if (audible < m_loopStart) audible += m_loopEnd - m_loopStart;
+            else if (audible >= m_loopEnd) audible -= m_loopEnd - m_loopStart;
+        }
+        int64_t lengthFixed = track->length << kFixedShift;
+        if (audible >= lengthFixed || audible < 0) {
+            // The end of the track has been heard
+            audible = audible < 0 ? 0 : lengthFixed;
+            m_playhead = audible;
+            m_isPlaying = false;
+            m_audible = false;
+            m_stretchActive = false;
+            publishShiftLoad(0.0f);
+        }
+        m_position.store(audible, std::memory_order_relaxed);
+        m_blocksRendered.fetch_add(1, std::memory_order_release);
         return;
     }
+    leaveShifted(*track);
 
-    // Play from audio data
+    // Ramp the rate across the block so fader moves don't zipper
+    const int64_t step = (targetIncrement - m_increment) / frames;
+    int64_t increment = m_increment;
     for (int i = 0; i < frames; ++i) {
-        long pos = m_currentFrame + i;
-        if (pos >= m_length) pos %= m_length; // Loop
-        if (m_channels == 1) {
-            float sample = m_audioData[pos];
-            left[i] = sample;
-            right[i] = sample;
-        } else if (m_channels == 2) {
-            left[i] = m_audioData[pos * 2];
-            right[i] = m_audioData[pos * 2 + 1];
+        m_increments[i] = increment;
+        increment += step;
+    }
+    int64_t peak = std::max(std::abs(m_increment), std::abs(targetIncrement));
+    m_audible = true;
+    renderSpan(*track, left, right, frames, peak, m_interpolation.load(std::memory_order_relaxed));
+    m_increment = targetIncrement;
+
+    m_position.store(m_playhead, std::memory_order_relaxed);
+    m_blocksRendered.fetch_add(1, std::memory_order_release);
+}
+
+void ScratchBuffer::beginTransportFade(const DecodedTrack* track, bool seeking, bool playing) {
+    int length = m_transportFadeFrames.load(std::memory_order_relaxed);
+    if (length <= 0) return;
+    // A pause while the platter is engaged spins down through the platter
+    bool stopping = m_audible && !playing && !m_platterEngaged;
+    bool jumping = m_audible && (seeking || track != m_renderTrack);
+    bool starting = !m_audible && playing && track;
+    if (!stopping && !jumping && !starting) return;
+
+    // Render what would have played next; a transport change arriving
+    // mid-fade folds the unfinished fade into it
+    float* tailLeft = m_fadeScratchLeft;
+    float* tailRight = m_fadeScratchRight;
+    if (m_audible && m_renderTrack) {
+        int64_t playhead = m_playhead;
+        renderTail(*m_renderTrack, tailLeft, tailRight, length);
+        if (stopping) {
+            // Resume exactly where the pause landed
+            if (m_stretchActive) {
+                m_playhead = m_position.load(std::memory_order_relaxed);
+                m_stretchActive = false;
+                publishShiftLoad(0.0f);
+            } else {
+                m_playhead = playhead;
+            }
+            m_seamRemaining = 0;
+        }
+    } else {
+        std::fill(tailLeft, tailLeft + length, 0.0f);
+        std::fill(tailRight, tailRight + length, 0.0f);
+    }
+    if (m_fadeRemaining > 0) mixTransportFade(tailLeft, tailRight, length);
+    std::copy(tailLeft, tailLeft + length, m_fadeLeft);
+    std::copy(tailRight, tailRight + length, m_fadeRight);
+    m_fadeLength = length;
+    m_fadeRemaining = length;
+    m_fadeCorrelation = 0.0f;
+}
+
+void ScratchBuffer::renderTail(const DecodedTrack& track, float* left, float* right, int frames) {
+    if (m_stretchActive) {
+        // The change that follows restarts the shifter anyway
+        renderShifted(track, left, right, frames, m_shiftSpeed, m_shiftPitch);
+        return;
+    }
+    std::fill(m_increments, m_increments + frames, m_increment);
+    renderVariable(track, left, right, frames, m_increments, m_playhead, std::abs(m_increment),
+                   m_interpolation.load(std::memory_order_relaxed));
+}
+
+void ScratchBuffer::mixTransportFade(float* left, float* right, int frames) {
+    const float* gain = seamGain();
+    int progress = m_fadeLength - m_fadeRemaining;
+    int count = std::min(frames, m_fadeRemaining);
+    for (int i = 0; i < count; ++i) {
+        int g = (progress + i) * kSeamGainPoints / m_fadeLength;
+        float in = gain[g];
+        float out = gain[kSeamGainPoints - 1 - g];
+        if (m_fadeCorrelation != 0.0f) {
+            // Keep the sum at unit power for sides that aren't independent
+            float norm = 1.0f / std::sqrt(1.0f + 2.0f * in * out * m_fadeCorrelation);
+            in *= norm;
+            out *= norm;
+        }
+        left[i] = left[i] * in + m_fadeLeft[progress + i] * out;
+        right[i] = right[i] * in + m_fadeRight[progress + i] * out;
+    }
+    m_fadeRemaining -= count;
+}
+
+void ScratchBuffer::leaveShifted(const DecodedTrack& track) {
+    if (!m_stretchActive) return;
+    // Resume varispeed from what was audible, not from the read-ahead, so
+    // the deck stays in step with the others
+    int64_t lengthFixed = track.length << kFixedShift;
+    m_playhead = std::max<int64_t>(0, std::min(lengthFixed, m_position.load(std::memory_order_relaxed)));
+    m_stretchActive = false;
+    publishShiftLoad(0.0f);
+}
+
+void ScratchBuffer::renderScratch(const DecodedTrack& track, float* left, float* right, int frames) {
+    leaveShifted(track);
+    int64_t peak = 0;
+    int64_t advance = 0;
+    for (int i = 0; i < frames; ++i) {
+        m_increments[i] = toFixed(m_platterVelocity[i]);
+        peak = std::max(peak, std::abs(m_increments[i]));
+        advance += m_increments[i];
+    }
+    // Scratches sweep well past 1x, so always band-limit
+    renderSpan(track, left, right, frames, peak, INTERP_SINC);
+    m_increment = m_increments[frames - 1];
+}
+
+void ScratchBuffer::edges(const DecodedTrack& track, int64_t& lo, int64_t& hi) const {
+    // The track ends, narrowed to the loop on whichever side the play head
+    // has already reached, so a loop ahead of the play head engages when
+    // playback gets there
+    lo = 0;
+    hi = track.length << kFixedShift;
+    if (m_loopActive) {
+        if (m_playhead >= m_loopStart) lo = m_loopStart;
+        if (m_playhead < m_loopEnd) hi = m_loopEnd;
+    }
+}
+
+int ScratchBuffer::framesToEdge(const int64_t* increments, int frames, int64_t peakIncrement, int64_t lo, int64_t hi, int* edge) const {
+    // Nearly every block is nowhere near an edge: one test for the block
+    int64_t pos = m_playhead;
+    int64_t reach = peakIncrement * frames;
+    if (pos + reach < hi && pos - reach >= lo) return frames;
+    for (int i = 0; i < frames; ++i) {
+        pos += increments[i];
+        if (pos >= hi) {
+            *edge = 1;
+            return i + 1;
+        }
+        if (pos < lo) {
+            *edge = -1;
+            return i + 1;
+        }
+    }
+    return frames;
+}
+
+void ScratchBuffer::renderSpan(const DecodedTrack& track, float* left, float* right, int frames, int64_t peakIncrement, int mode) {
+    // Render up to the next loop or track edge, then wrap or stop and carry
+    // on; a block is split only where the play head actually crosses
+    int done = 0;
+    while (done < frames) {
+        int64_t lo, hi;
+        edges(track, lo, hi);
+        int edge = 0;
+        const int64_t* increments = m_increments + done;
+        int n = framesToEdge(increments, frames - done, peakIncrement, lo, hi, &edge);
+
+        int64_t start = m_playhead;
+        m_playhead = renderVariable(track, left + done, right + done, n, increments, start, peakIncrement, mode);
+        if (m_seamRemaining > 0) {
+            int k = std::min(n, m_seamRemaining);
+            renderVariable(track, m_seamLeft, m_seamRight, k, increments, start + m_seamOffset, peakIncrement, mode);
+            mixSeam(left + done, right + done, m_seamLeft, m_seamRight, k);
+        }
+        done += n;
+        if (edge == 0) continue;
+
+        bool loopEdge = m_loopActive && (edge > 0 ? hi == m_loopEnd : lo == m_loopStart);
+        if (loopEdge) {
+            int64_t length = m_loopEnd - m_loopStart;
+            jumpWithSeam(m_playhead + (edge > 0 ? -length : length));
         } else {
-            left[i] = 0.0f;
-            right[i] = 0.0f;
+            // Ran off the track: park at the end and stop
+            m_playhead = edge > 0 ? hi : 0;
+            m_isPlaying = false;
+            m_audible = false;
+            m_seamRemaining = 0;
+            std::fill(left + done, left + frames, 0.0f);
+            std::fill(right + done, right + frames, 0.0f);
+            break;
+        }
+    }
+}
+
+void ScratchBuffer::mixSeam(float* left, float* right, const float* tailLeft, const float* tailRight, int frames) {
+    const float* gain = seamGain();
+    int progress = m_seamLength - m_seamRemaining;
+    for (int i = 0; i < frames; ++i) {
+        int g = (progress + i) * kSeamGainPoints / m_seamLength;
+        float in = gain[g];
+        float out = gain[kSeamGainPoints - 1 - g];
+        left[i] = left[i] * in + tailLeft[i] * out;
+        right[i] = right[i] * in + tailRight[i] * out;
+    }
+    m_seamRemaining -= frames;
+}
+
+void ScratchBuffer::jumpWithSeam(int64_t target) {
+    // Keep the audio we jumped away from running underneath and fade it out
+    m_seamOffset = m_playhead - target;
+    m_playhead = target;
+    m_seamLength = kSeamFrames;
+    if (m_loopActive) {
+        int64_t loopFrames = (m_loopEnd - m_loopStart) >> kFixedShift;
+        m_seamLength = (int)std::max<int64_t>(1, std::min<int64_t>(kSeamFrames, loopFrames / 2));
+    }
+    m_seamRemaining = m_seamLength;
+}
+
+int64_t ScratchBuffer::renderVariable(const DecodedTrack& track, float* left, float* right, int frames, const int64_t* increments,
+                                      int64_t pos, int64_t peak, int mode) {
+    if (!track.planar) return renderKernel(track, left, right, frames, increments, pos, peak, mode);
+    // A stem track is read through the mix window, so cut the span into
+    // pieces whose reach (either way, plus kernel taps) fits inside it
+    int64_t rate = (peak >> kFixedShift) + 1;
+    int piece = (int)std::max<int64_t>(1, (kStemWindowFrames - 32) / (2 * rate) - 1);
+    for (int done = 0; done < frames; done += piece) {
+        int n = std::min(piece, frames - done);
+        pos = renderKernel(track, left + done, right + done, n, increments + done, pos, peak, mode);
+    }
+    return pos;
+}
+
+int64_t ScratchBuffer::renderKernel(const DecodedTrack& track, float* left, float* right, int frames, const int64_t* increments,
+                                    int64_t pos, int64_t peak, int mode) {
+    bool stereo = track.channels == 2 || track.planar;
+    if (mode == INTERP_LINEAR) {
+        if (stereo) return renderInterpolated<LinearInterp, 2>(track, left, right, frames, increments, pos, peak);
+        return renderInterpolated<LinearInterp, 1>(track, left, right, frames, increments, pos, peak);
+    }
+    if (mode == INTERP_SINC) {
+        // Lower the sinc cutoff by an octave for each doubling of the rate so
+        // reading faster than 1x can't fold content back below Nyquist
+        if (peak <= kFixedOne) {
+            if (stereo) return renderInterpolated<SincInterp<0>, 2>(track, left, right, frames, increments, pos, peak);
+            return renderInterpolated<SincInterp<0>, 1>(track, left, right, frames, increments, pos, peak);
+        }
+        if (peak <= 2 * kFixedOne) {
+            if (stereo) return renderInterpolated<SincInterp<1>, 2>(track, left, right, frames, increments, pos, peak);
+            return renderInterpolated<SincInterp<1>, 1>(track, left, right, frames, increments, pos, peak);
+        }
+        if (peak <= 4 * kFixedOne) {
+            if (stereo) return renderInterpolated<SincInterp<2>, 2>(track, left, right, frames, increments, pos, peak);
+            return renderInterpolated<SincInterp<2>, 1>(track, left, right, frames, increments, pos, peak);
+        }
+        if (stereo) return renderInterpolated<SincInterp<3>, 2>(track, left, right, frames, increments, pos, peak);
+        return renderInterpolated<SincInterp<3>, 1>(track, left, right, frames, increments, pos, peak);
+    }
+    if (stereo) return renderInterpolated<HermiteInterp, 2>(track, left, right, frames, increments, pos, peak);
+    return renderInterpolated<HermiteInterp, 1>(track, left, right, frames, increments, pos, peak);
+}
+
+template <class Kernel, int Channels>
+int64_t ScratchBuffer::renderInterpolated(const DecodedTrack& track, float* left, float* right, int frames, const int64_t* increments,
+                                          int64_t pos, int64_t peakIncrement) {
+    const int64_t length = track.length;
+
+    // One bounds check per span: if every tap we could touch is inside the
+    // track, read straight from it; otherwise gather taps, silent outside.
+    int64_t reach = (peakIncrement >> kFixedShift) * frames + frames + 1;
+    int64_t first = (pos >> kFixedShift) - reach - Kernel::kBefore;
+    int64_t last = (pos >> kFixedShift) + reach + (Kernel::kTaps - Kernel::kBefore);
+    bool inside = first >= 0 && last < length;
+    Source src = source(track, first, last);
+    const float* data = src.data;
+
+    float w[Kernel::kTaps];
+    if (inside) {
+        for (int i = 0; i < frames; ++i) {
+            Kernel::weights((uint32_t)pos, w);
+            const float* p = data + ((pos >> kFixedShift) - Kernel::kBefore - src.first) * Channels;
+            if (Channels == 1) {
+                left[i] = right[i] = applyTaps<Kernel::kTaps>(p, 1, w);
+            } else {
+                left[i] = applyTaps<Kernel::kTaps>(p, 2, w);
+                right[i] = applyTaps<Kernel::kTaps>(p + 1, 2, w);
+            }
+            pos += increments[i];
+        }
+    } else {
+        float taps[Channels][Kernel::kTaps];
+        for (int i = 0; i < frames; ++i) {
+            Kernel::weights((uint32_t)pos, w);
+            int64_t base = (pos >> kFixedShift) - Kernel::kBefore;
+            for (int t = 0; t < Kernel::kTaps; ++t) {
+                int64_t idx = base + t;
+                bool valid = idx >= 0 && idx < length;
+                for (int ch = 0; ch < Channels; ++ch) {
+                    taps[ch][t] = valid ? data[(idx - src.first) * Channels + ch] : 0.0f;
+                }
+            }
+            left[i] = applyTaps<Kernel::kTaps>(taps[0], 1, w);
+            right[i] = applyTaps<Kernel::kTaps>(taps[Channels - 1], 1, w);
+            pos += increments[i];
+        }
+    }
+    return pos;
+}
+
+void ScratchBuffer::renderShifted(const DecodedTrack& track, float* left, float* right, int frames, double speed, double pitch) {
+    auto start = std::chrono::steady_clock::now();
+    int mode = m_keyLockMode.load(std::memory_order_relaxed);
+
+    // The shifter sees the source at 1x (reversed when playing backwards)
+    // and consumes it at |speed| per output frame
+    int direction = speed >= 0 ? 1 : -1;
+    auto readSource = [&](float* l, float* r, int n) { readSourceFrames(track, l, r, n, direction); };
+    if (!m_stretchActive || m_shifter->getMode() != mode) {
+        // Coming in from varispeed, crossfade from what it would have played
+        // next: the shifter comes out in level with it but, once it searches
+        // or shifts, not in phase. A transport change already fading wins.
+        int length = m_transportFadeFrames.load(std::memory_order_relaxed);
+        if (!m_stretchActive && m_fadeRemaining == 0 && length > 0) {
+            int64_t playhead = m_playhead;
+            renderTail(track, m_fadeLeft, m_fadeRight, length);
+            m_playhead = playhead;
+            m_fadeLength = length;
+            m_fadeRemaining = length;
+            m_fadeCorrelation = -2.0f;   // measured once the shifter has rendered
+        }
+        // The shifter starts empty; back up and pre-roll it so the play head
+        // comes out at full level instead of fading in over the first hops
+        m_shifter->setMode((TimeStretcher::Mode)mode);
+        m_playhead -= (int64_t)direction * m_shifter->prerollFrames(std::abs(speed), pitch) * kFixedOne;
+        m_shifter->preroll(std::abs(speed), pitch, readSource);
+        m_stretchActive = true;
+    }
+    m_shiftSpeed = speed;
+    m_shiftPitch = pitch;
+    m_shifter->render(left, right, frames, std::abs(speed), pitch, readSource);
+    if (m_fadeCorrelation == -2.0f) {
+        // Anywhere from in phase (key-lock at 1x) to opposed; the fade keeps
+        // constant power either way
+        int n = std::min(frames, m_fadeRemaining);
+        double cross = 0.0, tail = 1e-12, shifted = 1e-12;
+        for (int i = 0; i < n; ++i) {
+            cross += m_fadeLeft[i] * left[i] + m_fadeRight[i] * right[i];
+            tail += m_fadeLeft[i] * m_fadeLeft[i] + m_fadeRight[i] * m_fadeRight[i];
+            shifted += left[i] * left[i] + right[i] * right[i];
+        }
+        m_fadeCorrelation = (float)std::max(-0.9, std::min(1.0, cross / std::sqrt(tail * shifted)));
+    }
+
+    // Hop-based work is bursty, so publish a smoothed share of the block time
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    float load = (float)(elapsed * 44100.0 / frames);
+    publishShiftLoad(m_shiftLoad + 0.05f * (load - m_shiftLoad));
+}
+
+void ScratchBuffer::publishShiftLoad(float load) {
+    m_shiftLoad = load;
+    if (m_statsSlot >= 0 && m_statsSlot < EngineStats::kMaxDecks) {
+        engineStats().deckShiftLoad[m_statsSlot].store(load, std::memory_order_relaxed);
+    }
+}
+
+void ScratchBuffer::copySourceFrames(const DecodedTrack& track, float* left, float* right, int frames, int64_t frame, int direction) {
+    const int64_t length = track.length;
+    for (int done = 0; done < frames; ) {
+        int n = std::min(frames - done, kStemWindowFrames);
+        int64_t end = frame + (int64_t)direction * (n - 1);
+        Source src = source(track, std::min(frame, end), std::max(frame, end));
+        for (int i = done; i < done + n; ++i) {
+            if (frame < 0 || frame >= length) {
+                left[i] = right[i] = 0.0f;
+            } else {
+                const float* p = src.data + (frame - src.first) * src.channels;
+                left[i] = p[0];
+                right[i] = p[src.channels - 1];
+            }
+            frame += direction;
+        }
+        done += n;
+    }
+}
+
+ScratchBuffer::Source ScratchBuffer::source(const DecodedTrack& track, int64_t first, int64_t last) {
+    if (!track.planar) return {track.samples.data(), track.channels, 0};
+    first = std::max<int64_t>(0, first);
+    last = std::min<int64_t>(track.length - 1, last);
+    int frames = (int)std::max<int64_t>(0, std::min<int64_t>(kStemWindowFrames, last - first + 1));
+
+    // The stem downmix: per stem one multiply-add per sample over planar
+    // runs, constant gain when settled and a clamped ramp while moving
+    std::fill(m_stemLeft, m_stemLeft + frames, 0.0f);
+    std::fill(m_stemRight, m_stemRight + frames, 0.0f);
+    const int stems = std::min(track.stems(), (int)kMaxStems);
+    for (int s = 0; s < stems; ++s) {
+        float from = m_stemFrom[s];
+        float to = m_stemTo[s];
+        if (from == 0.0f && to == 0.0f) continue;
+        const float* l = track.channel(2 * s) + first;
+        const float* r = track.channel(std::min(2 * s + 1, track.channels - 1)) + first;
+        if (from == to) {
+            for (int i = 0; i < frames; ++i) {
+                m_stemLeft[i] += from * l[i];
+                m_stemRight[i] += from * r[i];
+            }
+        } else {
+            float t0 = (float)(((double)first - m_stemRampBase) * m_stemRampScale);
+            float dt = (float)m_stemRampScale;
+            float span = to - from;
+            for (int i = 0; i < frames; ++i) {
+                float t = std::min(1.0f, std::max(0.0f, t0 + dt * i));
+                float gain = from + span * t;
+                m_stemLeft[i] += gain * l[i];
+                m_stemRight[i] += gain * r[i];
+            }
         }
     }
+    for (int i = 0; i < frames; ++i) {
+        m_stemWindow[i * 2] = m_stemLeft[i];
+        m_stemWindow[i * 2 + 1] = m_stemRight[i];
+    }
+    return {m_stemWindow, 2, first};
+}
 
-    m_currentFrame += frames;
+void ScratchBuffer::updateStemGains(const DecodedTrack* track, int frames) {
+    // Move each stem toward its target, at most full scale per ~12 ms, and
+    // ramp it across the source frames this block's play head will cover
+    static constexpr float kRampFrames = 512.0f;
+    float step = frames / kRampFrames;
+    const int stems = std::min(track->stems(), (int)kMaxStems);
+    for (int s = 0; s < stems; ++s) {
+        float target = m_stemMute[s].load(std::memory_order_relaxed) ? 0.0f : m_stemGain[s].load(std::memory_order_relaxed);
+        m_stemFrom[s] = m_stemTo[s];
+        m_stemTo[s] = m_stemFrom[s] + std::max(-step, std::min(step, target - m_stemFrom[s]));
+    }
+    double rate = fromFixed(m_increment);
+    double covered = std::max(1.0, std::abs(rate) * frames);
+    m_stemRampBase = fromFixed(m_playhead);
+    m_stemRampScale = (rate < 0.0 ? -1.0 : 1.0) / covered;
+}
+
+void ScratchBuffer::readSourceFrames(const DecodedTrack& track, float* left, float* right, int frames, int direction) {
+    // Whole frames at 1x; past either end of the track reads silence. Loop
+    // edges split the read once and wrap with the same seam crossfade.
+    int done = 0;
+    while (done < frames) {
+        int n = frames - done;
+        bool wrap = false;
+        if (m_loopActive) {
+            int64_t room = -1;
+            if (direction > 0 && m_playhead < m_loopEnd) room = (m_loopEnd - m_playhead + kFixedOne - 1) >> kFixedShift;
+            if (direction < 0 && m_playhead >= m_loopStart) room = ((m_playhead - m_loopStart) >> kFixedShift) + 1;
+            if (room >= 0 && room <= n) {
+                n = (int)std::max<int64_t>(1, room);
+                wrap = true;
+            }
+        }
+
+        copySourceFrames(track, left + done, right + done, n, m_playhead >> kFixedShift, direction);
+        if (m_seamRemaining > 0) {
+            int k = std::min(n, m_seamRemaining);
+            copySourceFrames(track, m_seamLeft, m_seamRight, k, (m_playhead + m_seamOffset) >> kFixedShift, direction);
+            mixSeam(left + done, right + done, m_seamLeft, m_seamRight, k);
+        }
+        m_playhead += (int64_t)direction * n * kFixedOne;
+        done += n;
+
+        if (wrap) {
+            int64_t length = m_loopEnd - m_loopStart;
+            jumpWithSeam(m_playhead + (direction > 0 ? -length : length));
+        }
+    }
 }
 
 void ScratchBuffer::play() {
@@ -295,19 +1239,509 @@ void ScratchBuffer::pause() {
 }
 
 void ScratchBuffer::seek(long frame) {
-    m_currentFrame = frame;
+    m_seekTarget.store((int64_t)frame << kFixedShift, std::memory_order_relaxed);
+    m_seekPending.store(true, std::memory_order_release);
+    m_position.store((int64_t)frame << kFixedShift, std::memory_order_relaxed);
     std::cout << "[ScratchBuffer] Seek to frame " << frame << std::endl;
 }
 
+void ScratchBuffer::setTransportFade(double ms) {
+    ms = std::max(0.0, std::min(5.0, ms));
+    m_transportFadeFrames = (int)std::lround(ms * 44.1);
+    std::cout << "[ScratchBuffer] Transport fade set to " << ms << " ms" << std::endl;
+}
+
+double ScratchBuffer::getTransportFade() const {
+    return m_transportFadeFrames.load(std::memory_order_relaxed) / 44.1;
+}
+
 void ScratchBuffer::setSpeed(double ratio) {
+    ratio = std::max(-2.0, std::min(2.0, ratio));
     m_speed = ratio;
     std::cout << "[ScratchBuffer] Speed set to " << ratio << std::endl;
 }
 
+double ScratchBuffer::getSpeed() const {
+    return m_speed.load(std::memory_order_relaxed);
+}
+
+void ScratchBuffer::setInterpolation(int mode) {
+    if (mode < INTERP_LINEAR || mode > INTERP_SINC) mode = INTERP_HERMITE;
+    m_interpolation = mode;
+    std::cout << "[ScratchBuffer] Interpolation set to " << mode << std::endl;
+}
+
+void ScratchBuffer::setKeyLock(bool enabled) {
+    m_keyLock = enabled;
+    std::cout << "[ScratchBuffer] Key-lock " << (enabled ? "enabled" : "disabled") << std::endl;
+}
+
+void ScratchBuffer::setKeyLockMode(int mode) {
+    if (mode != TimeStretcher::WSOLA && mode != TimeStretcher::PHASE_VOCODER) mode = TimeStretcher::WSOLA;
+    m_keyLockMode = mode;
+    std::cout << "[ScratchBuffer] Key-lock mode set to " << mode << std::endl;
+}
+
+bool ScratchBuffer::getKeyLock() const {
+    return m_keyLock.load(std::memory_order_relaxed);
+}
+
+double ScratchBuffer::getKeyLockLatencyMs() const {
+    if (!m_keyLock.load(std::memory_order_relaxed) && m_keyShift.load(std::memory_order_relaxed) == 0.0) return 0.0;
+    return TimeStretcher::latencyFrames((TimeStretcher::Mode)m_keyLockMode.load(std::memory_order_relaxed)) * 1000.0 / 44100.0;
+}
+
+void ScratchBuffer::setKeyShift(double semitones) {
+    semitones = std::max(-12.0, std::min(12.0, semitones));
+    m_keyShift = semitones;
+    std::cout << "[ScratchBuffer] Key shift set to " << semitones << " semitones" << std::endl;
+}
+
+double ScratchBuffer::getKeyShift() const {
+    return m_keyShift.load(std::memory_order_relaxed);
+}
+
+// Jog reports can arrive at 1 kHz, so these don't log
+void ScratchBuffer::jogTouch(bool touched) {
+    m_platter.post({touched ? JogEvent::TOUCH : JogEvent::RELEASE, 0.0, 0.0, steadyNowNs()});
+}
+
+void ScratchBuffer::jogPosition(double seconds) {
+    m_platter.post({JogEvent::POSITION, seconds, 0.0, steadyNowNs()});
+}
+
+void ScratchBuffer::jogVelocity(double ratio) {
+    m_platter.post({JogEvent::VELOCITY, ratio, 0.0, steadyNowNs()});
+}
+
+void ScratchBuffer::brake(double seconds) {
+    m_platter.post({JogEvent::BRAKE, seconds, 0.0, steadyNowNs()});
+    std::cout << "[ScratchBuffer] Brake over " << seconds << "s" << std::endl;
+}
+
+void ScratchBuffer::spinback(double speed, double seconds) {
+    m_platter.post({JogEvent::SPINBACK, speed, seconds, steadyNowNs()});
+    std::cout << "[ScratchBuffer] Spinback at " << speed << "x over " << seconds << "s" << std::endl;
+}
+
+void ScratchBuffer::setPlatterInertia(double seconds) {
+    m_platter.post({JogEvent::INERTIA, seconds, 0.0, steadyNowNs()});
+    std::cout << "[ScratchBuffer] Platter inertia set to " << seconds << "s" << std::endl;
+}
+
+void ScratchBuffer::post(DeckCommand::Type type, double a, double b) {
+    if (!m_commands.push({type, a, b})) {
+        std::cout << "[ScratchBuffer] Command queue full, dropped command " << type << std::endl;
+    }
+}
+
+void ScratchBuffer::applyCommands(const DecodedTrack* track) {
+    DeckCommand command;
+    while (m_commands.pop(command)) {
+        applyCommand(command, track);
+    }
+}
+
+void ScratchBuffer::applyCommand(const DeckCommand& command, const DecodedTrack* track) {
+    static constexpr int64_t kMinLoop = (int64_t)32 << kFixedShift;
+    const int64_t lengthFixed = track ? track->length << kFixedShift : 0;
+    // Loop points follow what is audible, on whole frames
+    const int64_t here = m_position.load(std::memory_order_relaxed) & ~(kFixedOne - 1);
+    const double framesPerBeat = m_grid.valid() ? m_grid.framesPerBeat() : 44100.0 * 60.0 / 120.0;
+    auto beatLoopFrom = [&](double beats) {
+        // Start on the last grid line (at the loop's own length for sub-beat
+        // loops) so the loop lands on the beat without moving the play head
+        int64_t in = here;
+        if (m_grid.valid()) in = (int64_t)std::llround(m_grid.snapBack(fromFixed(here), std::min(beats, 1.0))) << kFixedShift;
+        int64_t length = std::max(kMinLoop, (int64_t)std::llround(beats * framesPerBeat) << kFixedShift);
+        in = std::max<int64_t>(0, in);
+        setLoopPoints(in, std::min(lengthFixed, in + length), true);
+        foldIntoLoop();
+    };
+
+    switch (command.type) {
+    case DeckCommand::TRACK_LOADED:
+        m_grid = BeatGrid();
+        m_loopActive = false;
+        m_loopSet = false;
+        m_loopStart = m_loopEnd = -1;
+        m_rollActive = false;
+        m_slipping = false;
+        m_cueHeld = false;
+        m_seamRemaining = 0;
+        publishLoop();
+        break;
+    case DeckCommand::BEAT_GRID:
+        m_grid.bpm = command.a;
+        m_grid.firstBeat = command.b;
+        break;
+    case DeckCommand::LOOP_IN:
+        m_loopStart = here;
+        m_loopEnd = -1;
+        m_loopSet = false;
+        m_loopActive = false;
+        publishLoop();
+        break;
+    case DeckCommand::LOOP_OUT:
+        if (m_loopStart >= 0 && here - m_loopStart >= kMinLoop) {
+            setLoopPoints(m_loopStart, here, true);
+            foldIntoLoop();
+        }
+        break;
+    case DeckCommand::LOOP_SET: {
+        int64_t in = (int64_t)command.a << kFixedShift;
+        int64_t out = std::min(lengthFixed, (int64_t)command.b << kFixedShift);
+        if (in >= 0 && out - in >= kMinLoop) setLoopPoints(in, out, true);
+        break;
+    }
+    case DeckCommand::BEAT_LOOP:
+        if (command.a > 0.0 && track) beatLoopFrom(command.a);
+        break;
+    case DeckCommand::LOOP_ROLL:
+        if (command.a <= 0.0 || !track) break;
+        if (!m_rollActive) {
+            // Remember the loop the roll replaces and where playback would be
+            m_rollRestoreLoop = m_loopSet;
+            m_rollRestoreActive = m_loopActive;
+            m_rollRestoreStart = m_loopStart;
+            m_rollRestoreEnd = m_loopEnd;
+            beginSlip(audiblePosition());
+            m_rollActive = true;
+        }
+        beatLoopFrom(command.a);
+        break;
+    case DeckCommand::LOOP_ROLL_RELEASE:
+        if (!m_rollActive) break;
+        m_rollActive = false;
+        m_loopSet = m_rollRestoreLoop;
+        m_loopActive = m_rollRestoreActive;
+        m_loopStart = m_rollRestoreStart;
+        m_loopEnd = m_rollRestoreEnd;
+        publishLoop();
+        if (!m_slip.load(std::memory_order_relaxed)) {
+            // Without slip mode only the roll tracks the shadow
+            m_slipping = false;
+            jumpWithSeam(std::max<int64_t>(0, std::min(lengthFixed, m_slipShadow)));
+        }
+        break;
+    case DeckCommand::LOOP_HALVE:
+        if (m_loopSet && (m_loopEnd - m_loopStart) / 2 >= kMinLoop) {
+            setLoopPoints(m_loopStart, m_loopStart + ((m_loopEnd - m_loopStart) / 2 & ~(kFixedOne - 1)), m_loopActive);
+            foldIntoLoop();
+        }
+        break;
+    case DeckCommand::LOOP_DOUBLE:
+        if (m_loopSet && m_loopStart + 2 * (m_loopEnd - m_loopStart) <= lengthFixed) {
+            setLoopPoints(m_loopStart, m_loopStart + 2 * (m_loopEnd - m_loopStart), m_loopActive);
+        }
+        break;
+    case DeckCommand::LOOP_EXIT:
+        m_loopActive = false;
+        publishLoop();
+        break;
+    case DeckCommand::RELOOP:
+        if (m_loopSet) {
+            m_loopActive = true;
+            publishLoop();
+            jumpWithSeam(m_loopStart);
+        }
+        break;
+    case DeckCommand::JUMP_HOT_CUE: {
+        int64_t cue = m_hotCues[(int)command.a].load(std::memory_order_relaxed);
+        if (cue < 0 || !track || cue >= track->length) break;
+        int64_t target = cue << kFixedShift;
+        if (m_quantize.load(std::memory_order_relaxed) && m_grid.valid()) {
+            // Land as far into the cue's beat as we are into the current one:
+            // the jump stays immediate and the deck stays on the beat
+            double now = fromFixed(m_position.load(std::memory_order_relaxed));
+            target += toFixed(now - m_grid.snapBack(now, 1.0));
+        }
+        if (m_loopActive && (target < m_loopStart || target >= m_loopEnd)) {
+            m_loopActive = false;
+            publishLoop();
+        }
+        if (m_slip.load(std::memory_order_relaxed)) {
+            // Playback returns to the shadow when the cue is released
+            beginSlip(audiblePosition());
+            m_cueHeld = true;
+        }
+        // Restart key-lock at the cue so its read-ahead doesn't delay the jump
+        m_stretchActive = false;
+        jumpWithSeam(target);
+        break;
+    }
+    case DeckCommand::HOT_CUE_RELEASE:
+        m_cueHeld = false;
+        break;
+    case DeckCommand::PLAY:
+        if (track) m_isPlaying = true;
+        break;
+    case DeckCommand::PAUSE:
+        m_isPlaying = false;
+        break;
+    case DeckCommand::SEEK: {
+        int64_t target = std::max<int64_t>(0, std::min(lengthFixed, (int64_t)command.a << kFixedShift));
+        m_seekTarget.store(target, std::memory_order_relaxed);
+        m_seekPending.store(true, std::memory_order_relaxed);
+        m_position.store(target, std::memory_order_relaxed);
+        break;
+    }
+    case DeckCommand::CANCEL_SCHEDULED:
+        break;
+    }
+}
+
+void ScratchBuffer::setLoopPoints(int64_t in, int64_t out, bool active) {
+    m_loopStart = in;
+    m_loopEnd = out;
+    m_loopSet = true;
+    m_loopActive = active;
+    publishLoop();
+}
+
+void ScratchBuffer::foldIntoLoop() {
+    // A loop that ends behind the read head (a short loop, or key-lock's
+    // read-ahead) wraps it back in right away
+    if (!m_loopActive || m_playhead < m_loopEnd) return;
+    int64_t length = m_loopEnd - m_loopStart;
+    jumpWithSeam(m_loopStart + (m_playhead - m_loopStart) % length);
+}
+
+void ScratchBuffer::publishLoop() {
+    m_loopInFrame.store(m_loopStart >= 0 ? m_loopStart >> kFixedShift : -1, std::memory_order_relaxed);
+    m_loopOutFrame.store(m_loopSet ? m_loopEnd >> kFixedShift : -1, std::memory_order_relaxed);
+    m_loopActivePublished.store(m_loopActive, std::memory_order_relaxed);
+}
+
+void ScratchBuffer::setBeatGrid(double bpm, double firstBeatSeconds) {
+    {
+        std::lock_guard<std::mutex> cueLock(m_cueMutex);
+        m_controlGrid.bpm = std::max(0.0, bpm);
+        m_controlGrid.firstBeat = firstBeatSeconds * 44100.0;
+    }
+    post(DeckCommand::BEAT_GRID, std::max(0.0, bpm), firstBeatSeconds * 44100.0);
+    std::cout << "[ScratchBuffer] Beat grid set to " << bpm << " BPM from " << firstBeatSeconds << "s" << std::endl;
+}
+
+void ScratchBuffer::loopIn() {
+    post(DeckCommand::LOOP_IN);
+    std::cout << "[ScratchBuffer] Loop in" << std::endl;
+}
+
+void ScratchBuffer::loopOut() {
+    post(DeckCommand::LOOP_OUT);
+    std::cout << "[ScratchBuffer] Loop out" << std::endl;
+}
+
+void ScratchBuffer::setLoop(int64_t inFrame, int64_t outFrame) {
+    post(DeckCommand::LOOP_SET, (double)inFrame, (double)outFrame);
+    std::cout << "[ScratchBuffer] Loop set to frames " << inFrame << "-" << outFrame << std::endl;
+}
+
+void ScratchBuffer::beatLoop(double beats) {
+    post(DeckCommand::BEAT_LOOP, beats);
+    std::cout << "[ScratchBuffer] Beat loop of " << beats << " beats" << std::endl;
+}
+
+void ScratchBuffer::loopRoll(double beats) {
+    post(DeckCommand::LOOP_ROLL, beats);
+    std::cout << "[ScratchBuffer] Loop roll of " << beats << " beats" << std::endl;
+}
+
+void ScratchBuffer::loopRollRelease() {
+    post(DeckCommand::LOOP_ROLL_RELEASE);
+    std::cout << "[ScratchBuffer] Loop roll released" << std::endl;
+}
+
+void ScratchBuffer::loopHalve() {
+    post(DeckCommand::LOOP_HALVE);
+    std::cout << "[ScratchBuffer] Loop halved" << std::endl;
+}
+
+void ScratchBuffer::loopDouble() {
+    post(DeckCommand::LOOP_DOUBLE);
+    std::cout << "[ScratchBuffer] Loop doubled" << std::endl;
+}
+
+void ScratchBuffer::loopExit() {
+    post(DeckCommand::LOOP_EXIT);
+    std::cout << "[ScratchBuffer] Loop exit" << std::endl;
+}
+
+void ScratchBuffer::reloop() {
+    post(DeckCommand::RELOOP);
+    std::cout << "[ScratchBuffer] Reloop" << std::endl;
+}
+
+int64_t ScratchBuffer::getLoopIn() const {
+    return m_loopInFrame.load(std::memory_order_relaxed);
+}
+
+int64_t ScratchBuffer::getLoopOut() const {
+    return m_loopOutFrame.load(std::memory_order_relaxed);
+}
+
+bool ScratchBuffer::isLoopActive() const {
+    return m_loopActivePublished.load(std::memory_order_relaxed);
+}
+
+void ScratchBuffer::pinCueWindow(const DecodedTrack& track, int64_t frame, bool pin) {
+    // A second before the cue (reverse, scratching, kernel taps) and ten after
+    static constexpr int64_t kBefore = 44100;
+    static constexpr int64_t kAfter = 44100 * 10;
+    if (track.pinCount.load() > 0) return; // the whole track is locked already
+    int64_t start = std::max<int64_t>(0, frame - kBefore);
+    int64_t end = std::min<int64_t>(track.length, frame + kAfter);
+    if (end <= start) return;
+    if (track.planar) {
+        // One run per channel
+        for (int ch = 0; ch < track.channels; ++ch) {
+            const float* ptr = track.channel(ch) + start;
+            size_t bytes = (size_t)(end - start) * sizeof(float);
+            if (pin) TrackMemory::pin(ptr, bytes);
+            else TrackMemory::unpin(ptr, bytes);
+        }
+        return;
+    }
+    const float* ptr = track.samples.data() + start * track.channels;
+    size_t bytes = (size_t)(end - start) * track.channels * sizeof(float);
+    if (pin) TrackMemory::pin(ptr, bytes);
+    else TrackMemory::unpin(ptr, bytes);
+}
+
+void ScratchBuffer::releaseCueWindow(int64_t frame) {
+    // mlock isn't counted, so unlocking one window can release pages another
+    // cue shares; lock the remaining windows again afterwards
+    pinCueWindow(*m_track, frame, false);
+    for (auto& cue : m_hotCues) {
+        int64_t other = cue.load(std::memory_order_relaxed);
+        if (other >= 0) pinCueWindow(*m_track, other, true);
+    }
+}
+
+void ScratchBuffer::setHotCue(int index, double seconds) {
+    if (index < 0 || index >= kMaxHotCues) return;
+    std::lock_guard<std::mutex> cueLock(m_cueMutex);
+    if (!m_track) return;
+    int64_t frame = seconds >= 0.0 ? std::llround(seconds * 44100.0) : m_position.load(std::memory_order_relaxed) >> kFixedShift;
+    if (m_quantize.load(std::memory_order_relaxed) && m_controlGrid.valid()) {
+        frame = std::llround(m_controlGrid.frameAt(std::round(m_controlGrid.beatAt((double)frame))));
+    }
+    frame = std::max<int64_t>(0, std::min<int64_t>(m_track->length - 1, frame));
+    int64_t previous = m_hotCues[index].exchange(frame, std::memory_order_relaxed);
+    if (previous >= 0) releaseCueWindow(previous);
+    else pinCueWindow(*m_track, frame, true);
+    std::cout << "[ScratchBuffer] Hot cue " << index << " set at " << frame / 44100.0 << "s" << std::endl;
+}
+
+void ScratchBuffer::clearHotCue(int index) {
+    if (index < 0 || index >= kMaxHotCues) return;
+    std::lock_guard<std::mutex> cueLock(m_cueMutex);
+    int64_t previous = m_hotCues[index].exchange(-1, std::memory_order_relaxed);
+    if (previous >= 0 && m_track) releaseCueWindow(previous);
+    std::cout << "[ScratchBuffer] Hot cue " << index << " cleared" << std::endl;
+}
+
+void ScratchBuffer::jumpToHotCue(int index) {
+    if (index < 0 || index >= kMaxHotCues) return;
+    post(DeckCommand::JUMP_HOT_CUE, index);
+    std::cout << "[ScratchBuffer] Jump to hot cue " << index << std::endl;
+}
+
+double ScratchBuffer::getHotCue(int index) const {
+    if (index < 0 || index >= kMaxHotCues) return -1.0;
+    int64_t frame = m_hotCues[index].load(std::memory_order_relaxed);
+    return frame >= 0 ? frame / 44100.0 : -1.0;
+}
+
+void ScratchBuffer::releaseHotCue() {
+    post(DeckCommand::HOT_CUE_RELEASE);
+}
+
+void ScratchBuffer::setSlip(bool enabled) {
+    m_slip = enabled;
+    std::cout << "[ScratchBuffer] Slip " << (enabled ? "enabled" : "disabled") << std::endl;
+}
+
+bool ScratchBuffer::getSlip() const {
+    return m_slip.load(std::memory_order_relaxed);
+}
+
+void ScratchBuffer::setReverse(bool enabled) {
+    m_reverse = enabled;
+    std::cout << "[ScratchBuffer] Reverse " << (enabled ? "on" : "off") << std::endl;
+}
+
+double ScratchBuffer::getSlipPosition() const {
+    int64_t shadow = m_slipPosition.load(std::memory_order_relaxed);
+    return shadow >= 0 ? fromFixed(shadow) / 44100.0 : -1.0;
+}
+
+bool ScratchBuffer::schedule(int action, double value, int timeBase, double time) {
+    DeckCommand command{DeckCommand::PLAY, 0.0, 0.0};
+    switch (action) {
+    case ACTION_PLAY: command.type = DeckCommand::PLAY; break;
+    case ACTION_PAUSE: command.type = DeckCommand::PAUSE; break;
+    case ACTION_CUE: command = {DeckCommand::SEEK, std::floor(value * 44100.0), 0.0}; break;
+    case ACTION_HOT_CUE:
+        if (value < 0 || value >= kMaxHotCues) return false;
+        command = {DeckCommand::JUMP_HOT_CUE, std::floor(value), 0.0};
+        break;
+    case ACTION_BEAT_LOOP: command = {DeckCommand::BEAT_LOOP, value, 0.0}; break;
+    case ACTION_LOOP_EXIT: command.type = DeckCommand::LOOP_EXIT; break;
+    case ACTION_RELOOP: command.type = DeckCommand::RELOOP; break;
+    default: return false;
+    }
+    if (timeBase < SCHEDULE_FRAME || timeBase > SCHEDULE_NEXT_BEATS) return false;
+    if (!m_scheduleQueue.push({command, timeBase, time})) {
+        std::cout << "[ScratchBuffer] Schedule queue full, action dropped" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void ScratchBuffer::cancelScheduled() {
+    m_scheduleQueue.push({{DeckCommand::CANCEL_SCHEDULED, 0.0, 0.0}, SCHEDULE_FRAME, 0.0});
+}
+
+void ScratchBuffer::setMasterClock(const MasterClock* clock) {
+    m_clock = clock;
+}
+
+void ScratchBuffer::setSync(bool enabled) {
+    m_sync = enabled;
+    std::cout << "[ScratchBuffer] Sync " << (enabled ? "enabled" : "disabled") << std::endl;
+}
+
+bool ScratchBuffer::getSync() const {
+    return m_sync.load(std::memory_order_relaxed);
+}
+
+void ScratchBuffer::setSyncLeader(bool leader) {
+    m_syncLeader = leader;
+}
+
+int ScratchBuffer::getSyncState() const {
+    return m_syncState.load(std::memory_order_relaxed);
+}
+
+double ScratchBuffer::getPhaseError() const {
+    return m_phaseError.load(std::memory_order_relaxed);
+}
+
+void ScratchBuffer::setQuantize(bool enabled) {
+    m_quantize = enabled;
+    std::cout << "[ScratchBuffer] Quantize " << (enabled ? "enabled" : "disabled") << std::endl;
+}
+
+bool ScratchBuffer::getQuantize() const {
+    return m_quantize.load(std::memory_order_relaxed);
+}
+
 double ScratchBuffer::getPosition() {
-    return m_currentFrame / 44100.0; // Assume 44.1kHz
+    return fromFixed(m_position.load(std::memory_order_relaxed)) / 44100.0; // Assume 44.1kHz
 }
 
 double ScratchBuffer::getLength() {
-    return m_length / 44100.0;
-}
\ No newline at end of file
+    return m_track ? m_track->length / 44100.0 : 0.0;
+}
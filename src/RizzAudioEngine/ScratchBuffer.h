@@ -2,6 +2,17 @@
 
 #include <vector>
 #include <string>
+#include <memory>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include "DecodedTrack.h"
+#include "Interpolator.h"
+#include "PitchShifter.h"
+#include "Platter.h"
+#include "BeatGrid.h"
+#include "CommandQueue.h"
+#include "MasterClock.h"
 
 struct FileInfo {
     std::string format;
@@ -17,30 +28,321 @@ struct FileInfo {
 
 class ScratchBuffer {
 public:
-    ScratchBuffer();
+    // statsSlot: index into the engine stats' per-deck counters, -1 for none
+    explicit ScratchBuffer(int statsSlot = -1);
     ~ScratchBuffer();
 
     static bool getFileInfo(const std::string& filePath, FileInfo& info);
+    static std::shared_ptr<DecodedTrack> decodeFile(const std::string& filePath);
+    static bool loadWAV(const std::string& filePath, const FileInfo& info, DecodedTrack& track);
+    static bool loadMP3(const std::string& filePath, const FileInfo& info, DecodedTrack& track);
     bool initialize(void* stream);
     bool loadFile(const std::string& filePath);
-    bool loadWAV(const std::string& filePath, const FileInfo& info);
-    bool loadMP3(const std::string& filePath, const FileInfo& info);
+    // Swap in an already decoded track; no decoding happens here
+    bool loadTrack(std::shared_ptr<const DecodedTrack> track);
     void getAudio(float* left, float* right, int frames);
     void play();
     void pause();
     void seek(long frame);
+    // Playback rate, -2.0..2.0 (1.0 = normal, negative = reverse)
     void setSpeed(double ratio);
+    double getSpeed() const;
+    void setInterpolation(int mode);
+    // Key-lock: tempo follows the rate, pitch stays put (mode: TimeStretcher::Mode)
+    void setKeyLock(bool enabled);
+    void setKeyLockMode(int mode);
+    bool getKeyLock() const;
+    double getKeyLockLatencyMs() const;
+    // Key shift in semitones (-12..12), independent of tempo and key-lock
+    void setKeyShift(double semitones);
+    double getKeyShift() const;
+    // Scratching: jog reports from any thread, applied sample-accurately on
+    // the audio thread (position in seconds of audio, velocity as a rate)
+    void jogTouch(bool touched);
+    void jogPosition(double seconds);
+    void jogVelocity(double ratio);
+    void brake(double seconds);
+    void spinback(double speed, double seconds);
+    // Time for a released platter to get from standstill back to 1x
+    void setPlatterInertia(double seconds);
+    // Beat grid for beat loops (tempo, and the time of any beat)
+    void setBeatGrid(double bpm, double firstBeatSeconds);
+    // Loops: points in frames, beat lengths need a beat grid (else 120 BPM).
+    // Applied on the audio thread at the next block.
+    void loopIn();
+    void loopOut();
+    void setLoop(int64_t inFrame, int64_t outFrame);
+    void beatLoop(double beats);
+    void loopRoll(double beats);
+    void loopRollRelease();
+    void loopHalve();
+    void loopDouble();
+    void loopExit();
+    void reloop();
+    int64_t getLoopIn() const;    // -1 when no loop is set
+    int64_t getLoopOut() const;
+    bool isLoopActive() const;
+    // Hot cues in seconds (< 0: none). Audio around each cue is kept faulted
+    // in and locked so a jump never waits on memory; jumps crossfade and,
+    // with quantize on, keep the current beat phase.
+    static constexpr int kMaxHotCues = 32;
+    void setHotCue(int index, double seconds);   // seconds < 0: current position
+    void clearHotCue(int index);
+    void jumpToHotCue(int index);
+    double getHotCue(int index) const;
+    void releaseHotCue();   // ends a slip hot-cue press
+    void setQuantize(bool enabled);
+    bool getQuantize() const;
+
+    // Slip mode: while a loop, scratch, reverse or held hot cue is active a
+    // shadow play head keeps going at the normal rate, and playback picks up
+    // from it when the action ends. Slip position is in seconds, -1 when not
+    // slipping.
+    void setSlip(bool enabled);
+    bool getSlip() const;
+    void setReverse(bool enabled);
+    double getSlipPosition() const;
+
+    // Beat sync: a synced deck runs at the master clock's tempo and a phase
+    // lock keeps its beat grid on the clock's beat. The leader drives the
+    // clock instead of following it. Phase error is in beats.
+    enum SyncState { SYNC_OFF, SYNC_NO_GRID, SYNC_LOCKING, SYNC_LOCKED };
+    void setMasterClock(const MasterClock* clock);
+    void setSync(bool enabled);
+    bool getSync() const;
+    void setSyncLeader(bool leader);
+    int getSyncState() const;
+    double getPhaseError() const;
+    // Scheduled actions run on the exact frame they are due, in engine frames
+    // (the master clock's frame count), at a master-clock beat, or at the next
+    // multiple of `time` beats. Values: cue position in seconds, hot cue
+    // index, beat loop length. Late actions run at the start of the next block.
+    enum ScheduledActionType { ACTION_PLAY, ACTION_PAUSE, ACTION_CUE, ACTION_HOT_CUE, ACTION_BEAT_LOOP,
+                               ACTION_LOOP_EXIT, ACTION_RELOOP };
+    enum ScheduleTimeBase { SCHEDULE_FRAME, SCHEDULE_BEAT, SCHEDULE_NEXT_BEATS };
+    bool schedule(int action, double value, int timeBase, double time);
+    void cancelScheduled();
+    // Outro point for queued playback, in track frames (< 0: none). It fires
+    // once when playback reaches or passes it, and the audio thread collects
+    // the engine frame it was reached at right after getAudio.
+    void setOutroPoint(int64_t frame);
+    bool takeOutroCrossing(int64_t& engineFrame);
+    bool isPlaying() const;
+    // Audio thread, after getAudio: tempo and beat at the end of the block,
+    // false if the deck can't lead (stopped, reversed or no grid)
+    bool beatClock(double& bpm, double& beat) const;
+    // Stem tracks (multichannel WAV, stereo pairs) are mixed inside the deck
+    // before the channel strip. Gain 0..2; changes ramp over ~12 ms.
+    static constexpr int kMaxStems = 8;
+    void setStemGain(int stem, float gain);
+    void setStemMute(int stem, bool muted);
+    float getStemGain(int stem) const;
+    int getStemCount() const;   // 0 for a plain mono or stereo track
+    // Pre-fault and mlock the loaded track (and any later ones) for this deck
+    void setMemoryLocked(bool locked);
+    // Play, pause, seek and track changes crossfade over this many ms (0..5)
+    void setTransportFade(double ms);
+    double getTransportFade() const;
     double getPosition();
     double getLength();
 
 private:
+    struct DeckCommand {
+        enum Type { TRACK_LOADED, BEAT_GRID, LOOP_IN, LOOP_OUT, LOOP_SET, BEAT_LOOP, LOOP_ROLL, LOOP_ROLL_RELEASE,
+                    LOOP_HALVE, LOOP_DOUBLE, LOOP_EXIT, RELOOP, JUMP_HOT_CUE,
+                    HOT_CUE_RELEASE, PLAY, PAUSE, SEEK, CANCEL_SCHEDULED };
+        Type type;
+        double a;
+        double b;
+    };
+    struct ScheduledAction {
+        DeckCommand command;
+        int timeBase;
+        double time;
+    };
+
+    void post(DeckCommand::Type type, double a = 0.0, double b = 0.0);
+    void applyCommands(const DecodedTrack* track);
+    void takeScheduled();
+    int64_t dueFrame(const ScheduledAction& action) const;
+    void renderChunk(float* left, float* right, int frames);
+    void checkOutro(const DecodedTrack* track, int64_t before, bool playing, int frames);
+    // Track frames to read: frame f is at data[(f - first) * channels], and
+    // only frames inside the track are valid. Plain tracks read in place;
+    // stem tracks get [first, last] mixed down to stereo in a deck window.
+    struct Source {
+        const float* data;
+        int channels;
+        int64_t first;
+    };
+    Source source(const DecodedTrack& track, int64_t first, int64_t last);
+    void updateStemGains(const DecodedTrack* track, int frames);
+    void copySourceFrames(const DecodedTrack& track, float* left, float* right, int frames, int64_t frame, int direction);
+    void applyCommand(const DeckCommand& command, const DecodedTrack* track);
+    void setLoopPoints(int64_t in, int64_t out, bool active);
+    void foldIntoLoop();
+    void jumpWithSeam(int64_t target);
+    void publishLoop();
+    void pinCueWindow(const DecodedTrack& track, int64_t frame, bool pin);
+    void releaseCueWindow(int64_t frame);
+    bool waitForTrackSwitch(const DecodedTrack* track);
+    void pinTrack(const DecodedTrack& track);
+    void unpinTrack(const DecodedTrack& track);
+    void renderSpan(const DecodedTrack& track, float* left, float* right, int frames, int64_t peakIncrement, int mode);
+    int framesToEdge(const int64_t* increments, int frames, int64_t peakIncrement, int64_t lo, int64_t hi, int* edge) const;
+    void edges(const DecodedTrack& track, int64_t& lo, int64_t& hi) const;
+    int64_t renderVariable(const DecodedTrack& track, float* left, float* right, int frames, const int64_t* increments,
+                           int64_t pos, int64_t peakIncrement, int mode);
+    int64_t renderKernel(const DecodedTrack& track, float* left, float* right, int frames, const int64_t* increments,
+                         int64_t pos, int64_t peakIncrement, int mode);
+    template <class Kernel, int Channels>
+    int64_t renderInterpolated(const DecodedTrack& track, float* left, float* right, int frames, const int64_t* increments,
+                               int64_t pos, int64_t peakIncrement);
+    void mixSeam(float* left, float* right, const float* tailLeft, const float* tailRight, int frames);
+    void renderScratch(const DecodedTrack& track, float* left, float* right, int frames);
+    void leaveShifted(const DecodedTrack& track);
+    void renderShifted(const DecodedTrack& track, float* left, float* right, int frames, double speed, double pitch);
+    void publishShiftLoad(float load);
+    double syncSpeed(const DecodedTrack* track, bool playing, int64_t position, int frames);
+    void publishSync(int state, double error);
+    int64_t audiblePosition() const;
+    bool slipHeld() const;
+    void beginSlip(int64_t from);
+    void advanceSlip(int64_t blockStart, bool playing, int frames);
+    void endSlip(const DecodedTrack* track);
+    void readSourceFrames(const DecodedTrack& track, float* left, float* right, int frames, int direction);
+    void renderBlock(const DecodedTrack* track, bool playing, float* left, float* right, int frames);
+    void beginTransportFade(const DecodedTrack* track, bool seeking, bool playing);
+    void renderTail(const DecodedTrack& track, float* left, float* right, int frames);
+    void mixTransportFade(float* left, float* right, int frames);
+
     void* m_stream;
-    bool m_isPlaying;
-    long m_currentFrame;
-    double m_speed;
-    std::vector<float> m_audioData;
-    long m_length;
-    int m_channels;
-    int m_sampleRate;
-    int m_bitsPerSample;
-};
\ No newline at end of file
+    std::atomic<bool> m_isPlaying;
+    std::atomic<double> m_speed;
+    std::atomic<int> m_interpolation;
+
+    // 32.32 fixed-point play head and per-frame increment, audio thread only.
+    // Control threads request seeks and read the published position.
+    static constexpr int kMaxRenderFrames = 1024;
+    int64_t m_playhead;
+    int64_t m_increment;
+    int64_t m_increments[kMaxRenderFrames];
+    std::atomic<bool> m_seekPending;
+    std::atomic<int64_t> m_seekTarget;
+    std::atomic<int64_t> m_position;
+
+    // Key-lock and key shift; the shifter is only touched on the audio thread
+    std::atomic<bool> m_keyLock;
+    std::atomic<int> m_keyLockMode;
+    std::atomic<double> m_keyShift;
+    bool m_stretchActive;
+    double m_shiftSpeed;   // what the shifter last rendered with
+    double m_shiftPitch;
+    std::unique_ptr<PitchShifter> m_shifter;
+    int m_statsSlot;
+    float m_shiftLoad;
+
+    Platter m_platter;
+    double m_platterVelocity[kMaxRenderFrames];
+
+    // Loops and beat grid, audio thread only; control threads post commands
+    // and read the published loop points
+    static constexpr int kSeamFrames = 128;   // ~3 ms equal-power crossfade
+    CommandQueue<DeckCommand, 256> m_commands;
+    BeatGrid m_grid;
+    bool m_loopSet;
+    bool m_loopActive;
+    int64_t m_loopStart;   // 32.32, whole frames
+    int64_t m_loopEnd;
+    bool m_rollActive;
+    bool m_rollRestoreLoop;
+    bool m_rollRestoreActive;
+    int64_t m_rollRestoreStart;
+    int64_t m_rollRestoreEnd;
+    int m_seamRemaining;
+    int m_seamLength;
+    int64_t m_seamOffset;  // the faded-out tail plays at play head + offset
+    float m_seamLeft[kMaxRenderFrames];
+    float m_seamRight[kMaxRenderFrames];
+    std::atomic<int64_t> m_loopInFrame;
+    std::atomic<int64_t> m_loopOutFrame;
+    std::atomic<bool> m_loopActivePublished;
+
+    // Slip: the shadow is where playback would be without the held action.
+    // Loop rolls use it with or without slip mode.
+    std::atomic<bool> m_slip;
+    std::atomic<bool> m_reverse;
+    bool m_slipping;
+    bool m_cueHeld;
+    int64_t m_slipShadow;     // 32.32
+    int64_t m_slipIncrement;  // motor rate at the end of the last block
+    std::atomic<int64_t> m_slipPosition;
+
+    // Sync; m_blockSpeed is the rate this block plays at, synced or not
+    const MasterClock* m_clock;
+    std::atomic<bool> m_sync;
+    std::atomic<bool> m_syncLeader;
+    std::atomic<int> m_syncState;
+    std::atomic<float> m_phaseError;
+    PhaseLock m_pll;
+    double m_blockSpeed;
+
+    // Scheduled actions: posted through the queue, kept in m_scheduled on the
+    // audio thread until due. m_frameCounter is the frame being rendered.
+    static constexpr int kMaxScheduled = 64;
+    CommandQueue<ScheduledAction, 128> m_scheduleQueue;
+    ScheduledAction m_scheduled[kMaxScheduled];
+    int64_t m_frameCounter;
+    int m_scheduledCount;
+    std::atomic<int64_t> m_outroPoint;
+    int64_t m_outroCrossing;   // engine frame, -1 until the point is reached
+
+    // Stem mix. Control threads set the gains; per block the audio thread
+    // moves each stem from m_stemFrom to m_stemTo, ramped by source frame
+    // across the stretch the play head covers (m_stemRampBase/Scale).
+    static constexpr int kStemWindowFrames = 8192;
+    std::atomic<float> m_stemGain[kMaxStems];
+    std::atomic<bool> m_stemMute[kMaxStems];
+    float m_stemFrom[kMaxStems];
+    float m_stemTo[kMaxStems];
+    double m_stemRampBase;
+    double m_stemRampScale;
+    float m_stemLeft[kStemWindowFrames];
+    float m_stemRight[kStemWindowFrames];
+    float m_stemWindow[kStemWindowFrames * 2];
+
+    // Transport fades, audio thread only. When play, pause, seek or a track
+    // change reaches the audio thread, the outgoing state is rendered ahead
+    // into the fade buffer and faded out under the incoming one.
+    static constexpr int kMaxTransportFadeFrames = 256;   // > 5 ms
+    std::atomic<int> m_transportFadeFrames;
+    const DecodedTrack* m_renderTrack;   // the track the last block played
+    bool m_audible;                      // the last block played audio
+    bool m_platterEngaged;               // ... through the platter
+    int m_fadeRemaining;
+    int m_fadeLength;
+    float m_fadeCorrelation;             // of the two sides, 0 = equal power
+    float m_fadeLeft[kMaxTransportFadeFrames];
+    float m_fadeRight[kMaxTransportFadeFrames];
+    float m_fadeScratchLeft[kMaxTransportFadeFrames];
+    float m_fadeScratchRight[kMaxTransportFadeFrames];
+
+    // Hot cue frames (-1 unset) are written on the control side, which also
+    // owns their pinned windows; the audio thread reads them when jumping
+    std::mutex m_cueMutex;
+    std::atomic<int64_t> m_hotCues[kMaxHotCues];
+    std::atomic<bool> m_quantize;
+    BeatGrid m_controlGrid;
+
+    // Owned on the control side; the audio thread only sees m_activeTrack,
+    // and reports in m_renderedTrack once it has faded the previous one out.
+    // m_retiredTrack keeps an outgoing track alive while the stream is
+    // stopped and so could still fade it out when it resumes.
+    std::shared_ptr<const DecodedTrack> m_track;
+    std::shared_ptr<const DecodedTrack> m_retiredTrack;
+    std::atomic<const DecodedTrack*> m_activeTrack;
+    std::atomic<const DecodedTrack*> m_renderedTrack;
+    std::atomic<uint64_t> m_blocksRendered;
+    bool m_memoryLocked;
+    bool m_trackPinned;
+};
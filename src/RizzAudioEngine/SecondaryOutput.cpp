@@ -0,0 +1,196 @@
+#include "SecondaryOutput.h"
+#include "Interpolator.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+namespace {
+const double kEngineRate = 44100.0;
+const int kBlockFrames = 512;
+// Loop gains: a frame of fill error is worth 4 ppm at once, and integrates
+// into the drift estimate with a time constant of ~11 s, critically damped.
+// The fill is averaged over ~1 s first to take out callback jitter.
+const double kProportional = 4.0e-6;
+const double kIntegral = 1.76e-7;
+const double kAverageSeconds = 1.0;
+
+int64_t nowNanos() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+}
+
+SecondaryOutput::SecondaryOutput(int source)
+    : m_source(source == CUE ? CUE : MASTER), m_device(-1), m_stream(nullptr), m_write(0), m_pushTime(0), m_pushFrames(0), m_read(0),
+      m_primed(false), m_readFrame(0), m_frac(0), m_rate(kEngineRate), m_nominalRatio(1.0), m_fillAverage(0.0),
+      m_integral(0.0), m_fillMetric(0.0f), m_ratioMetric(1.0), m_underruns(0), m_overruns(0) {
+    std::memset(m_ring, 0, sizeof(m_ring));
+}
+
+SecondaryOutput::~SecondaryOutput() {
+    stop();
+}
+
+bool SecondaryOutput::start(int device) {
+    const PaDeviceInfo* deviceInfo = Pa_GetDeviceInfo(device);
+    if (!deviceInfo || deviceInfo->maxOutputChannels < 2) {
+        std::cout << "[SecondaryOutput] Device " << device << " has no stereo output" << std::endl;
+        return false;
+    }
+
+    PaStreamParameters outputParameters;
+    outputParameters.device = device;
+    outputParameters.channelCount = 2;
+    outputParameters.sampleFormat = paFloat32;
+    outputParameters.suggestedLatency = deviceInfo->defaultLowOutputLatency;
+    outputParameters.hostApiSpecificStreamInfo = nullptr;
+
+    // The resampler covers a different rate as well as the drift
+    m_rate = kEngineRate;
+    if (Pa_IsFormatSupported(nullptr, &outputParameters, kEngineRate) != paFormatIsSupported) {
+        m_rate = deviceInfo->defaultSampleRate;
+    }
+    m_nominalRatio = kEngineRate / m_rate;
+    m_ratioMetric.store(m_nominalRatio, std::memory_order_relaxed);
+
+    PaError err = Pa_OpenStream(&m_stream, nullptr, &outputParameters, m_rate, kBlockFrames, paClipOff,
+                                &SecondaryOutput::streamCallback, this);
+    if (err != paNoError) {
+        std::cout << "[SecondaryOutput] Failed to open device " << device << ": " << Pa_GetErrorText(err) << std::endl;
+        m_stream = nullptr;
+        return false;
+    }
+    err = Pa_StartStream(m_stream);
+    if (err != paNoError) {
+        std::cout << "[SecondaryOutput] Failed to start device " << device << ": " << Pa_GetErrorText(err) << std::endl;
+        Pa_CloseStream(m_stream);
+        m_stream = nullptr;
+        return false;
+    }
+    m_device = device;
+    std::cout << "[SecondaryOutput] Started " << (m_source == CUE ? "cue" : "master") << " on device " << device
+              << " (" << deviceInfo->name << ") at " << m_rate << " Hz" << std::endl;
+    return true;
+}
+
+void SecondaryOutput::stop() {
+    if (!m_stream) return;
+    Pa_StopStream(m_stream);
+    Pa_CloseStream(m_stream);
+    m_stream = nullptr;
+    std::cout << "[SecondaryOutput] Stopped device " << m_device << std::endl;
+}
+
+void SecondaryOutput::push(const float* left, const float* right, int frames) {
+    uint64_t write = m_write.load(std::memory_order_relaxed);
+    uint64_t read = m_read.load(std::memory_order_acquire);
+    if (write - read + (uint64_t)frames > (uint64_t)kCapacity) {
+        m_overruns.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    for (int i = 0; i < frames; ++i) {
+        float* frame = m_ring + ((write + i) & (kCapacity - 1)) * 2;
+        frame[0] = left[i];
+        frame[1] = right[i];
+    }
+    m_write.store(write + frames, std::memory_order_release);
+    m_pushTime.store(nowNanos(), std::memory_order_relaxed);
+    m_pushFrames.store(frames, std::memory_order_relaxed);
+}
+
+// Start reading kTargetFill frames behind the writer's position, with the
+// loop's fill average restarted
+void SecondaryOutput::prime(double writer) {
+    m_readFrame = (uint64_t)writer - kTargetFill;
+    m_frac = 0;
+    m_read.store(m_readFrame - HermiteInterp::kBefore, std::memory_order_release);
+    m_fillAverage = kTargetFill;
+    m_primed = true;
+}
+
+void SecondaryOutput::pull(float* out, int frames) {
+    // The writer's position, taken as advancing steadily through its last
+    // block since the push so the fill doesn't step by a block each time one
+    // arrives (which would beat against this device's blocks and wobble
+    // the ratio)
+    uint64_t write = m_write.load(std::memory_order_acquire);
+    int64_t pushTime = m_pushTime.load(std::memory_order_relaxed);
+    int pushFrames = m_pushFrames.load(std::memory_order_relaxed);
+    double writer = (double)write;
+    if (pushTime > 0) {
+        double written = (nowNanos() - pushTime) * 1e-9 * kEngineRate;
+        writer -= pushFrames - std::max(0.0, std::min((double)pushFrames, written));
+    }
+    if (!m_primed) {
+        if (writer < kTargetFill + HermiteInterp::kBefore) {
+            std::fill(out, out + frames * 2, 0.0f);
+            return;
+        }
+        prime(writer);
+    }
+
+    // Far too much queued means the reader stalled, so jump back to the
+    // target rather than run fast
+    double queued = writer - (double)m_readFrame - m_frac * (double)kFracScale;
+    if (queued > kTargetFill + kCapacity / 2) {
+        m_overruns.fetch_add(1, std::memory_order_relaxed);
+        prime(writer);
+        queued = writer - (double)m_readFrame;
+    }
+
+    // Drift loop: average the fill, then trim the ratio around nominal by a
+    // PI controller on its distance from the target
+    double dt = frames / m_rate;
+    m_fillAverage += (queued - m_fillAverage) * std::min(1.0, dt / kAverageSeconds);
+    double error = m_fillAverage - kTargetFill;
+    m_integral = std::max(-kMaxCorrection, std::min(kMaxCorrection, m_integral + kIntegral * error * dt));
+    double correction = std::max(-kMaxCorrection, std::min(kMaxCorrection, kProportional * error + m_integral));
+    double ratio = m_nominalRatio * (1.0 + correction);
+    int64_t step = toFixed(ratio);
+
+    // Every tap this block reads must already be queued
+    uint64_t last = m_readFrame + (uint64_t)(((int64_t)m_frac + step * frames) >> kFixedShift) + 2;
+    if (last >= write) {
+        m_underruns.fetch_add(1, std::memory_order_relaxed);
+        m_primed = false;
+        std::fill(out, out + frames * 2, 0.0f);
+        return;
+    }
+
+    uint64_t readFrame = m_readFrame;
+    uint64_t position = m_frac;
+    float w[HermiteInterp::kTaps];
+    for (int i = 0; i < frames; ++i) {
+        HermiteInterp::weights((uint32_t)position, w);
+        uint64_t first = readFrame - HermiteInterp::kBefore;
+        float left = 0.0f, right = 0.0f;
+        for (int k = 0; k < HermiteInterp::kTaps; ++k) {
+            const float* frame = m_ring + ((first + k) & (kCapacity - 1)) * 2;
+            left += w[k] * frame[0];
+            right += w[k] * frame[1];
+        }
+        out[i * 2] = left;
+        out[i * 2 + 1] = right;
+        position += step;
+        readFrame += position >> kFixedShift;
+        position &= 0xFFFFFFFFu;
+    }
+    m_readFrame = readFrame;
+    m_frac = (uint32_t)position;
+    m_read.store(m_readFrame - HermiteInterp::kBefore, std::memory_order_release);
+
+    m_fillMetric.store((float)m_fillAverage, std::memory_order_relaxed);
+    m_ratioMetric.store(ratio, std::memory_order_relaxed);
+}
+
+int SecondaryOutput::streamCallback(const void* input, void* output, unsigned long frames,
+                                    const PaStreamCallbackTimeInfo* timeInfo, PaStreamCallbackFlags flags,
+                                    void* userData) {
+    (void)input;
+    (void)timeInfo;
+    (void)flags;
+    static_cast<SecondaryOutput*>(userData)->pull(static_cast<float*>(output), (int)frames);
+    return paContinue;
+}
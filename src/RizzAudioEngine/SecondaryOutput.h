@@ -0,0 +1,71 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <portaudio.h>
+
+// An extra stereo output on another device (booth, or headphones on a
+// second card), running from that device's own clock. The main callback
+// pushes every block into a lock-free ring; this device's callback reads it
+// back through a fractional resampler whose ratio a PI loop trims, so the
+// ring holds steady at its target fill however far the two clocks drift.
+class SecondaryOutput {
+public:
+    enum Source { MASTER = 0, CUE = 1 };
+
+    explicit SecondaryOutput(int source);
+    ~SecondaryOutput();
+
+    // Off the audio thread: open and start the stream on a device, at the
+    // engine rate if it takes it or else at its own default rate
+    bool start(int device);
+    void stop();
+
+    int source() const { return m_source; }
+    int device() const { return m_device; }
+
+    // Main audio thread: queue a stereo block; dropped (and counted as an
+    // overrun) if the ring has no room for it
+    void push(const float* left, const float* right, int frames);
+    // Device thread: resample queued audio into interleaved stereo
+    void pull(float* out, int frames);
+
+    // Metrics, any thread
+    float fill() const { return m_fillMetric.load(std::memory_order_relaxed); }   // smoothed frames queued
+    double ratio() const { return m_ratioMetric.load(std::memory_order_relaxed); } // engine frames per device frame
+    uint64_t underruns() const { return m_underruns.load(std::memory_order_relaxed); }
+    uint64_t overruns() const { return m_overruns.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr int kCapacity = 8192;      // ring frames, power of two
+    static constexpr int kTargetFill = 1536;    // ~35 ms; covers both devices' blocks and jitter
+    static constexpr double kMaxCorrection = 0.005;
+
+    static int streamCallback(const void* input, void* output, unsigned long frames,
+                              const PaStreamCallbackTimeInfo* timeInfo, PaStreamCallbackFlags flags, void* userData);
+    void prime(double writer);
+
+    const int m_source;
+    int m_device;
+    PaStream* m_stream;
+
+    float m_ring[kCapacity * 2];   // interleaved stereo
+    alignas(64) std::atomic<uint64_t> m_write;   // frames pushed
+    std::atomic<int64_t> m_pushTime;             // steady clock ns of the last push
+    std::atomic<int> m_pushFrames;               // and its size
+    alignas(64) std::atomic<uint64_t> m_read;    // oldest frame the reader still needs
+
+    // Device thread only. The read position is m_readFrame + m_frac / 2^32.
+    bool m_primed;
+    uint64_t m_readFrame;
+    uint32_t m_frac;
+    double m_rate;            // device rate
+    double m_nominalRatio;    // engine rate / device rate
+    double m_fillAverage;
+    double m_integral;
+
+    std::atomic<float> m_fillMetric;
+    std::atomic<double> m_ratioMetric;
+    std::atomic<uint64_t> m_underruns;
+    std::atomic<uint64_t> m_overruns;
+};
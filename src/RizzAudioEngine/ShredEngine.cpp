@@ -1,6 +1,12 @@
 #include "ScratchBuffer.h"
 #include "ClubMixer.h"
 #include "Selekta.h"
+#include "CrateDigger.h"
+#include "EngineStats.h"
+#include "MasterClock.h"
+#include "Sampler.h"
+#include "AutoDj.h"
+#include "SecondaryOutput.h"
 #include <iostream>
 #include <memory>
 #include <chrono>
@@ -8,6 +14,13 @@
 #include <portaudio.h>
 #include <fstream>
 #include <cmath>
+#include <cstring>
+#include <algorithm>
+#include <mutex>
+#include <thread>
+#ifdef __linux__
+#include <sys/resource.h>
+#endif
 
 static std::ofstream logFile("shredengine.log", std::ios::app);
 
@@ -18,14 +31,162 @@ static std::unique_ptr<Selekta> g_ampManager;
 static std::unique_ptr<ClubMixer> g_mixer;
 static std::unique_ptr<ScratchBuffer> g_deck1;
 static std::unique_ptr<ScratchBuffer> g_deck2;
+static std::unique_ptr<CrateDigger> g_crateDigger;
+static std::unique_ptr<Sampler> g_sampler;
+static std::unique_ptr<AutoDj> g_autoDj;
 static PaStream* g_stream = nullptr;
 static bool g_isTestMode = false;
+static MasterClock g_clock;
+static std::atomic<int> g_syncLeader{0};   // deck driving the clock, 0 = internal
+// Channels in the output stream: master on 1-2 and, with 4, the headphone
+// cue on 3-4
+static int g_outputChannels = 2;
+
+// Outputs on other devices, fed from the callback through their rings.
+// Opened and closed under the mutex; the callback only sees `active`.
+static const int kMaxSecondaryOutputs = 4;
+static std::mutex g_secondaryMutex;
+static std::unique_ptr<SecondaryOutput> g_secondaryOwned[kMaxSecondaryOutputs];
+static std::atomic<SecondaryOutput*> g_secondaryActive[kMaxSecondaryOutputs];
+
+// 1-based deck number to deck, nullptr if invalid or not initialized
+static ScratchBuffer* getDeck(int deck) {
+    if (deck == 1) return g_deck1.get();
+    if (deck == 2) return g_deck2.get();
+    return nullptr;
+}
+
+// Callback scratch space lives in static storage and is touched once in
+// InitializeEngine, so the audio thread never allocates or first-touches a page.
+static const unsigned long kMaxBlockFrames = 1024;
+struct CallbackBuffers {
+    float left1[kMaxBlockFrames], right1[kMaxBlockFrames];
+    float left2[kMaxBlockFrames], right2[kMaxBlockFrames];
+    float leftSampler[kMaxBlockFrames], rightSampler[kMaxBlockFrames];
+    float crossfader[kMaxBlockFrames];
+    float leftOut[kMaxBlockFrames], rightOut[kMaxBlockFrames];
+    float leftCue[kMaxBlockFrames], rightCue[kMaxBlockFrames];
+};
+static CallbackBuffers g_buffers;
+
+static const int kSamplerSlots = 32;
+
+// Page faults taken by the audio thread (Linux: per-thread getrusage)
+static bool readThreadFaults(uint64_t& minor, uint64_t& major) {
+#ifdef RUSAGE_THREAD
+    struct rusage usage;
+    if (getrusage(RUSAGE_THREAD, &usage) == 0) {
+        minor = (uint64_t)usage.ru_minflt;
+        major = (uint64_t)usage.ru_majflt;
+        return true;
+    }
+#endif
+    (void)minor;
+    (void)major;
+    return false;
+}
+
+// Render one chunk of at most kMaxBlockFrames, interleaved across
+// g_outputChannels (master, then cue when the stream has room for it)
+static void renderBlock(float* out, unsigned long frames) {
+    CallbackBuffers& b = g_buffers;
+
+    // Get audio from decks (buffers are zeroed at init, decks overwrite them).
+    // Auto-DJ's playing deck goes first, so a handover at its outro starts
+    // the other deck within this same block.
+    ScratchBuffer* decks[2] = {g_deck1.get(), g_deck2.get()};
+    float* lefts[2] = {b.left1, b.left2};
+    float* rights[2] = {b.right1, b.right2};
+    int lead = g_autoDj ? g_autoDj->leadDeck() : 0;
+    if (decks[lead]) decks[lead]->getAudio(lefts[lead], rights[lead], frames);
+    if (g_autoDj) g_autoDj->handover();
+    if (decks[1 - lead]) decks[1 - lead]->getAudio(lefts[1 - lead], rights[1 - lead], frames);
+    if (g_mixer) g_mixer->applyChannelDsp(lefts, rights, 2, (int)frames);
+    if (g_sampler) g_sampler->process(b.leftSampler, b.rightSampler, frames);
+
+    // Auto-DJ drives the crossfader frame by frame while it runs
+    bool automated = g_autoDj && g_autoDj->crossfader(g_clock.frame(), (int)frames, b.crossfader);
+
+    // Move the master clock on to the next block, following the leader
+    // deck while it plays
+    double leaderBpm = 0.0, leaderBeat = 0.0;
+    ScratchBuffer* leader = getDeck(g_syncLeader.load(std::memory_order_relaxed));
+    if (leader && leader->beatClock(leaderBpm, leaderBeat)) g_clock.follow(leaderBpm, leaderBeat, (int)frames);
+    else g_clock.advance((int)frames);
+
+    // Bus-based mixing: Assign decks to LEFT/RIGHT buses, apply crossfader to buses
+    float deck1_vol = g_mixer ? g_mixer->getDeckVolume(0) : 1.0f;
+    float deck2_vol = g_mixer ? g_mixer->getDeckVolume(1) : 1.0f;
+    float master_gain = g_mixer ? g_mixer->getMasterVolume() : 1.0f;
+    float crossfader = g_mixer ? g_mixer->getCrossfader() : 0.0f;
+
+    // Crossfader gains for buses (additive style, but bus-based)
+    float left_bus_gain = 1.0f - std::max(0.0f, crossfader);
+    float right_bus_gain = 1.0f - std::max(0.0f, -crossfader);
+
+    for (unsigned long i = 0; i < frames; ++i) {
+        if (automated) {
+            left_bus_gain = 1.0f - std::max(0.0f, b.crossfader[i]);
+            right_bus_gain = 1.0f - std::max(0.0f, -b.crossfader[i]);
+        }
+        // Deck 1 to LEFT bus, Deck 2 to RIGHT bus
+        float left_bus_l = b.left1[i] * deck1_vol;
+        float left_bus_r = b.right1[i] * deck1_vol;
+        float right_bus_l = b.left2[i] * deck2_vol;
+        float right_bus_r = b.right2[i] * deck2_vol;
+
+        // Mix buses with crossfader gains; the sampler sits after the crossfader
+        b.leftOut[i] = (left_bus_l * left_bus_gain + right_bus_l * right_bus_gain + b.leftSampler[i]) * master_gain;
+        b.rightOut[i] = (left_bus_r * left_bus_gain + right_bus_r * right_bus_gain + b.rightSampler[i]) * master_gain;
+    }
+
+    // Apply output DSP (clipping protection)
+    if (g_mixer) {
+        g_mixer->applyOutputDSP(b.leftOut, b.rightOut, frames);
+    }
+
+    // Headphone cue from the channel strips, pre-fader, against the finished
+    // master; rendered when this stream or another device carries it
+    const int channels = g_outputChannels;
+    SecondaryOutput* secondary[kMaxSecondaryOutputs];
+    bool cueWanted = channels >= 4;
+    for (int o = 0; o < kMaxSecondaryOutputs; ++o) {
+        secondary[o] = g_secondaryActive[o].load(std::memory_order_acquire);
+        if (secondary[o] && secondary[o]->source() == SecondaryOutput::CUE) cueWanted = true;
+    }
+    if (cueWanted && g_mixer) {
+        g_mixer->renderCue(lefts, rights, 2, b.leftOut, b.rightOut, b.leftCue, b.rightCue, (int)frames);
+    }
+    for (int o = 0; o < kMaxSecondaryOutputs; ++o) {
+        if (!secondary[o]) continue;
+        if (secondary[o]->source() == SecondaryOutput::CUE) secondary[o]->push(b.leftCue, b.rightCue, (int)frames);
+        else secondary[o]->push(b.leftOut, b.rightOut, (int)frames);
+    }
+
+    if (channels == 2) {
+        for (unsigned long i = 0; i < frames; ++i) {
+            out[i * 2] = b.leftOut[i];
+            out[i * 2 + 1] = b.rightOut[i];
+        }
+        return;
+    }
+    for (unsigned long i = 0; i < frames; ++i) {
+        float* frame = out + i * channels;
+        frame[0] = b.leftOut[i];
+        frame[1] = b.rightOut[i];
+        frame[2] = b.leftCue[i];
+        frame[3] = b.rightCue[i];
+    }
+}
 
 // Audio callback
     static int audioCallback(const void* inputBuffer, void* outputBuffer, unsigned long framesPerBuffer,
                          const PaStreamCallbackTimeInfo* timeInfo, PaStreamCallbackFlags statusFlags, void* userData) {
     static unsigned long phase = 0;
     static bool first = true;
+    auto callbackStart = std::chrono::steady_clock::now();
+    uint64_t minorBefore = 0, majorBefore = 0;
+    bool haveFaults = readThreadFaults(minorBefore, majorBefore);
     if (first) {
         logFile << "[Callback] Started, framesPerBuffer=" << framesPerBuffer << ", testMode=" << g_isTestMode << std::endl;
         logFile.flush();
@@ -37,54 +198,32 @@ static bool g_isTestMode = false;
         // Generate sine for test
         for (unsigned long i = 0; i < framesPerBuffer; ++i) {
             float sample = sin(phase * 0.1) * 0.5f;
-            out[i * 2] = sample;
-            out[i * 2 + 1] = sample;
+            for (int c = 0; c < g_outputChannels; ++c) out[i * g_outputChannels + c] = sample;
             phase++;
         }
     } else {
-        // Get audio from decks
-        std::vector<float> left1(framesPerBuffer), right1(framesPerBuffer);
-        std::vector<float> left2(framesPerBuffer), right2(framesPerBuffer);
-
-        if (g_deck1) g_deck1->getAudio(left1.data(), right1.data(), framesPerBuffer);
-        if (g_deck2) g_deck2->getAudio(left2.data(), right2.data(), framesPerBuffer);
-
-        // Bus-based mixing: Assign decks to LEFT/RIGHT buses, apply crossfader to buses
-        float deck1_vol = g_mixer ? g_mixer->getDeckVolume(0) : 1.0f;
-        float deck2_vol = g_mixer ? g_mixer->getDeckVolume(1) : 1.0f;
-        float master_gain = g_mixer ? g_mixer->getMasterVolume() : 1.0f;
-        float crossfader = g_mixer ? g_mixer->getCrossfader() : 0.0f;
-        logFile << "Deck vols: " << deck1_vol << ", " << deck2_vol << ", crossfader: " << crossfader << std::endl;
-
-        // Crossfader gains for buses (additive style, but bus-based)
-        float left_bus_gain = 1.0f - std::max(0.0f, crossfader);
-        float right_bus_gain = 1.0f - std::max(0.0f, -crossfader);
-
-        for (unsigned long i = 0; i < framesPerBuffer; ++i) {
-            // Deck 1 to LEFT bus, Deck 2 to RIGHT bus
-            float left_bus_l = left1[i] * deck1_vol;
-            float left_bus_r = right1[i] * deck1_vol;
-            float right_bus_l = left2[i] * deck2_vol;
-            float right_bus_r = right2[i] * deck2_vol;
-
-            // Mix buses with crossfader gains
-            out[i * 2] = (left_bus_l * left_bus_gain + right_bus_l * right_bus_gain) * master_gain;
-            out[i * 2 + 1] = (left_bus_r * left_bus_gain + right_bus_r * right_bus_gain) * master_gain;
+        for (unsigned long done = 0; done < framesPerBuffer; ) {
+            unsigned long chunk = std::min(kMaxBlockFrames, framesPerBuffer - done);
+            renderBlock(out + done * g_outputChannels, chunk);
+            done += chunk;
         }
+    }
 
-        // Apply output DSP (clipping protection)
-        if (g_mixer) {
-            std::vector<float> left_out(framesPerBuffer), right_out(framesPerBuffer);
-            for (unsigned long i = 0; i < framesPerBuffer; ++i) {
-                left_out[i] = out[i * 2];
-                right_out[i] = out[i * 2 + 1];
-            }
-            g_mixer->applyOutputDSP(left_out.data(), right_out.data(), framesPerBuffer);
-            for (unsigned long i = 0; i < framesPerBuffer; ++i) {
-                out[i * 2] = left_out[i];
-                out[i * 2 + 1] = right_out[i];
-            }
-        }
+    // Publish callback load (time spent / time available) for the prefetcher and UI
+    EngineStats& stats = engineStats();
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - callbackStart).count();
+    float load = (float)(elapsed * 44100.0 / framesPerBuffer);
+    float smoothed = stats.audioLoad.load(std::memory_order_relaxed);
+    stats.audioLoad.store(smoothed + 0.1f * (load - smoothed), std::memory_order_relaxed);
+    if (load > stats.audioLoadPeak.load(std::memory_order_relaxed)) {
+        stats.audioLoadPeak.store(load, std::memory_order_relaxed);
+    }
+    stats.callbackCount.fetch_add(1, std::memory_order_relaxed);
+
+    uint64_t minorAfter = 0, majorAfter = 0;
+    if (haveFaults && readThreadFaults(minorAfter, majorAfter)) {
+        stats.audioMinorFaults.fetch_add(minorAfter - minorBefore, std::memory_order_relaxed);
+        stats.audioMajorFaults.fetch_add(majorAfter - majorBefore, std::memory_order_relaxed);
     }
 
     return paContinue;
@@ -103,6 +242,7 @@ SHRED_API void InitializeEngine(bool isTestMode) {
     logFile.flush();
     try {
         g_isTestMode = isTestMode;
+        std::memset(&g_buffers, 0, sizeof(g_buffers)); // fault the callback scratch in now
         logFile << "DLL built at " << __DATE__ << " " << __TIME__ << std::endl;
         logFile.flush();
         logWithTimestamp("Starting ShredEngine boot");
@@ -117,14 +257,20 @@ SHRED_API void InitializeEngine(bool isTestMode) {
         logWithTimestamp("ClubMixer created");
         logFile << "Starting ScratchBuffer deck 1 boot" << std::endl;
         logFile.flush();
-        g_deck1 = std::make_unique<ScratchBuffer>();
+        g_deck1 = std::make_unique<ScratchBuffer>(0);
         logFile << "[ShredEngine] Deck 1 (ScratchBuffer) created" << std::endl;
         logFile.flush();
         logFile << "Starting ScratchBuffer deck 2 boot" << std::endl;
         logFile.flush();
-        g_deck2 = std::make_unique<ScratchBuffer>();
+        g_deck2 = std::make_unique<ScratchBuffer>(1);
         logFile << "[ShredEngine] Deck 2 (ScratchBuffer) created" << std::endl;
         logFile.flush();
+        g_deck1->setMasterClock(&g_clock);
+        g_deck2->setMasterClock(&g_clock);
+        g_mixer->setMasterClock(&g_clock);
+        g_crateDigger = std::make_unique<CrateDigger>();
+        g_sampler = std::make_unique<Sampler>(kSamplerSlots);
+        g_autoDj = std::make_unique<AutoDj>(g_deck1.get(), g_deck2.get(), g_crateDigger.get());
 
         // Open audio stream - prefer ASIO device
         int deviceIndex = Pa_GetDefaultOutputDevice();
@@ -154,14 +300,22 @@ SHRED_API void InitializeEngine(bool isTestMode) {
         const PaDeviceInfo* deviceInfo = Pa_GetDeviceInfo(deviceIndex);
         logFile << "[ShredEngine] Using device: " << deviceInfo->name << std::endl;
         logFile.flush();
-        outputParameters.channelCount = 2;
+        // A device with a second channel pair carries the headphone cue on it
+        g_outputChannels = deviceInfo->maxOutputChannels >= 4 ? 4 : 2;
+        outputParameters.channelCount = g_outputChannels;
         outputParameters.sampleFormat = paFloat32;
         outputParameters.suggestedLatency = deviceInfo->defaultLowOutputLatency;
         outputParameters.hostApiSpecificStreamInfo = nullptr;
 
-        logFile << "Starting audio stream boot" << std::endl;
+        logFile << "Starting audio stream boot (" << g_outputChannels << " channels)" << std::endl;
         logFile.flush();
         PaError err = Pa_OpenStream(&g_stream, nullptr, &outputParameters, 44100, 512, paClipOff, audioCallback, nullptr);
+        if (err != paNoError && g_outputChannels != 2) {
+            logWithTimestamp("4-channel stream refused (" + std::string(Pa_GetErrorText(err)) + "), cue disabled");
+            g_outputChannels = 2;
+            outputParameters.channelCount = 2;
+            err = Pa_OpenStream(&g_stream, nullptr, &outputParameters, 44100, 512, paClipOff, audioCallback, nullptr);
+        }
         if (err != paNoError) {
             logWithTimestamp("Failed to open stream: " + std::string(Pa_GetErrorText(err)));
             throw std::runtime_error("Failed to open stream");
@@ -182,15 +336,22 @@ SHRED_API void InitializeEngine(bool isTestMode) {
 
 SHRED_API int LoadFile(int deck, const char* filePath) {
     try {
-        bool success = false;
-        if (deck == 1 && g_deck1) {
-            success = g_deck1->loadFile(filePath);
-        } else if (deck == 2 && g_deck2) {
-            success = g_deck2->loadFile(filePath);
-        } else {
+        ScratchBuffer* target = getDeck(deck);
+        if (!target) {
             std::cout << "[ShredEngine] Invalid deck number: " << deck << std::endl;
             return -1;
         }
+
+        // Prefetched tracks are a pointer swap; otherwise decode now and keep
+        // the result in the store in case it gets loaded again
+        std::shared_ptr<const DecodedTrack> track = g_crateDigger ? g_crateDigger->take(filePath) : nullptr;
+        if (track) {
+            std::cout << "[ShredEngine] Prefetch hit for " << filePath << std::endl;
+        } else {
+            track = ScratchBuffer::decodeFile(filePath);
+            if (track && g_crateDigger) g_crateDigger->store(track);
+        }
+        bool success = track && target->loadTrack(track);
         if (success) {
             std::cout << "[ShredEngine] File loaded successfully on deck " << deck << std::endl;
             return 0;
@@ -320,6 +481,17 @@ SHRED_API void ShutdownEngine() {
             g_stream = nullptr;
             std::cout << "[ShredEngine] Audio stream stopped and closed" << std::endl;
         }
+        {
+            std::lock_guard<std::mutex> lock(g_secondaryMutex);
+            for (int o = 0; o < kMaxSecondaryOutputs; ++o) {
+                g_secondaryActive[o].store(nullptr, std::memory_order_release);
+                g_secondaryOwned[o].reset();
+            }
+        }
+        g_autoDj.reset();
+        g_sampler.reset();
+        g_crateDigger.reset();
+        logFile << "[ShredEngine] CrateDigger destroyed" << std::endl;
         g_deck2.reset();
         logFile << "[ShredEngine] Deck 2 destroyed" << std::endl;
         logFile.flush();
@@ -405,6 +577,15 @@ SHRED_API void SetAutoGainReductionEnabled(bool enabled) {
     }
 }
 
+SHRED_API void SetTruePeakLimiterEnabled(bool enabled) {
+    try {
+        if (g_mixer) g_mixer->setTruePeakLimiterEnabled(enabled);
+        std::cout << "[ShredEngine] True-peak limiter " << (enabled ? "enabled" : "disabled") << std::endl;
+    } catch (std::exception& e) {
+        std::cout << "[ShredEngine] Exception in SetTruePeakLimiterEnabled: " << e.what() << std::endl;
+    }
+}
+
 SHRED_API void SetBrickwallLimiterEnabled(bool enabled) {
     try {
         if (g_mixer) g_mixer->setBrickwallLimiterEnabled(enabled);
@@ -477,6 +658,33 @@ SHRED_API float GetCurrentRmsLevel() {
     }
 }
 
+SHRED_API float GetTruePeakLevel() {
+    try {
+        return g_mixer ? g_mixer->getTruePeakLevel() : 0.0f;
+    } catch (std::exception& e) {
+        std::cout << "[ShredEngine] Exception in GetTruePeakLevel: " << e.what() << std::endl;
+        return 0.0f;
+    }
+}
+
+SHRED_API float GetMomentaryLoudness() {
+    try {
+        return g_mixer ? g_mixer->getMomentaryLoudness() : -70.0f;
+    } catch (std::exception& e) {
+        std::cout << "[ShredEngine] Exception in GetMomentaryLoudness: " << e.what() << std::endl;
+        return -70.0f;
+    }
+}
+
+SHRED_API float GetShortTermLoudness() {
+    try {
+        return g_mixer ? g_mixer->getShortTermLoudness() : -70.0f;
+    } catch (std::exception& e) {
+        std::cout << "[ShredEngine] Exception in GetShortTermLoudness: " << e.what() << std::endl;
+        return -70.0f;
+    }
+}
+
 SHRED_API bool IsClipping() {
     try {
         return g_mixer ? g_mixer->isClipping() : false;
@@ -486,3 +694,915 @@ SHRED_API bool IsClipping() {
     }
 }
 
+SHRED_API int GetLimiterLatency() {
+    try {
+        return g_mixer ? g_mixer->getLookAheadLatency() : 0;
+    } catch (std::exception& e) {
+        std::cout << "[ShredEngine] Exception in GetLimiterLatency: " << e.what() << std::endl;
+        return 0;
+    }
+}
+
+// ============================================================================
+// Track Prefetch Interop Functions
+// ============================================================================
+
+SHRED_API void HintTrack(const char* filePath, int priority) {
+    try {
+        if (g_crateDigger && filePath) g_crateDigger->hint(filePath, priority);
+        else std::cout << "[ShredEngine] Prefetch not initialized" << std::endl;
+    } catch (std::exception& e) {
+        std::cout << "[ShredEngine] Exception in HintTrack: " << e.what() << std::endl;
+    }
+}
+
+SHRED_API void ClearTrackHints() {
+    try {
+        if (g_crateDigger) g_crateDigger->clearHints();
+    } catch (std::exception& e) {
+        std::cout << "[ShredEngine] Exception in ClearTrackHints: " << e.what() << std::endl;
+    }
+}
+
+SHRED_API bool IsTrackPrefetched(const char* filePath) {
+    try {
+        return g_crateDigger && filePath ? g_crateDigger->isCached(filePath) : false;
+    } catch (std::exception& e) {
+        std::cout << "[ShredEngine] Exception in IsTrackPrefetched: " << e.what() << std::endl;
+        return false;
+    }
+}
+
+SHRED_API void SetPrefetchMemoryBudget(int megabytes) {
+    try {
+        if (g_crateDigger) g_crateDigger->setMemoryBudget((size_t)std::max(0, megabytes) * 1024 * 1024);
+        std::cout << "[ShredEngine] Prefetch memory budget set to " << megabytes << " MB" << std::endl;
+    } catch (std::exception& e) {
+        std::cout << "[ShredEngine] Exception in SetPrefetchMemoryBudget: " << e.what() << std::endl;
+    }
+}
+
+SHRED_API float GetAudioLoad() {
+    return engineStats().audioLoad.load(std::memory_order_relaxed);
+}
+
+SHRED_API float GetAudioLoadPeak() {
+    // Peak since the previous read
+    return engineStats().audioLoadPeak.exchange(0.0f, std::memory_order_relaxed);
+}
+
+SHRED_API float GetOutputDspLoad() {
+    return engineStats().outputDspLoad.load(std::memory_order_relaxed);
+}
+
+// ============================================================================
+// Track Memory Interop Functions
+// ============================================================================
+
+SHRED_API void SetTrackMemoryLocking(bool enabled) {
+    try {
+        if (g_deck1) g_deck1->setMemoryLocked(enabled);
+        if (g_deck2) g_deck2->setMemoryLocked(enabled);
+        std::cout << "[ShredEngine] Track memory locking " << (enabled ? "enabled" : "disabled") << std::endl;
+    } catch (std::exception& e) {
+        std::cout << "[ShredEngine] Exception in SetTrackMemoryLocking: " << e.what() << std::endl;
+    }
+}
+
+SHRED_API long long GetAudioMinorFaults() {
+    return (long long)engineStats().audioMinorFaults.load(std::memory_order_relaxed);
+}
+
+SHRED_API long long GetAudioMajorFaults() {
+    return (long long)engineStats().audioMajorFaults.load(std::memory_order_relaxed);
+}
+
+// ============================================================================
+// Variable Speed Interop Functions
+// ============================================================================
+
+SHRED_API void SetPlaybackRate(int deck, double ratio) {
+    try {
+        if (ScratchBuffer* d = getDeck(deck)) d->setSpeed(ratio);
+        else std::cout << "[ShredEngine] Invalid deck or not initialized: " << deck << std::endl;
+    } catch (std::exception& e) {
+        std::cout << "[ShredEngine] Exception in SetPlaybackRate: " << e.what() << std::endl;
+    }
+}
+
+SHRED_API double GetPlaybackRate(int deck) {
+    ScratchBuffer* d = getDeck(deck);
+    return d ? d->getSpeed() : 0.0;
+}
+
+SHRED_API void SetInterpolationMode(int deck, int mode) {
+    try {
+        if (ScratchBuffer* d = getDeck(deck)) d->setInterpolation(mode);
+        else std::cout << "[ShredEngine] Invalid deck or not initialized: " << deck << std::endl;
+    } catch (std::exception& e) {
+        std::cout << "[ShredEngine] Exception in SetInterpolationMode: " << e.what() << std::endl;
+    }
+}
+
+// ============================================================================
+// Key-Lock Interop Functions
+// ============================================================================
+
+SHRED_API void SetKeyLock(int deck, bool enabled) {
+    try {
+        if (ScratchBuffer* d = getDeck(deck)) d->setKeyLock(enabled);
+        else std::cout << "[ShredEngine] Invalid deck or not initialized: " << deck << std::endl;
+    } catch (std::exception& e) {
+        std::cout << "[ShredEngine] Exception in SetKeyLock: " << e.what() << std::endl;
+    }
+}
+
+SHRED_API void SetKeyLockMode(int deck, int mode) {
+    try {
+        if (ScratchBuffer* d = getDeck(deck)) d->setKeyLockMode(mode);
+        else std::cout << "[ShredEngine] Invalid deck or not initialized: " << deck << std::endl;
+    } catch (std::exception& e) {
+        std::cout << "[ShredEngine] Exception in SetKeyLockMode: " << e.what() << std::endl;
+    }
+}
+
+SHRED_API double GetKeyLockLatency(int deck) {
+    ScratchBuffer* d = getDeck(deck);
+    return d ? d->getKeyLockLatencyMs() : 0.0;
+}
+
+// ============================================================================
+// Key Shift Interop Functions
+// ============================================================================
+
+SHRED_API void SetKeyShift(int deck, double semitones) {
+    try {
+        if (ScratchBuffer* d = getDeck(deck)) d->setKeyShift(semitones);
+        else std::cout << "[ShredEngine] Invalid deck or not initialized: " << deck << std::endl;
+    } catch (std::exception& e) {
+        std::cout << "[ShredEngine] Exception in SetKeyShift: " << e.what() << std::endl;
+    }
+}
+
+SHRED_API double GetKeyShift(int deck) {
+    ScratchBuffer* d = getDeck(deck);
+    return d ? d->getKeyShift() : 0.0;
+}
+
+SHRED_API float GetKeyShiftLoad(int deck) {
+    if (deck < 1 || deck > EngineStats::kMaxDecks) return 0.0f;
+    return engineStats().deckShiftLoad[deck - 1].load(std::memory_order_relaxed);
+}
+
+// ============================================================================
+// Scratch Interop Functions
+// ============================================================================
+
+// Jog reports arrive at up to 1 kHz; they only queue an event and don't log
+SHRED_API void JogTouch(int deck, bool touched) {
+    if (ScratchBuffer* d = getDeck(deck)) d->jogTouch(touched);
+}
+
+SHRED_API void JogPosition(int deck, double seconds) {
+    if (ScratchBuffer* d = getDeck(deck)) d->jogPosition(seconds);
+}
+
+SHRED_API void JogVelocity(int deck, double ratio) {
+    if (ScratchBuffer* d = getDeck(deck)) d->jogVelocity(ratio);
+}
+
+SHRED_API void VinylBrake(int deck, double seconds) {
+    try {
+        if (ScratchBuffer* d = getDeck(deck)) d->brake(seconds);
+        else std::cout << "[ShredEngine] Invalid deck or not initialized: " << deck << std::endl;
+    } catch (std::exception& e) {
+        std::cout << "[ShredEngine] Exception in VinylBrake: " << e.what() << std::endl;
+    }
+}
+
+SHRED_API void VinylSpinback(int deck, double speed, double seconds) {
+    try {
+        if (ScratchBuffer* d = getDeck(deck)) d->spinback(speed, seconds);
+        else std::cout << "[ShredEngine] Invalid deck or not initialized: " << deck << std::endl;
+    } catch (std::exception& e) {
+        std::cout << "[ShredEngine] Exception in VinylSpinback: " << e.what() << std::endl;
+    }
+}
+
+SHRED_API void SetPlatterInertia(int deck, double seconds) {
+    try {
+        if (ScratchBuffer* d = getDeck(deck)) d->setPlatterInertia(seconds);
+        else std::cout << "[ShredEngine] Invalid deck or not initialized: " << deck << std::endl;
+    } catch (std::exception& e) {
+        std::cout << "[ShredEngine] Exception in SetPlatterInertia: " << e.what() << std::endl;
+    }
+}
+
+// ============================================================================
+// Loop Interop Functions
+// ============================================================================
+
+SHRED_API void SetBeatGrid(int deck, double bpm, double firstBeatSeconds) {
+    try {
+        if (ScratchBuffer* d = getDeck(deck)) d->setBeatGrid(bpm, firstBeatSeconds);
+        else std::cout << "[ShredEngine] Invalid deck or not initialized: " << deck << std::endl;
+    } catch (std::exception& e) {
+        std::cout << "[ShredEngine] Exception in SetBeatGrid: " << e.what() << std::endl;
+    }
+}
+
+SHRED_API void LoopIn(int deck) {
+    try {
+        if (ScratchBuffer* d = getDeck(deck)) d->loopIn();
+        else std::cout << "[ShredEngine] Invalid deck or not initialized: " << deck << std::endl;
+    } catch (std::exception& e) {
+        std::cout << "[ShredEngine] Exception in LoopIn: " << e.what() << std::endl;
+    }
+}
+
+SHRED_API void LoopOut(int deck) {
+    try {
+        if (ScratchBuffer* d = getDeck(deck)) d->loopOut();
+        else std::cout << "[ShredEngine] Invalid deck or not initialized: " << deck << std::endl;
+    } catch (std::exception& e) {
+        std::cout << "[ShredEngine] Exception in LoopOut: " << e.what() << std::endl;
+    }
+}
+
+SHRED_API void SetLoop(int deck, long long inFrame, long long outFrame) {
+    try {
+        if (ScratchBuffer* d = getDeck(deck)) d->setLoop(inFrame, outFrame);
+        else std::cout << "[ShredEngine] Invalid deck or not initialized: " << deck << std::endl;
+    } catch (std::exception& e) {
+        std::cout << "[ShredEngine] Exception in SetLoop: " << e.what() << std::endl;
+    }
+}
+
+SHRED_API void BeatLoop(int deck, double beats) {
+    try {
+        if (ScratchBuffer* d = getDeck(deck)) d->beatLoop(beats);
+        else std::cout << "[ShredEngine] Invalid deck or not initialized: " << deck << std::endl;
+    } catch (std::exception& e) {
+        std::cout << "[ShredEngine] Exception in BeatLoop: " << e.what() << std::endl;
+    }
+}
+
+SHRED_API void LoopRoll(int deck, double beats) {
+    try {
+        if (ScratchBuffer* d = getDeck(deck)) d->loopRoll(beats);
+        else std::cout << "[ShredEngine] Invalid deck or not initialized: " << deck << std::endl;
+    } catch (std::exception& e) {
+        std::cout << "[ShredEngine] Exception in LoopRoll: " << e.what() << std::endl;
+    }
+}
+
+SHRED_API void LoopRollRelease(int deck) {
+    try {
+        if (ScratchBuffer* d = getDeck(deck)) d->loopRollRelease();
+        else std::cout << "[ShredEngine] Invalid deck or not initialized: " << deck << std::endl;
+    } catch (std::exception& e) {
+        std::cout << "[ShredEngine] Exception in LoopRollRelease: " << e.what() << std::endl;
+    }
+}
+
+SHRED_API void LoopHalve(int deck) {
+    try {
+        if (ScratchBuffer* d = getDeck(deck)) d->loopHalve();
+        else std::cout << "[ShredEngine] Invalid deck or not initialized: " << deck << std::endl;
+    } catch (std::exception& e) {
+        std::cout << "[ShredEngine] Exception in LoopHalve: " << e.what() << std::endl;
+    }
+}
+
+SHRED_API void LoopDouble(int deck) {
+    try {
+        if (ScratchBuffer* d = getDeck(deck)) d->loopDouble();
+        else std::cout << "[ShredEngine] Invalid deck or not initialized: " << deck << std::endl;
+    } catch (std::exception& e) {
+        std::cout << "[ShredEngine] Exception in LoopDouble: " << e.what() << std::endl;
+    }
+}
+
+SHRED_API void LoopExit(int deck) {
+    try {
+        if (ScratchBuffer* d = getDeck(deck)) d->loopExit();
+        else std::cout << "[ShredEngine] Invalid deck or not initialized: " << deck << std::endl;
+    } catch (std::exception& e) {
+        std::cout << "[ShredEngine] Exception in LoopExit: " << e.what() << std::endl;
+    }
+}
+
+SHRED_API void Reloop(int deck) {
+    try {
+        if (ScratchBuffer* d = getDeck(deck)) d->reloop();
+        else std::cout << "[ShredEngine] Invalid deck or not initialized: " << deck << std::endl;
+    } catch (std::exception& e) {
+        std::cout << "[ShredEngine] Exception in Reloop: " << e.what() << std::endl;
+    }
+}
+
+SHRED_API long long GetLoopIn(int deck) {
+    ScratchBuffer* d = getDeck(deck);
+    return d ? d->getLoopIn() : -1;
+}
+
+SHRED_API long long GetLoopOut(int deck) {
+    ScratchBuffer* d = getDeck(deck);
+    return d ? d->getLoopOut() : -1;
+}
+
+SHRED_API bool IsLoopActive(int deck) {
+    ScratchBuffer* d = getDeck(deck);
+    return d ? d->isLoopActive() : false;
+}
+
+// ============================================================================
+// Hot Cue Interop Functions
+// ============================================================================
+
+SHRED_API void SetHotCue(int deck, int index) {
+    try {
+        if (ScratchBuffer* d = getDeck(deck)) d->setHotCue(index, -1.0);
+        else std::cout << "[ShredEngine] Invalid deck or not initialized: " << deck << std::endl;
+    } catch (std::exception& e) {
+        std::cout << "[ShredEngine] Exception in SetHotCue: " << e.what() << std::endl;
+    }
+}
+
+SHRED_API void SetHotCueAt(int deck, int index, double seconds) {
+    try {
+        if (ScratchBuffer* d = getDeck(deck)) d->setHotCue(index, std::max(0.0, seconds));
+        else std::cout << "[ShredEngine] Invalid deck or not initialized: " << deck << std::endl;
+    } catch (std::exception& e) {
+        std::cout << "[ShredEngine] Exception in SetHotCueAt: " << e.what() << std::endl;
+    }
+}
+
+SHRED_API void ClearHotCue(int deck, int index) {
+    try {
+        if (ScratchBuffer* d = getDeck(deck)) d->clearHotCue(index);
+        else std::cout << "[ShredEngine] Invalid deck or not initialized: " << deck << std::endl;
+    } catch (std::exception& e) {
+        std::cout << "[ShredEngine] Exception in ClearHotCue: " << e.what() << std::endl;
+    }
+}
+
+SHRED_API void JumpToHotCue(int deck, int index) {
+    try {
+        if (ScratchBuffer* d = getDeck(deck)) d->jumpToHotCue(index);
+        else std::cout << "[ShredEngine] Invalid deck or not initialized: " << deck << std::endl;
+    } catch (std::exception& e) {
+        std::cout << "[ShredEngine] Exception in JumpToHotCue: " << e.what() << std::endl;
+    }
+}
+
+SHRED_API double GetHotCue(int deck, int index) {
+    ScratchBuffer* d = getDeck(deck);
+    return d ? d->getHotCue(index) : -1.0;
+}
+
+SHRED_API void SetQuantize(int deck, bool enabled) {
+    try {
+        if (ScratchBuffer* d = getDeck(deck)) d->setQuantize(enabled);
+        else std::cout << "[ShredEngine] Invalid deck or not initialized: " << deck << std::endl;
+    } catch (std::exception& e) {
+        std::cout << "[ShredEngine] Exception in SetQuantize: " << e.what() << std::endl;
+    }
+}
+
+// ============================================================================
+// Transport Fade Interop Functions
+// ============================================================================
+
+SHRED_API void SetTransportFade(int deck, double ms) {
+    try {
+        if (ScratchBuffer* d = getDeck(deck)) d->setTransportFade(ms);
+        else std::cout << "[ShredEngine] Invalid deck or not initialized: " << deck << std::endl;
+    } catch (std::exception& e) {
+        std::cout << "[ShredEngine] Exception in SetTransportFade: " << e.what() << std::endl;
+    }
+}
+
+SHRED_API double GetTransportFade(int deck) {
+    ScratchBuffer* d = getDeck(deck);
+    return d ? d->getTransportFade() : 0.0;
+}
+
+// ============================================================================
+// Slip Interop Functions
+// ============================================================================
+
+SHRED_API void SetSlip(int deck, bool enabled) {
+    try {
+        if (ScratchBuffer* d = getDeck(deck)) d->setSlip(enabled);
+        else std::cout << "[ShredEngine] Invalid deck or not initialized: " << deck << std::endl;
+    } catch (std::exception& e) {
+        std::cout << "[ShredEngine] Exception in SetSlip: " << e.what() << std::endl;
+    }
+}
+
+SHRED_API bool GetSlip(int deck) {
+    ScratchBuffer* d = getDeck(deck);
+    return d ? d->getSlip() : false;
+}
+
+SHRED_API void SetReverse(int deck, bool enabled) {
+    try {
+        if (ScratchBuffer* d = getDeck(deck)) d->setReverse(enabled);
+        else std::cout << "[ShredEngine] Invalid deck or not initialized: " << deck << std::endl;
+    } catch (std::exception& e) {
+        std::cout << "[ShredEngine] Exception in SetReverse: " << e.what() << std::endl;
+    }
+}
+
+SHRED_API void ReleaseHotCue(int deck) {
+    try {
+        if (ScratchBuffer* d = getDeck(deck)) d->releaseHotCue();
+        else std::cout << "[ShredEngine] Invalid deck or not initialized: " << deck << std::endl;
+    } catch (std::exception& e) {
+        std::cout << "[ShredEngine] Exception in ReleaseHotCue: " << e.what() << std::endl;
+    }
+}
+
+SHRED_API double GetSlipPosition(int deck) {
+    ScratchBuffer* d = getDeck(deck);
+    return d ? d->getSlipPosition() : -1.0;
+}
+
+// ============================================================================
+// Master Clock and Sync Interop Functions
+// ============================================================================
+
+SHRED_API void SetMasterTempo(double bpm) {
+    try {
+        g_clock.setTempo(bpm);
+        std::cout << "[ShredEngine] Master tempo set to " << bpm << std::endl;
+    } catch (std::exception& e) {
+        std::cout << "[ShredEngine] Exception in SetMasterTempo: " << e.what() << std::endl;
+    }
+}
+
+SHRED_API double GetMasterTempo() {
+    return g_clock.getTempo();
+}
+
+SHRED_API double GetMasterBeat() {
+    return g_clock.getBeat();
+}
+
+SHRED_API void SetSyncLeader(int deck) {
+    try {
+        if (deck != 0 && !getDeck(deck)) {
+            std::cout << "[ShredEngine] Invalid deck or not initialized: " << deck << std::endl;
+            return;
+        }
+        g_syncLeader = deck;
+        if (g_deck1) g_deck1->setSyncLeader(deck == 1);
+        if (g_deck2) g_deck2->setSyncLeader(deck == 2);
+        std::cout << "[ShredEngine] Sync leader: " << (deck == 0 ? std::string("internal clock") : "deck " + std::to_string(deck)) << std::endl;
+    } catch (std::exception& e) {
+        std::cout << "[ShredEngine] Exception in SetSyncLeader: " << e.what() << std::endl;
+    }
+}
+
+SHRED_API int GetSyncLeader() {
+    return g_syncLeader.load(std::memory_order_relaxed);
+}
+
+SHRED_API void SetSync(int deck, bool enabled) {
+    try {
+        if (ScratchBuffer* d = getDeck(deck)) d->setSync(enabled);
+        else std::cout << "[ShredEngine] Invalid deck or not initialized: " << deck << std::endl;
+    } catch (std::exception& e) {
+        std::cout << "[ShredEngine] Exception in SetSync: " << e.what() << std::endl;
+    }
+}
+
+SHRED_API int GetSyncState(int deck) {
+    ScratchBuffer* d = getDeck(deck);
+    return d ? d->getSyncState() : ScratchBuffer::SYNC_OFF;
+}
+
+SHRED_API double GetPhaseError(int deck) {
+    ScratchBuffer* d = getDeck(deck);
+    return d ? d->getPhaseError() : 0.0;
+}
+
+// ============================================================================
+// Scheduled Action Interop Functions
+// ============================================================================
+
+SHRED_API bool ScheduleAction(int deck, int action, double value, int timeBase, double time) {
+    try {
+        if (ScratchBuffer* d = getDeck(deck)) return d->schedule(action, value, timeBase, time);
+        std::cout << "[ShredEngine] Invalid deck or not initialized: " << deck << std::endl;
+    } catch (std::exception& e) {
+        std::cout << "[ShredEngine] Exception in ScheduleAction: " << e.what() << std::endl;
+    }
+    return false;
+}
+
+SHRED_API void CancelScheduledActions(int deck) {
+    try {
+        if (ScratchBuffer* d = getDeck(deck)) d->cancelScheduled();
+        else std::cout << "[ShredEngine] Invalid deck or not initialized: " << deck << std::endl;
+    } catch (std::exception& e) {
+        std::cout << "[ShredEngine] Exception in CancelScheduledActions: " << e.what() << std::endl;
+    }
+}
+
+SHRED_API long long GetEngineFrame() {
+    return g_clock.getFrame();
+}
+
+// ============================================================================
+// Stem Interop Functions
+// ============================================================================
+
+SHRED_API int GetStemCount(int deck) {
+    ScratchBuffer* d = getDeck(deck);
+    return d ? d->getStemCount() : 0;
+}
+
+SHRED_API void SetStemGain(int deck, int stem, float gain) {
+    try {
+        if (ScratchBuffer* d = getDeck(deck)) d->setStemGain(stem, gain);
+        else std::cout << "[ShredEngine] Invalid deck or not initialized: " << deck << std::endl;
+    } catch (std::exception& e) {
+        std::cout << "[ShredEngine] Exception in SetStemGain: " << e.what() << std::endl;
+    }
+}
+
+SHRED_API void SetStemMute(int deck, int stem, bool muted) {
+    try {
+        if (ScratchBuffer* d = getDeck(deck)) d->setStemMute(stem, muted);
+        else std::cout << "[ShredEngine] Invalid deck or not initialized: " << deck << std::endl;
+    } catch (std::exception& e) {
+        std::cout << "[ShredEngine] Exception in SetStemMute: " << e.what() << std::endl;
+    }
+}
+
+// ============================================================================
+// Sampler Interop Functions
+// ============================================================================
+
+SHRED_API int LoadSample(int slot, const char* filePath) {
+    try {
+        if (!g_sampler || !filePath) {
+            std::cout << "[ShredEngine] Sampler not initialized" << std::endl;
+            return -1;
+        }
+        std::shared_ptr<const DecodedTrack> sample = g_crateDigger ? g_crateDigger->take(filePath) : nullptr;
+        if (!sample) sample = ScratchBuffer::decodeFile(filePath);
+        if (sample && g_sampler->loadSlot(slot, sample)) return 0;
+        std::cout << "[ShredEngine] Failed to load sample into slot " << slot << std::endl;
+        return -1;
+    } catch (std::exception& e) {
+        std::cout << "[ShredEngine] Exception in LoadSample: " << e.what() << std::endl;
+        return -1;
+    }
+}
+
+SHRED_API void ClearSample(int slot) {
+    try {
+        if (g_sampler) g_sampler->clearSlot(slot);
+    } catch (std::exception& e) {
+        std::cout << "[ShredEngine] Exception in ClearSample: " << e.what() << std::endl;
+    }
+}
+
+SHRED_API bool TriggerSample(int slot, float gain, double semitones) {
+    return g_sampler ? g_sampler->trigger(slot, gain, semitones) : false;
+}
+
+SHRED_API void StopSample(int slot) {
+    if (g_sampler) g_sampler->stopSlot(slot);
+}
+
+SHRED_API void StopAllSamples() {
+    if (g_sampler) g_sampler->stopAll();
+}
+
+SHRED_API void SetSamplerVolume(float volume) {
+    if (g_sampler) g_sampler->setVolume(volume);
+}
+
+SHRED_API int GetSamplerSlotCount() {
+    return g_sampler ? g_sampler->getSlotCount() : 0;
+}
+
+SHRED_API int GetSamplerVoices() {
+    return g_sampler ? g_sampler->getActiveVoices() : 0;
+}
+
+SHRED_API long long GetSamplerStolenVoices() {
+    return g_sampler ? (long long)g_sampler->getStolenVoices() : 0;
+}
+
+// ============================================================================
+// Auto-DJ Interop Functions
+// ============================================================================
+
+SHRED_API void AutoDjEnqueue(const char* filePath, double introSeconds, double outroSeconds) {
+    try {
+        if (g_autoDj && filePath) g_autoDj->enqueue(filePath, introSeconds, outroSeconds);
+        else std::cout << "[ShredEngine] Auto-DJ not initialized" << std::endl;
+    } catch (std::exception& e) {
+        std::cout << "[ShredEngine] Exception in AutoDjEnqueue: " << e.what() << std::endl;
+    }
+}
+
+SHRED_API void AutoDjClearQueue() {
+    try {
+        if (g_autoDj) g_autoDj->clearQueue();
+    } catch (std::exception& e) {
+        std::cout << "[ShredEngine] Exception in AutoDjClearQueue: " << e.what() << std::endl;
+    }
+}
+
+SHRED_API int AutoDjGetQueueLength() {
+    try {
+        return g_autoDj ? g_autoDj->getQueueLength() : 0;
+    } catch (std::exception& e) {
+        std::cout << "[ShredEngine] Exception in AutoDjGetQueueLength: " << e.what() << std::endl;
+        return 0;
+    }
+}
+
+SHRED_API void AutoDjSetCrossfade(double seconds) {
+    if (g_autoDj) g_autoDj->setCrossfade(seconds);
+}
+
+SHRED_API bool AutoDjStart(int deck, double outroSeconds) {
+    try {
+        if (g_autoDj && getDeck(deck)) return g_autoDj->start(deck - 1, outroSeconds);
+        std::cout << "[ShredEngine] Invalid deck or not initialized: " << deck << std::endl;
+    } catch (std::exception& e) {
+        std::cout << "[ShredEngine] Exception in AutoDjStart: " << e.what() << std::endl;
+    }
+    return false;
+}
+
+SHRED_API void AutoDjStop() {
+    try {
+        if (!g_autoDj) return;
+        // Leave the crossfader where the automation had it
+        if (g_mixer && g_autoDj->isActive()) g_mixer->setCrossfader(g_autoDj->getCrossfader());
+        g_autoDj->stop();
+    } catch (std::exception& e) {
+        std::cout << "[ShredEngine] Exception in AutoDjStop: " << e.what() << std::endl;
+    }
+}
+
+SHRED_API int AutoDjGetCurrentDeck() {
+    int deck = g_autoDj ? g_autoDj->getCurrentDeck() : -1;
+    return deck < 0 ? 0 : deck + 1;
+}
+
+SHRED_API long long AutoDjGetHandovers() {
+    return g_autoDj ? (long long)g_autoDj->getHandovers() : 0;
+}
+
+// ============================================================================
+// Channel EQ Interop Functions
+// ============================================================================
+
+// Knobs move at UI rate; the EQ ramps between values, so setters don't log
+SHRED_API void SetEqGain(int deck, int band, float gain) {
+    if (g_mixer && getDeck(deck)) g_mixer->eq().setGain(deck - 1, band, gain);
+}
+
+SHRED_API float GetEqGain(int deck, int band) {
+    return g_mixer && getDeck(deck) ? g_mixer->eq().getGain(deck - 1, band) : 1.0f;
+}
+
+SHRED_API void SetEqKill(int deck, int band, bool killed) {
+    if (g_mixer && getDeck(deck)) g_mixer->eq().setKill(deck - 1, band, killed);
+}
+
+SHRED_API void SetEqMode(int mode) {
+    try {
+        if (g_mixer) g_mixer->eq().setMode(mode);
+    } catch (std::exception& e) {
+        std::cout << "[ShredEngine] Exception in SetEqMode: " << e.what() << std::endl;
+    }
+}
+
+SHRED_API void SetEqCrossovers(float lowHz, float highHz) {
+    try {
+        if (g_mixer) g_mixer->eq().setCrossovers(lowHz, highHz);
+        std::cout << "[ShredEngine] EQ crossovers set to " << lowHz << " Hz / " << highHz << " Hz" << std::endl;
+    } catch (std::exception& e) {
+        std::cout << "[ShredEngine] Exception in SetEqCrossovers: " << e.what() << std::endl;
+    }
+}
+
+// ============================================================================
+// Channel Filter Interop Functions
+// ============================================================================
+
+SHRED_API void SetFilter(int deck, float position) {
+    if (g_mixer && getDeck(deck)) g_mixer->filter(deck - 1).setPosition(position);
+}
+
+SHRED_API float GetFilter(int deck) {
+    return g_mixer && getDeck(deck) ? g_mixer->filter(deck - 1).getPosition() : 0.0f;
+}
+
+SHRED_API void SetFilterResonance(int deck, float resonance) {
+    if (g_mixer && getDeck(deck)) g_mixer->filter(deck - 1).setResonance(resonance);
+}
+
+// ============================================================================
+// Effects Interop Functions
+// ============================================================================
+
+// Deck 0 is the master rack
+static EffectRack* effectRack(int deck) {
+    if (!g_mixer) return nullptr;
+    if (deck == 0) return &g_mixer->masterEffects();
+    return getDeck(deck) ? &g_mixer->channelEffects(deck - 1) : nullptr;
+}
+
+SHRED_API bool SetEffect(int deck, int slot, int type) {
+    try {
+        EffectRack* rack = effectRack(deck);
+        if (!rack || !rack->setEffect(slot, type)) {
+            std::cout << "[ShredEngine] SetEffect: invalid deck " << deck << ", slot " << slot << " or type " << type << std::endl;
+            return false;
+        }
+        std::cout << "[ShredEngine] Effect slot " << slot << " on " << (deck == 0 ? "master" : "deck " + std::to_string(deck))
+                  << " set to type " << type << std::endl;
+        return true;
+    } catch (std::exception& e) {
+        std::cout << "[ShredEngine] Exception in SetEffect: " << e.what() << std::endl;
+        return false;
+    }
+}
+
+// Loads an impulse response file into a slot as a convolution effect
+SHRED_API bool LoadConvolution(int deck, int slot, const char* filePath) {
+    try {
+        EffectRack* rack = effectRack(deck);
+        if (!rack || !filePath) {
+            std::cout << "[ShredEngine] LoadConvolution: invalid deck " << deck << std::endl;
+            return false;
+        }
+        std::shared_ptr<DecodedTrack> impulse = ScratchBuffer::decodeFile(filePath);
+        std::unique_ptr<Effect> effect = impulse ? Effect::createConvolution(*impulse) : nullptr;
+        if (!effect || !rack->setEffect(slot, std::move(effect))) {
+            std::cout << "[ShredEngine] Failed to load impulse response " << filePath << " into slot " << slot << std::endl;
+            return false;
+        }
+        std::cout << "[ShredEngine] Loaded impulse response " << filePath << " (" << impulse->length << " frames) into slot "
+                  << slot << std::endl;
+        return true;
+    } catch (std::exception& e) {
+        std::cout << "[ShredEngine] Exception in LoadConvolution: " << e.what() << std::endl;
+        return false;
+    }
+}
+
+SHRED_API int GetEffect(int deck, int slot) {
+    EffectRack* rack = effectRack(deck);
+    return rack ? rack->getEffect(slot) : Effect::NONE;
+}
+
+SHRED_API void SetEffectEnabled(int deck, int slot, bool enabled) {
+    if (EffectRack* rack = effectRack(deck)) rack->setEnabled(slot, enabled);
+}
+
+SHRED_API bool IsEffectEnabled(int deck, int slot) {
+    EffectRack* rack = effectRack(deck);
+    return rack && rack->isEnabled(slot);
+}
+
+// Knobs move at UI rate; the rack ramps between values, so these don't log
+SHRED_API void SetEffectMix(int deck, int slot, float mix) {
+    if (EffectRack* rack = effectRack(deck)) rack->setMix(slot, mix);
+}
+
+SHRED_API void SetEffectParameter(int deck, int slot, int index, float value) {
+    if (EffectRack* rack = effectRack(deck)) rack->setParameter(slot, index, value);
+}
+
+SHRED_API float GetEffectParameter(int deck, int slot, int index) {
+    EffectRack* rack = effectRack(deck);
+    return rack ? rack->getParameter(slot, index) : 0.0f;
+}
+
+// ============================================================================
+// Headphone Cue Interop Functions
+// ============================================================================
+
+SHRED_API void SetCue(int deck, bool cued) {
+    if (g_mixer && getDeck(deck)) g_mixer->setCue(deck - 1, cued);
+}
+
+SHRED_API bool IsCued(int deck) {
+    return g_mixer && getDeck(deck) && g_mixer->isCued(deck - 1);
+}
+
+// Knobs move at UI rate; the cue bus ramps between values, so these don't log
+SHRED_API void SetCueMix(float mix) {
+    if (g_mixer) g_mixer->setCueMix(mix);
+}
+
+SHRED_API void SetCueVolume(float gain) {
+    if (g_mixer) g_mixer->setCueVolume(gain);
+}
+
+SHRED_API void SetSplitCue(bool split) {
+    try {
+        if (g_mixer) g_mixer->setSplitCue(split);
+        std::cout << "[ShredEngine] Split cue " << (split ? "on" : "off") << std::endl;
+    } catch (std::exception& e) {
+        std::cout << "[ShredEngine] Exception in SetSplitCue: " << e.what() << std::endl;
+    }
+}
+
+SHRED_API bool HasCueOutput() {
+    return g_stream && g_outputChannels >= 4;
+}
+
+// ============================================================================
+// Secondary Output Interop Functions
+// ============================================================================
+
+// 1-based output number to slot, -1 if invalid
+static int secondarySlot(int output) {
+    return output >= 1 && output <= kMaxSecondaryOutputs ? output - 1 : -1;
+}
+
+SHRED_API int OpenSecondaryOutput(int device, int source) {
+    try {
+        std::lock_guard<std::mutex> lock(g_secondaryMutex);
+        if (!g_stream) {
+            std::cout << "[ShredEngine] OpenSecondaryOutput: engine not running" << std::endl;
+            return 0;
+        }
+        for (int o = 0; o < kMaxSecondaryOutputs; ++o) {
+            if (g_secondaryOwned[o]) continue;
+            // Started before the callback feeds it; it plays silence until
+            // its ring has filled to the target
+            auto output = std::make_unique<SecondaryOutput>(source);
+            if (!output->start(device)) return 0;
+            g_secondaryOwned[o] = std::move(output);
+            g_secondaryActive[o].store(g_secondaryOwned[o].get(), std::memory_order_release);
+            std::cout << "[ShredEngine] Secondary output " << (o + 1) << " on device " << device << std::endl;
+            return o + 1;
+        }
+        std::cout << "[ShredEngine] OpenSecondaryOutput: all " << kMaxSecondaryOutputs << " outputs in use" << std::endl;
+        return 0;
+    } catch (std::exception& e) {
+        std::cout << "[ShredEngine] Exception in OpenSecondaryOutput: " << e.what() << std::endl;
+        return 0;
+    }
+}
+
+SHRED_API void CloseSecondaryOutput(int output) {
+    try {
+        std::lock_guard<std::mutex> lock(g_secondaryMutex);
+        int slot = secondarySlot(output);
+        if (slot < 0 || !g_secondaryOwned[slot]) return;
+        // Unpublish, then let the callback finish any block that may still
+        // be pushing into it. If the stream is not running nothing is, so
+        // give up waiting after a few buffers' worth of time.
+        g_secondaryActive[slot].store(nullptr, std::memory_order_release);
+        EngineStats& stats = engineStats();
+        uint64_t callbacks = stats.callbackCount.load(std::memory_order_acquire);
+        for (int i = 0; i < 50 && stats.callbackCount.load(std::memory_order_acquire) < callbacks + 2; ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+        g_secondaryOwned[slot].reset();
+        std::cout << "[ShredEngine] Secondary output " << output << " closed" << std::endl;
+    } catch (std::exception& e) {
+        std::cout << "[ShredEngine] Exception in CloseSecondaryOutput: " << e.what() << std::endl;
+    }
+}
+
+// Metrics are polled at UI rate, so these don't log. The lock keeps the
+// output alive against a concurrent close.
+SHRED_API float GetSecondaryOutputFill(int output) {
+    std::lock_guard<std::mutex> lock(g_secondaryMutex);
+    int slot = secondarySlot(output);
+    return slot >= 0 && g_secondaryOwned[slot] ? g_secondaryOwned[slot]->fill() : 0.0f;
+}
+
+SHRED_API double GetSecondaryOutputRatio(int output) {
+    std::lock_guard<std::mutex> lock(g_secondaryMutex);
+    int slot = secondarySlot(output);
+    return slot >= 0 && g_secondaryOwned[slot] ? g_secondaryOwned[slot]->ratio() : 1.0;
+}
+
+SHRED_API long long GetSecondaryOutputUnderruns(int output) {
+    std::lock_guard<std::mutex> lock(g_secondaryMutex);
+    int slot = secondarySlot(output);
+    return slot >= 0 && g_secondaryOwned[slot] ? (long long)g_secondaryOwned[slot]->underruns() : 0;
+}
+
+SHRED_API long long GetSecondaryOutputOverruns(int output) {
+    std::lock_guard<std::mutex> lock(g_secondaryMutex);
+    int slot = secondarySlot(output);
+    return slot >= 0 && g_secondaryOwned[slot] ? (long long)g_secondaryOwned[slot]->overruns() : 0;
+}
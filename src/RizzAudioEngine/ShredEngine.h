@@ -20,4 +20,180 @@ extern "C" {
     SHRED_API void SetVolume(int deck, float volume);
     SHRED_API void SetCrossfader(float value);
     SHRED_API void ShutdownEngine();
+
+    // Track prefetch
+    SHRED_API void HintTrack(const char* filePath, int priority);
+    SHRED_API void ClearTrackHints();
+    SHRED_API bool IsTrackPrefetched(const char* filePath);
+    SHRED_API void SetPrefetchMemoryBudget(int megabytes);
+
+    // Engine stats
+    SHRED_API float GetAudioLoad();
+    SHRED_API float GetAudioLoadPeak();
+    SHRED_API float GetOutputDspLoad();   // master protection chain time / block time
+
+    // Track memory (pre-fault + mlock) and audio-thread page faults
+    SHRED_API void SetTrackMemoryLocking(bool enabled);
+    SHRED_API long long GetAudioMinorFaults();
+    SHRED_API long long GetAudioMajorFaults();
+
+    // Variable speed: rate -2.0..2.0, mode 0=linear, 1=cubic Hermite, 2=windowed sinc
+    SHRED_API void SetPlaybackRate(int deck, double ratio);
+    SHRED_API double GetPlaybackRate(int deck);
+    SHRED_API void SetInterpolationMode(int deck, int mode);
+
+    // Key-lock: mode 0=WSOLA (low CPU), 1=phase vocoder (quality); latency in ms
+    SHRED_API void SetKeyLock(int deck, bool enabled);
+    SHRED_API void SetKeyLockMode(int deck, int mode);
+    SHRED_API double GetKeyLockLatency(int deck);
+
+    // Key shift in semitones (-12..12); load is the deck's share of block time
+    SHRED_API void SetKeyShift(int deck, double semitones);
+    SHRED_API double GetKeyShift(int deck);
+    SHRED_API float GetKeyShiftLoad(int deck);
+
+    // Scratch: jog position in seconds of audio or velocity as a rate, up to 1 kHz
+    SHRED_API void JogTouch(int deck, bool touched);
+    SHRED_API void JogPosition(int deck, double seconds);
+    SHRED_API void JogVelocity(int deck, double ratio);
+    SHRED_API void VinylBrake(int deck, double seconds);
+    SHRED_API void VinylSpinback(int deck, double speed, double seconds);
+    SHRED_API void SetPlatterInertia(int deck, double seconds);
+
+    // Loops: points in frames; beat loops and rolls use the deck's beat grid
+    SHRED_API void SetBeatGrid(int deck, double bpm, double firstBeatSeconds);
+    SHRED_API void LoopIn(int deck);
+    SHRED_API void LoopOut(int deck);
+    SHRED_API void SetLoop(int deck, long long inFrame, long long outFrame);
+    SHRED_API void BeatLoop(int deck, double beats);
+    SHRED_API void LoopRoll(int deck, double beats);
+    SHRED_API void LoopRollRelease(int deck);
+    SHRED_API void LoopHalve(int deck);
+    SHRED_API void LoopDouble(int deck);
+    SHRED_API void LoopExit(int deck);
+    SHRED_API void Reloop(int deck);
+    SHRED_API long long GetLoopIn(int deck);
+    SHRED_API long long GetLoopOut(int deck);
+    SHRED_API bool IsLoopActive(int deck);
+
+    // Hot cues: index 0..31, positions in seconds (-1 when unset); quantize
+    // snaps new cues to the beat grid and keeps beat phase on jumps
+    SHRED_API void SetHotCue(int deck, int index);
+    SHRED_API void SetHotCueAt(int deck, int index, double seconds);
+    SHRED_API void ClearHotCue(int deck, int index);
+    SHRED_API void JumpToHotCue(int deck, int index);
+    SHRED_API double GetHotCue(int deck, int index);
+    SHRED_API void SetQuantize(int deck, bool enabled);
+
+    // Play, pause, seek and track-load crossfade length in ms (0..5, 0 = off)
+    SHRED_API void SetTransportFade(int deck, double ms);
+    SHRED_API double GetTransportFade(int deck);
+
+    // Slip: loops, scratches, reverse and held hot cues return to where the
+    // track would have been; slip position in seconds, -1 when not slipping
+    SHRED_API void SetSlip(int deck, bool enabled);
+    SHRED_API bool GetSlip(int deck);
+    SHRED_API void SetReverse(int deck, bool enabled);
+    SHRED_API void ReleaseHotCue(int deck);
+    SHRED_API double GetSlipPosition(int deck);
+
+    // Master clock and beat sync. Leader 0 = internal clock at the master
+    // tempo. Sync state 0=off, 1=no beat grid, 2=locking, 3=locked; phase
+    // error in beats (-0.5..0.5, positive = deck behind the clock)
+    SHRED_API void SetMasterTempo(double bpm);
+    SHRED_API double GetMasterTempo();
+    SHRED_API double GetMasterBeat();
+    SHRED_API void SetSyncLeader(int deck);
+    SHRED_API int GetSyncLeader();
+    SHRED_API void SetSync(int deck, bool enabled);
+    SHRED_API int GetSyncState(int deck);
+    SHRED_API double GetPhaseError(int deck);
+
+    // Sample-accurate scheduling. Action 0=play, 1=pause, 2=cue (value =
+    // seconds), 3=hot cue (value = index), 4=beat loop (value = beats),
+    // 5=loop exit, 6=reloop. Time base 0=engine frame, 1=master beat,
+    // 2=next multiple of `time` beats. The engine frame is where the next
+    // block starts.
+    SHRED_API bool ScheduleAction(int deck, int action, double value, int timeBase, double time);
+    SHRED_API void CancelScheduledActions(int deck);
+    SHRED_API long long GetEngineFrame();
+
+    // Stem decks: multichannel WAVs load as stereo-pair stems (up to 8),
+    // mixed in the deck before its fader. Gain 0..2; count 0 for plain tracks.
+    SHRED_API int GetStemCount(int deck);
+    SHRED_API void SetStemGain(int deck, int stem, float gain);
+    SHRED_API void SetStemMute(int deck, int stem, bool muted);
+
+    // Sampler: slots 0..count-1 of one-shots mixed after the crossfader.
+    // Gain 0..2, pitch in semitones (-24..24); when all voices are busy the
+    // oldest is stolen. Triggers never block.
+    SHRED_API int LoadSample(int slot, const char* filePath);
+    SHRED_API void ClearSample(int slot);
+    SHRED_API bool TriggerSample(int slot, float gain, double semitones);
+    SHRED_API void StopSample(int slot);
+    SHRED_API void StopAllSamples();
+    SHRED_API void SetSamplerVolume(float volume);
+    SHRED_API int GetSamplerSlotCount();
+    SHRED_API int GetSamplerVoices();
+    SHRED_API long long GetSamplerStolenVoices();
+
+    // Auto-DJ: queued tracks are pre-loaded onto the idle deck and start on
+    // the exact frame the playing track reaches its outro (seconds, -1 = mix
+    // out at the end), crossfading over 0..30 s. Current deck 0 when off.
+    SHRED_API void AutoDjEnqueue(const char* filePath, double introSeconds, double outroSeconds);
+    SHRED_API void AutoDjClearQueue();
+    SHRED_API int AutoDjGetQueueLength();
+    SHRED_API void AutoDjSetCrossfade(double seconds);
+    SHRED_API bool AutoDjStart(int deck, double outroSeconds);
+    SHRED_API void AutoDjStop();
+    SHRED_API int AutoDjGetCurrentDeck();
+    SHRED_API long long AutoDjGetHandovers();
+
+    // Channel EQ: band 0=low, 1=mid, 2=high; gain 0..2 (kill..+6 dB).
+    // Mode 0 = biquad (12 dB/oct), 1 = Linkwitz-Riley (24 dB/oct).
+    SHRED_API void SetEqGain(int deck, int band, float gain);
+    SHRED_API float GetEqGain(int deck, int band);
+    SHRED_API void SetEqKill(int deck, int band, bool killed);
+    SHRED_API void SetEqMode(int mode);
+    SHRED_API void SetEqCrossovers(float lowHz, float highHz);
+
+    // Channel filter: position -1..1 (low-pass left, high-pass right, 0 = off),
+    // resonance 0..1
+    SHRED_API void SetFilter(int deck, float position);
+    SHRED_API float GetFilter(int deck);
+    SHRED_API void SetFilterResonance(int deck, float resonance);
+
+    // Effects: three insert slots per deck and on the master (deck 0).
+    // Type 0 = none, 1 = echo, 2 = reverb, 3 = flanger, 4 = phaser,
+    // 5 = convolution (LoadConvolution only); mix and parameters 0..1.
+    // A bypassed echo or reverb rings out its tail.
+    SHRED_API bool SetEffect(int deck, int slot, int type);
+    SHRED_API bool LoadConvolution(int deck, int slot, const char* filePath);
+    SHRED_API int GetEffect(int deck, int slot);
+    SHRED_API void SetEffectEnabled(int deck, int slot, bool enabled);
+    SHRED_API bool IsEffectEnabled(int deck, int slot);
+    SHRED_API void SetEffectMix(int deck, int slot, float mix);
+    SHRED_API void SetEffectParameter(int deck, int slot, int index, float value);
+    SHRED_API float GetEffectParameter(int deck, int slot, int index);
+
+    // Headphone cue on output channels 3-4, when the device has them. PFL
+    // takes a deck pre-fader; mix 0 = cue only .. 1 = master only, volume
+    // 0..2. Split cue: cue in mono left, master in mono right.
+    SHRED_API void SetCue(int deck, bool cued);
+    SHRED_API bool IsCued(int deck);
+    SHRED_API void SetCueMix(float mix);
+    SHRED_API void SetCueVolume(float gain);
+    SHRED_API void SetSplitCue(bool split);
+    SHRED_API bool HasCueOutput();
+
+    // Secondary outputs: master (source 0) or cue (1) on another PortAudio
+    // device, drift-corrected against it. Open returns output 1..4, 0 on
+    // failure. Fill is the smoothed ring level in frames (target 1536);
+    // ratio is engine frames per device frame, 1 when the clocks agree.
+    SHRED_API int OpenSecondaryOutput(int device, int source);
+    SHRED_API void CloseSecondaryOutput(int output);
+    SHRED_API float GetSecondaryOutputFill(int output);
+    SHRED_API double GetSecondaryOutputRatio(int output);
+    SHRED_API long long GetSecondaryOutputUnderruns(int output);
+    SHRED_API long long GetSecondaryOutputOverruns(int output);
 }
\ No newline at end of file
@@ -0,0 +1,286 @@
+#include "TimeStretcher.h"
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+
+static const float kPi = 3.14159265358979f;
+
+static inline float wrapPhase(float phase) {
+    return phase - 2.0f * kPi * std::floor((phase + kPi) / (2.0f * kPi));
+}
+
+static void makeHann(std::vector<float>& window, int size) {
+    window.resize(size);
+    for (int i = 0; i < size; ++i) {
+        window[i] = 0.5f - 0.5f * std::cos(2.0f * kPi * i / size);
+    }
+}
+
+TimeStretcher::TimeStretcher() : m_mode(WSOLA), m_fft(kPvFrame) {
+    for (int ch = 0; ch < 2; ++ch) {
+        m_in[ch].assign(kInCapacity, 0.0f);
+        m_ola[ch].assign(kPvFrame, 0.0f);
+        m_out[ch].assign(kOutCapacity, 0.0f);
+    }
+    makeHann(m_wsolaWindow, kWsolaFrame);
+    makeHann(m_pvWindow, kPvFrame);
+
+    const int bins = kPvFrame / 2 + 1;
+    m_re.assign(kPvFrame, 0.0f);
+    m_im.assign(kPvFrame, 0.0f);
+    m_lRe.assign(bins, 0.0f);
+    m_lIm.assign(bins, 0.0f);
+    m_rRe.assign(bins, 0.0f);
+    m_rIm.assign(bins, 0.0f);
+    m_mag.assign(bins, 0.0f);
+    m_phase.assign(bins, 0.0f);
+    m_prevPhase.assign(bins, 0.0f);
+    m_synthPhase.assign(bins, 0.0f);
+    m_peakOf.assign(bins, 0);
+    reset();
+}
+
+void TimeStretcher::setMode(Mode mode) {
+    m_mode = mode;
+    reset();
+}
+
+void TimeStretcher::reset() {
+    m_inCount = 0;
+    m_anaPos = 0.0;
+    m_prevStart = -1;
+    m_first = true;
+    m_outCount = 0;
+    for (int ch = 0; ch < 2; ++ch) {
+        std::fill(m_ola[ch].begin(), m_ola[ch].end(), 0.0f);
+    }
+}
+
+int TimeStretcher::latencyFrames() const {
+    return latencyFrames(m_mode);
+}
+
+int TimeStretcher::latencyFrames(Mode mode) {
+    // Read-ahead of the input over what is audible at 1x: half a frame to the
+    // window centre, the search margin, plus half a frame less the average
+    // hop still waiting in the output FIFO.
+    int frame = (mode == WSOLA) ? kWsolaFrame : kPvFrame;
+    int margin = (mode == WSOLA) ? kWsolaSearch : 0;
+    return frame + margin - kHop / 2;
+}
+
+double TimeStretcher::readAheadFrames(double ratio) const {
+    // Input up to the end of the next frame is already fed; what is audible
+    // sits half a frame plus the output FIFO behind the last synthesized hop,
+    // and that part scales with the ratio
+    return frameSize() / 2 + search() + ratio * (frameSize() - kHop) / 2;
+}
+
+int TimeStretcher::inputNeeded() const {
+    int end = (int)std::lround(m_anaPos) + frameSize() + search();
+    return std::max(0, end - m_inCount);
+}
+
+void TimeStretcher::feed(const float* left, const float* right, int frames) {
+    frames = std::min(frames, kInCapacity - m_inCount);
+    if (frames <= 0) return;
+    std::memcpy(m_in[0].data() + m_inCount, left, frames * sizeof(float));
+    std::memcpy(m_in[1].data() + m_inCount, right, frames * sizeof(float));
+    m_inCount += frames;
+}
+
+int TimeStretcher::read(float* left, float* right, int frames) {
+    int n = std::min(frames, m_outCount);
+    std::memcpy(left, m_out[0].data(), n * sizeof(float));
+    std::memcpy(right, m_out[1].data(), n * sizeof(float));
+    for (int ch = 0; ch < 2; ++ch) {
+        std::memmove(m_out[ch].data(), m_out[ch].data() + n, (m_outCount - n) * sizeof(float));
+    }
+    m_outCount -= n;
+    return n;
+}
+
+void TimeStretcher::synthesize(double ratio) {
+    const int frame = frameSize();
+    int start = (int)std::lround(m_anaPos);
+    start = std::max(0, std::min(start, m_inCount - frame));
+
+    if (m_mode == WSOLA) {
+        int best = m_first ? start : findWsolaOffset(start);
+        synthesizeWsola(best);
+        m_prevStart = best;
+    } else {
+        int hop = m_first ? 0 : start - m_prevStart;
+        synthesizePhaseVocoder(start, hop);
+        m_prevStart = start;
+    }
+    m_first = false;
+
+    // The first kHop samples of the overlap-add buffer are now final
+    int n = std::min(kHop, kOutCapacity - m_outCount);
+    for (int ch = 0; ch < 2; ++ch) {
+        std::memcpy(m_out[ch].data() + m_outCount, m_ola[ch].data(), n * sizeof(float));
+        std::memmove(m_ola[ch].data(), m_ola[ch].data() + kHop, (frame - kHop) * sizeof(float));
+        std::fill(m_ola[ch].begin() + (frame - kHop), m_ola[ch].begin() + frame, 0.0f);
+    }
+    m_outCount += n;
+
+    m_anaPos += ratio * kHop;
+    compactInput();
+}
+
+int TimeStretcher::findWsolaOffset(int nominal) const {
+    // Candidate whose start best matches the natural continuation of the
+    // previous segment over the overlap region (normalized cross-correlation,
+    // coarse pass then refine).
+    const int overlap = kWsolaFrame - kHop;
+    const int target = m_prevStart + kHop;
+    const float* tl = m_in[0].data() + target;
+    const float* tr = m_in[1].data() + target;
+    const int lo = std::max(0, nominal - kWsolaSearch);
+    const int hi = std::min(nominal + kWsolaSearch, m_inCount - kWsolaFrame);
+    if (hi <= lo) return std::max(0, std::min(nominal, m_inCount - kWsolaFrame));
+
+    auto score = [&](int pos) {
+        const float* xl = m_in[0].data() + pos;
+        const float* xr = m_in[1].data() + pos;
+        float corr = 0.0f, energy = 1e-9f;
+        for (int i = 0; i < overlap; ++i) {
+            corr += xl[i] * tl[i] + xr[i] * tr[i];
+            energy += xl[i] * xl[i] + xr[i] * xr[i];
+        }
+        return corr / std::sqrt(energy);
+    };
+
+    int best = std::max(lo, std::min(nominal, hi));
+    float bestScore = score(best);
+    for (int pos = lo; pos <= hi; pos += 4) {
+        float s = score(pos);
+        if (s > bestScore) {
+            bestScore = s;
+            best = pos;
+        }
+    }
+    int coarse = best;
+    for (int pos = std::max(lo, coarse - 3); pos <= std::min(hi, coarse + 3); ++pos) {
+        float s = score(pos);
+        if (s > bestScore) {
+            bestScore = s;
+            best = pos;
+        }
+    }
+    return best;
+}
+
+void TimeStretcher::synthesizeWsola(int start) {
+    const float* w = m_wsolaWindow.data();
+    for (int ch = 0; ch < 2; ++ch) {
+        const float* __restrict x = m_in[ch].data() + start;
+        float* __restrict y = m_ola[ch].data();
+        for (int i = 0; i < kWsolaFrame; ++i) {
+            y[i] += w[i] * x[i];
+        }
+    }
+}
+
+void TimeStretcher::synthesizePhaseVocoder(int start, int hop) {
+    const int n = kPvFrame;
+    const int bins = n / 2 + 1;
+    const float* w = m_pvWindow.data();
+    float* re = m_re.data();
+    float* im = m_im.data();
+
+    // Both channels in one complex FFT: z = left + i*right
+    for (int i = 0; i < n; ++i) {
+        re[i] = w[i] * m_in[0][start + i];
+        im[i] = w[i] * m_in[1][start + i];
+    }
+    m_fft.forward(re, im);
+
+    for (int k = 0; k < bins; ++k) {
+        int nk = (n - k) & (n - 1);
+        m_lRe[k] = 0.5f * (re[k] + re[nk]);
+        m_lIm[k] = 0.5f * (im[k] - im[nk]);
+        m_rRe[k] = 0.5f * (im[k] + im[nk]);
+        m_rIm[k] = -0.5f * (re[k] - re[nk]);
+        float midRe = m_lRe[k] + m_rRe[k];
+        float midIm = m_lIm[k] + m_rIm[k];
+        m_mag[k] = std::sqrt(m_lRe[k] * m_lRe[k] + m_lIm[k] * m_lIm[k]) +
+                   std::sqrt(m_rRe[k] * m_rRe[k] + m_rIm[k] * m_rIm[k]);
+        m_phase[k] = std::atan2(midIm, midRe);
+    }
+
+    if (hop <= 0) {
+        std::copy(m_phase.begin(), m_phase.end(), m_synthPhase.begin());
+    } else {
+        // Advance peak bins by their measured frequency, then lock every
+        // other bin to its nearest peak (identity phase locking)
+        int prevPeak = -1;
+        for (int k = 0; k < bins; ++k) {
+            bool peak = m_mag[k] > 0.0f;
+            for (int d = -2; d <= 2 && peak; ++d) {
+                int j = k + d;
+                if (d != 0 && j >= 0 && j < bins && m_mag[j] > m_mag[k]) peak = false;
+            }
+            if (peak) {
+                float omega = 2.0f * kPi * k / n;
+                float delta = wrapPhase(m_phase[k] - m_prevPhase[k] - omega * hop);
+                m_synthPhase[k] = wrapPhase(m_synthPhase[k] + (omega + delta / hop) * kHop);
+                prevPeak = k;
+            }
+            m_peakOf[k] = peak ? k : prevPeak;
+        }
+        int nextPeak = -1;
+        for (int k = bins - 1; k >= 0; --k) {
+            int p = m_peakOf[k];
+            if (p == k) {
+                nextPeak = k;
+                continue;
+            }
+            if (nextPeak >= 0 && (p < 0 || nextPeak - k < k - p)) p = nextPeak;
+            m_synthPhase[k] = (p < 0) ? m_phase[k] : wrapPhase(m_synthPhase[p] + m_phase[k] - m_phase[p]);
+        }
+    }
+    std::copy(m_phase.begin(), m_phase.end(), m_prevPhase.begin());
+
+    // Rotate both channels by the same amount to keep the stereo image, then
+    // rebuild the packed Hermitian spectrum for one inverse FFT
+    for (int k = 0; k < bins; ++k) {
+        float theta = m_synthPhase[k] - m_phase[k];
+        float c = std::cos(theta), s = std::sin(theta);
+        float lr = m_lRe[k] * c - m_lIm[k] * s, li = m_lRe[k] * s + m_lIm[k] * c;
+        float rr = m_rRe[k] * c - m_rIm[k] * s, ri = m_rRe[k] * s + m_rIm[k] * c;
+        re[k] = lr - ri;
+        im[k] = li + rr;
+        if (k > 0 && k < n / 2) {
+            re[n - k] = lr + ri;
+            im[n - k] = -li + rr;
+        }
+    }
+    m_fft.inverse(re, im);
+
+    // Hann analysis * Hann synthesis at 75% overlap sums to 1.5
+    const float scale = 1.0f / 1.5f;
+    float* __restrict yl = m_ola[0].data();
+    float* __restrict yr = m_ola[1].data();
+    for (int i = 0; i < n; ++i) {
+        yl[i] += w[i] * re[i] * scale;
+        yr[i] += w[i] * im[i] * scale;
+    }
+}
+
+void TimeStretcher::compactInput() {
+    // Keep what the next frame can reach: the search window around the next
+    // position and (WSOLA) the continuation of the segment just used
+    int keep = (int)std::lround(m_anaPos) - search();
+    if (m_mode == WSOLA && m_prevStart >= 0) keep = std::min(keep, m_prevStart + kHop);
+    keep = std::max(0, std::min(keep, m_inCount));
+    if (keep < kInCapacity / 4) return;
+
+    for (int ch = 0; ch < 2; ++ch) {
+        std::memmove(m_in[ch].data(), m_in[ch].data() + keep, (m_inCount - keep) * sizeof(float));
+    }
+    m_inCount -= keep;
+    m_anaPos -= keep;
+    m_prevStart -= keep;
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <vector>
+#include <cmath>
+#include "Fft.h"
+
+// Streaming stereo time-stretch (tempo change without pitch change) for
+// key-lock. Both modes synthesize fixed output hops from input read at
+// ratio * hop, so pitch is untouched:
+//   WSOLA          - picks the best-aligned input segment per hop; cheap.
+//   PHASE_VOCODER  - FFT resynthesis with identity phase locking; smoother on
+//                    tonal material, costs more and has more latency.
+//
+// Push/pull, never allocates after construction:
+//   while (available() < n) { feed(inputNeeded() frames); synthesize(ratio); }
+//   read(n);
+class TimeStretcher {
+public:
+    enum Mode { WSOLA = 0, PHASE_VOCODER = 1 };
+
+    TimeStretcher();
+
+    void setMode(Mode mode);   // also resets
+    Mode getMode() const { return m_mode; }
+    void reset();
+
+    // How far the input read position runs ahead of what is audible, in
+    // frames at 1x. Fixed per mode (WSOLA ~20 ms, phase vocoder ~41 ms).
+    int latencyFrames() const;
+    static int latencyFrames(Mode mode);
+    // Same read-ahead in source frames while stretching at `ratio`
+    double readAheadFrames(double ratio) const;
+    // After a reset the overlap-add buffer is empty, so the first hops only
+    // carry the rising edge of the window. Running prerollHops() hops on the
+    // prerollFrames(ratio) source frames before the start point, and
+    // discarding their output, fills it so output starts at full level.
+    int prerollHops() const { return frameSize() / kHop - 1; }
+    int prerollFrames(double ratio) const { return (int)std::lround(prerollHops() * ratio * kHop); }
+
+    int available() const { return m_outCount; }
+    // Input frames still missing for the next synthesize()
+    int inputNeeded() const;
+    void feed(const float* left, const float* right, int frames);
+    void synthesize(double ratio);
+    int read(float* left, float* right, int frames);
+
+private:
+    static constexpr int kWsolaFrame = 1024;
+    static constexpr int kWsolaSearch = 128;
+    static constexpr int kPvFrame = 2048;
+    static constexpr int kHop = 512;
+    static constexpr int kInCapacity = 16384;
+    static constexpr int kOutCapacity = 4096;
+
+    int frameSize() const { return m_mode == WSOLA ? kWsolaFrame : kPvFrame; }
+    int search() const { return m_mode == WSOLA ? kWsolaSearch : 0; }
+    int findWsolaOffset(int nominal) const;
+    void synthesizeWsola(int start);
+    void synthesizePhaseVocoder(int start, int hop);
+    void compactInput();
+
+    Mode m_mode;
+    Fft m_fft;
+
+    // Input history (planar), indices relative to m_in[ch][0]
+    std::vector<float> m_in[2];
+    int m_inCount;
+    double m_anaPos;        // next analysis frame start
+    int m_prevStart;        // previous analysis frame start, -1 before the first
+    bool m_first;
+
+    std::vector<float> m_ola[2];
+    std::vector<float> m_out[2];
+    int m_outCount;
+
+    std::vector<float> m_wsolaWindow;
+    std::vector<float> m_pvWindow;
+
+    // Phase vocoder state
+    std::vector<float> m_re, m_im;
+    std::vector<float> m_lRe, m_lIm, m_rRe, m_rIm;
+    std::vector<float> m_mag, m_phase, m_prevPhase, m_synthPhase;
+    std::vector<int> m_peakOf;
+};
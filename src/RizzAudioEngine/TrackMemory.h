@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include <new>
+
+// Memory for decoded track buffers. Large buffers are 2 MB aligned and
+// advised as transparent huge pages so playback walks far fewer pages, and a
+// deck can pin its track (pre-fault + mlock) so nothing faults in the
+// audio callback.
+class TrackMemory {
+public:
+    static constexpr size_t kHugePageSize = 2u * 1024u * 1024u;
+
+    static void* allocate(size_t bytes);
+    static void deallocate(void* ptr, size_t bytes);
+
+    // Touch every page so it is resident, then try to lock it in RAM.
+    // Returns false if mlock was refused (RLIMIT_MEMLOCK); pages stay faulted in.
+    static bool pin(const void* ptr, size_t bytes);
+    static void unpin(const void* ptr, size_t bytes);
+};
+
+template <typename T>
+struct TrackAllocator {
+    using value_type = T;
+
+    TrackAllocator() = default;
+    template <typename U>
+    TrackAllocator(const TrackAllocator<U>&) {}
+
+    T* allocate(size_t n) {
+        void* p = TrackMemory::allocate(n * sizeof(T));
+        if (!p) throw std::bad_alloc();
+        return static_cast<T*>(p);
+    }
+    void deallocate(T* p, size_t n) { TrackMemory::deallocate(p, n * sizeof(T)); }
+
+    template <typename U>
+    bool operator==(const TrackAllocator<U>&) const { return true; }
+    template <typename U>
+    bool operator!=(const TrackAllocator<U>&) const { return false; }
+};
+
+using TrackSamples = std::vector<float, TrackAllocator<float>>;
@@ -0,0 +1,72 @@
+#include "TruePeak.h"
+#include <cmath>
+#include <algorithm>
+
+// Hann-windowed sinc over +-kDelay input frames, one column per output
+// phase. Phase 0 is the input frame itself; 1..3 fall between it and the next.
+const float (&TruePeakDetector::taps())[kTaps][kFactor] {
+    static float table[kTaps][kFactor];
+    static bool built = [] {
+        const double pi = 3.14159265358979323846;
+        for (int p = 0; p < kFactor; ++p) {
+            double sum = 0.0;
+            for (int j = 0; j < kTaps; ++j) {
+                // Tap j holds the input frame (kTaps - 1 - j) back from the newest
+                double x = (kDelay - 1 - j) + (double)p / kFactor;
+                double s = (x == 0.0) ? 1.0 : std::sin(pi * x) / (pi * x);
+                double window = 0.5 * (1.0 + std::cos(pi * x / kDelay));
+                table[j][p] = (float)(s * window);
+                sum += s * window;
+            }
+            // Unity gain at DC for every phase
+            for (int j = 0; j < kTaps; ++j) {
+                table[j][p] = (float)(table[j][p] / sum);
+            }
+        }
+        return true;
+    }();
+    (void)built;
+    return table;
+}
+
+TruePeakDetector::TruePeakDetector() {
+    taps();
+    reset();
+}
+
+void TruePeakDetector::reset() {
+    std::fill(&m_history[0][0], &m_history[0][0] + 2 * kTaps * 2, 0.0f);
+    m_position = 0;
+}
+
+float TruePeakDetector::process(float left, float right) {
+    const float (&table)[kTaps][kFactor] = taps();
+    // Written at both copies, so m_history[ch] + m_position is always the
+    // last kTaps frames oldest first
+    m_history[0][m_position] = m_history[0][m_position + kTaps] = left;
+    m_history[1][m_position] = m_history[1][m_position + kTaps] = right;
+    m_position = (m_position + 1) % kTaps;
+
+    const float* l = m_history[0] + m_position;
+    const float* r = m_history[1] + m_position;
+    float acc[2][kFactor] = {};
+    for (int j = 0; j < kTaps; ++j) {
+        for (int p = 0; p < kFactor; ++p) {
+            acc[0][p] += table[j][p] * l[j];
+            acc[1][p] += table[j][p] * r[j];
+        }
+    }
+    float peak = 0.0f;
+    for (int p = 0; p < kFactor; ++p) {
+        peak = std::max(peak, std::max(std::abs(acc[0][p]), std::abs(acc[1][p])));
+    }
+    return peak;
+}
+
+float TruePeakDetector::processBlock(const float* left, const float* right, int frames) {
+    float peak = 0.0f;
+    for (int i = 0; i < frames; ++i) {
+        peak = std::max(peak, process(left[i], right[i]));
+    }
+    return peak;
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+// Inter-sample peak detection per ITU-R BS.1770: each stereo frame is
+// upsampled 4x through a 48-tap polyphase FIR (12 taps per phase) and the
+// largest absolute value of the four points is the frame's true peak. The
+// history is kept twice over so the last kTaps frames are always contiguous,
+// and the taps are stored tap-major so all four phases of both channels
+// accumulate side by side in vector lanes.
+class TruePeakDetector {
+public:
+    static constexpr int kFactor = 4;
+    static constexpr int kTaps = 12;
+    // The peak returned for a frame belongs to the input this many frames back
+    static constexpr int kDelay = kTaps / 2;
+
+    TruePeakDetector();
+
+    void reset();
+    // Push one frame; returns the true peak of the frame kDelay frames ago
+    float process(float left, float right);
+    // Largest true peak over a block
+    float processBlock(const float* left, const float* right, int frames);
+
+private:
+    static const float (&taps())[kTaps][kFactor];
+
+    float m_history[2][kTaps * 2];
+    int m_position;
+};
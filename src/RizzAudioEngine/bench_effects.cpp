@@ -0,0 +1,97 @@
+// Effects CPU benchmark: runs one instance of each effect through a rack
+// slot at full wet in 256-frame blocks and reports the cost per instance,
+// plus the cost of a bypassed slot once its tail has ended. Convolution
+// only counts the audio thread; its far partitions run on a worker. Build
+// with `make bench` or -DSHRED_BUILD_BENCHMARKS=ON.
+#include "Effects.h"
+#include "DecodedTrack.h"
+#include <random>
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <vector>
+#include <algorithm>
+#include <cstdlib>
+
+int main(int argc, char* argv[]) {
+    const int blockFrames = (argc > 1) ? std::atoi(argv[1]) : 256;
+    const double bpm = (argc > 2) ? std::atof(argv[2]) : 126.0;
+    const int seconds = 20;
+
+    // Synthetic stereo input, generated once so only the effect is timed
+    const int inputFrames = 44100;
+    std::vector<float> inputLeft(inputFrames), inputRight(inputFrames);
+    for (int i = 0; i < inputFrames; ++i) {
+        double t = i / 44100.0;
+        double beat = std::exp(-40.0 * std::fmod(t, 60.0 / bpm));
+        inputLeft[i] = (float)(0.3 * std::sin(2 * M_PI * 220 * t) + 0.3 * beat * std::sin(2 * M_PI * 60 * t));
+        inputRight[i] = (float)(0.3 * std::sin(2 * M_PI * 330 * t) + 0.3 * beat * std::sin(2 * M_PI * 60 * t));
+    }
+
+    // Synthetic 3 s stereo room: decaying noise
+    DecodedTrack impulse;
+    impulse.channels = 2;
+    impulse.sampleRate = 44100;
+    impulse.length = 3 * 44100;
+    impulse.samples.resize(impulse.length * 2);
+    std::mt19937 rng(1);
+    std::normal_distribution<float> noise;
+    for (long i = 0; i < impulse.length * 2; ++i) {
+        impulse.samples[i] = noise(rng) * std::exp(-(i / 2) / 20000.0f);
+    }
+
+    struct Case { const char* name; int type; bool enabled; };
+    const Case cases[] = {
+        {"echo", Effect::ECHO, true},
+        {"reverb", Effect::REVERB, true},
+        {"flanger", Effect::FLANGER, true},
+        {"phaser (8 stages)", Effect::PHASER, true},
+        {"convolution (3 s IR)", Effect::CONVOLUTION, true},
+        {"bypassed echo (idle)", Effect::ECHO, false},
+    };
+
+    std::cout << "Effects benchmark: " << blockFrames << "-frame blocks, " << bpm << " BPM, " << seconds << "s of audio per effect" << std::endl;
+    std::vector<float> left(blockFrames), right(blockFrames);
+    const int blocks = seconds * 44100 / blockFrames;
+    const double blockBudgetUs = blockFrames * 1e6 / 44100.0;
+
+    for (const Case& c : cases) {
+        EffectRack rack;
+        if (c.type == Effect::CONVOLUTION) rack.setEffect(0, Effect::createConvolution(impulse));
+        else rack.setEffect(0, c.type);
+        rack.setMix(0, 1.0f);
+        rack.setParameter(0, 1, 0.6f);
+        if (c.type == Effect::PHASER) rack.setParameter(0, 3, 1.0f);
+        rack.setEnabled(0, c.enabled);
+
+        std::vector<double> blockUs(blocks);
+        double beat = 0.0;
+        int offset = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int b = 0; b < blocks; ++b) {
+            if (offset + blockFrames > inputFrames) offset = 0;
+            std::memcpy(left.data(), inputLeft.data() + offset, blockFrames * sizeof(float));
+            std::memcpy(right.data(), inputRight.data() + offset, blockFrames * sizeof(float));
+            offset += blockFrames;
+            auto t0 = std::chrono::steady_clock::now();
+            rack.process(left.data(), right.data(), blockFrames, {bpm, beat});
+            blockUs[b] = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count();
+            beat += blockFrames * bpm / (60.0 * 44100.0);
+        }
+        double totalUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+        double meanUs = totalUs / blocks;
+        std::sort(blockUs.begin(), blockUs.end());
+        double p99Us = blockUs[blocks * 99 / 100];
+        double worstUs = blockUs.back();
+
+        std::cout << std::fixed << std::setprecision(2)
+                  << std::setw(22) << std::left << c.name << std::right
+                  << "  mean " << std::setw(7) << meanUs << " us/block"
+                  << "  p99 " << std::setw(7) << p99Us << " us"
+                  << "  worst " << std::setw(7) << worstUs << " us"
+                  << "  CPU per instance " << std::setw(6) << (100.0 * meanUs / blockBudgetUs) << "%" << std::endl;
+    }
+    return 0;
+}
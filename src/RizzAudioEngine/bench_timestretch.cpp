@@ -0,0 +1,80 @@
+// Key-lock CPU benchmark: renders one deck in 64-frame blocks at each
+// key-lock quality level and reports the cost per deck, so a mode can be
+// picked per machine. Build with `make bench` or -DSHRED_BUILD_BENCHMARKS=ON.
+#include "ScratchBuffer.h"
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <vector>
+#include <algorithm>
+#include <cstdlib>
+
+int main(int argc, char* argv[]) {
+    const int blockFrames = (argc > 1) ? std::atoi(argv[1]) : 64;
+    const double rate = (argc > 2) ? std::atof(argv[2]) : 1.06;
+    const int seconds = 20;
+
+    // Synthetic stereo track: a few partials plus a decaying click every beat
+    auto track = std::make_shared<DecodedTrack>();
+    track->path = "bench";
+    track->channels = 2;
+    track->sampleRate = 44100;
+    track->length = 44100 * 30;
+    track->samples.resize(track->length * 2);
+    for (long i = 0; i < track->length; ++i) {
+        double t = i / 44100.0;
+        double beat = std::exp(-40.0 * std::fmod(t, 0.5));
+        track->samples[i * 2] = (float)(0.3 * std::sin(2 * M_PI * 220 * t) + 0.1 * std::sin(2 * M_PI * 1330 * t) + 0.3 * beat * std::sin(2 * M_PI * 60 * t));
+        track->samples[i * 2 + 1] = (float)(0.3 * std::sin(2 * M_PI * 330 * t) + 0.1 * std::sin(2 * M_PI * 2210 * t) + 0.3 * beat * std::sin(2 * M_PI * 60 * t));
+    }
+
+    struct Level { const char* name; bool keyLock; int mode; double keyShift; };
+    const Level levels[] = {
+        {"varispeed (no key-lock)", false, 0, 0.0},
+        {"key-lock WSOLA", true, TimeStretcher::WSOLA, 0.0},
+        {"key-lock phase vocoder", true, TimeStretcher::PHASE_VOCODER, 0.0},
+        {"key shift +3 WSOLA", true, TimeStretcher::WSOLA, 3.0},
+        {"key shift +3 phase voc.", true, TimeStretcher::PHASE_VOCODER, 3.0},
+    };
+
+    std::cout << "Key-lock benchmark: " << blockFrames << "-frame blocks, rate " << rate << ", " << seconds << "s of audio per level" << std::endl;
+    std::vector<float> left(blockFrames), right(blockFrames);
+    const int blocks = seconds * 44100 / blockFrames;
+    const double blockBudgetUs = blockFrames * 1e6 / 44100.0;
+
+    for (const Level& level : levels) {
+        ScratchBuffer deck;
+        deck.loadTrack(track);
+        deck.setSpeed(rate);
+        deck.setKeyLockMode(level.mode);
+        deck.setKeyLock(level.keyLock);
+        deck.setKeyShift(level.keyShift);
+        deck.play();
+
+        // Hop-based stretchers do their work in bursts, so the tail of the
+        // per-block distribution matters as much as the mean
+        std::vector<double> blockUs(blocks);
+        auto start = std::chrono::steady_clock::now();
+        for (int b = 0; b < blocks; ++b) {
+            auto t0 = std::chrono::steady_clock::now();
+            deck.getAudio(left.data(), right.data(), blockFrames);
+            blockUs[b] = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count();
+        }
+        double totalUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+        double meanUs = totalUs / blocks;
+        std::sort(blockUs.begin(), blockUs.end());
+        double p99Us = blockUs[blocks * 99 / 100];
+        double worstUs = blockUs.back();
+
+        std::cout << std::fixed << std::setprecision(2)
+                  << std::setw(26) << std::left << level.name << std::right
+                  << "  mean " << std::setw(7) << meanUs << " us/block"
+                  << "  p99 " << std::setw(7) << p99Us << " us"
+                  << "  worst " << std::setw(7) << worstUs << " us"
+                  << "  CPU per deck " << std::setw(6) << (100.0 * meanUs / blockBudgetUs) << "%"
+                  << "  latency " << deck.getKeyLockLatencyMs() << " ms" << std::endl;
+    }
+    return 0;
+}
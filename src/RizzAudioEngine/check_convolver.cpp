@@ -0,0 +1,113 @@
+// Convolver check: convolves noise with noise-like decaying responses of
+// several lengths, mono and stereo, in random block sizes paced at the
+// audio rate, and compares every seventh output frame against direct
+// convolution in double precision. Passes when the worst error stays below
+// kTolerance of the output's peak and the worker never fell behind.
+//
+// The stall cases hold the worker up once, a third of the way in. Frames
+// from then until `recoverFrames` after the stall are skipped, and the rest
+// must line up with direct convolution again: briefly, the worker catches
+// up on its queue and only the late blocks' far tails are lost; for longer,
+// the queue overflows and the far stage restarts, so the skip covers the
+// response length. Exits non-zero on any failure. Build with `make check`
+// or -DSHRED_BUILD_BENCHMARKS=ON.
+#include "Convolver.h"
+#include <random>
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <thread>
+#include <cmath>
+#include <vector>
+#include <algorithm>
+
+namespace {
+
+const double kTolerance = 1e-5;
+const int kStride = 7;
+
+struct Case {
+    int length;
+    int headBlock;
+    int tailBlock;
+    int frames;
+    int stallMs;         // 0 for none
+    int recoverFrames;   // after the stall ends
+};
+
+}
+
+int main() {
+    // Lengths inside the head, across the near stage and deep into the
+    // worker's partitions, plus a 1 s room at the default block sizes
+    const Case cases[] = {
+        {50, 64, 1024, 20000, 0, 0},
+        {1500, 64, 1024, 20000, 0, 0},
+        {3000, 64, 1024, 30000, 0, 0},
+        {5000, 64, 1024, 30000, 0, 0},
+        {20000, 64, 1024, 50000, 0, 0},
+        {44100, 64, 2048, 60000, 0, 0},
+        {44100, 64, 2048, 90000, 100, 4 * 2048},
+        {20000, 64, 1024, 90000, 600, 20000 + 4 * 1024},
+    };
+
+    std::mt19937 rng(1);
+    std::normal_distribution<float> noise;
+    std::uniform_int_distribution<int> blockSize(1, 300);
+    bool allPass = true;
+    std::cout << "       length  head  tail  stall   rel. error  late" << std::endl;
+    for (bool stereo : {false, true}) {
+        for (const Case& c : cases) {
+            std::vector<float> responseLeft(c.length), responseRight(c.length);
+            for (int i = 0; i < c.length; ++i) {
+                float decay = std::exp(-i / (0.2f * c.length + 50.0f));
+                responseLeft[i] = noise(rng) * decay;
+                responseRight[i] = noise(rng) * decay;
+            }
+            Convolver convolver(responseLeft.data(), stereo ? responseRight.data() : nullptr, c.length, c.headBlock,
+                                c.tailBlock);
+            const std::vector<float>& responseForRight = stereo ? responseRight : responseLeft;
+
+            std::vector<float> inputLeft(c.frames), inputRight(c.frames);
+            for (int i = 0; i < c.frames; ++i) {
+                inputLeft[i] = noise(rng);
+                inputRight[i] = noise(rng);
+            }
+            std::vector<float> outputLeft(c.frames), outputRight(c.frames);
+            const int stallAt = c.stallMs > 0 ? c.frames / 3 : c.frames;
+            const int recoverAt = stallAt + c.stallMs * 44100 / 1000 + c.recoverFrames;
+            auto next = std::chrono::steady_clock::now();
+            for (int position = 0; position < c.frames;) {
+                int frames = std::min(c.frames - position, blockSize(rng));
+                if (position <= stallAt && position + frames > stallAt) convolver.stallWorkerOnce(c.stallMs);
+                convolver.process(&inputLeft[position], &inputRight[position], &outputLeft[position],
+                                  &outputRight[position], frames);
+                position += frames;
+                next += std::chrono::microseconds((int64_t)frames * 1000000 / 44100);
+                std::this_thread::sleep_until(next);
+            }
+
+            double worstError = 0.0, peak = 0.0;
+            for (int i = 0; i < c.frames; i += kStride) {
+                if (i >= stallAt && i < recoverAt) continue;
+                double left = 0.0, right = 0.0;
+                for (int k = 0; k < c.length && k <= i; ++k) {
+                    left += (double)responseLeft[k] * inputLeft[i - k];
+                    right += (double)responseForRight[k] * inputRight[i - k];
+                }
+                worstError = std::max(worstError, std::max(std::abs(left - outputLeft[i]), std::abs(right - outputRight[i])));
+                peak = std::max(peak, std::max(std::abs(left), std::abs(right)));
+            }
+            double relative = worstError / std::max(peak, 1e-30);
+            bool pass = relative < kTolerance && (convolver.lateBlocks() > 0) == (c.stallMs > 0);
+            allPass &= pass;
+
+            std::cout << (stereo ? "stereo " : "mono   ") << std::setw(6) << c.length << std::setw(6) << c.headBlock
+                      << std::setw(6) << c.tailBlock << std::setw(7) << c.stallMs << "   " << std::scientific
+                      << std::setprecision(2) << relative << std::defaultfloat << std::setw(6) << convolver.lateBlocks() << (pass ? "" : "  FAIL")
+                      << std::endl;
+        }
+    }
+    std::cout << (allPass ? "Convolver matches direct convolution" : "MISMATCH") << std::endl;
+    return allPass ? 0 : 1;
+}
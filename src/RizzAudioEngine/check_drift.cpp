@@ -0,0 +1,106 @@
+// Secondary output drift check: an engine thread pushes 512-frame blocks
+// at 44.1 kHz while a device thread pulls its own block size at a clock
+// off by the given drift, both paced in real time, with no audio device
+// involved. Once the loop has had kSettleSeconds to lock, the ring must
+// not under- or overrun, the fill must hold near its target, and the
+// averaged resampling ratio must match the drift. Exits non-zero
+// otherwise. Build with `make check` or -DSHRED_BUILD_BENCHMARKS=ON.
+//
+// Usage: check_drift [drift ppm] [device block frames] [seconds]
+#include "SecondaryOutput.h"
+#include <iostream>
+#include <iomanip>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <cmath>
+#include <memory>
+#include <vector>
+#include <cstdlib>
+#include <algorithm>
+
+namespace {
+
+const double kSettleSeconds = 40.0;
+const double kMaxRatioErrorPpm = 25.0;
+const double kMaxFillSwing = 512.0;   // frames either side of the settled average
+
+}
+
+int main(int argc, char* argv[]) {
+    const double driftPpm = (argc > 1) ? std::atof(argv[1]) : 100.0;
+    const int deviceBlock = (argc > 2) ? std::atoi(argv[2]) : 480;
+    const double seconds = (argc > 3) ? std::atof(argv[3]) : 60.0;
+    const double deviceRate = 44100.0 * (1.0 + driftPpm * 1e-6);
+    const int engineBlock = 512;
+
+    auto output = std::make_unique<SecondaryOutput>(SecondaryOutput::MASTER);
+    std::atomic<bool> running{true};
+    const auto start = std::chrono::steady_clock::now();
+    auto at = [&](double t) { return start + std::chrono::nanoseconds((int64_t)(t * 1e9)); };
+
+    std::thread engine([&] {
+        std::vector<float> left(engineBlock), right(engineBlock);
+        double phase = 0.0;
+        for (int64_t block = 1; running.load(std::memory_order_relaxed); ++block) {
+            for (int i = 0; i < engineBlock; ++i) {
+                left[i] = right[i] = (float)(0.5 * std::sin(phase));
+                phase += 2 * M_PI * 1000.0 / 44100.0;
+            }
+            output->push(left.data(), right.data(), engineBlock);
+            std::this_thread::sleep_until(at(block * engineBlock / 44100.0));
+        }
+    });
+
+    std::cout << "Drift " << driftPpm << " ppm, device blocks of " << deviceBlock << ", " << seconds << " s" << std::endl;
+    std::vector<float> out(deviceBlock * 2);
+    uint64_t settledUnderruns = 0, settledOverruns = 0;
+    double ratioSum = 0.0, fillSum = 0.0, fillLow = 1e9, fillHigh = -1e9;
+    int64_t settledPulls = 0;
+    double nextReport = 0.0;
+    for (int64_t pull = 1;; ++pull) {
+        output->pull(out.data(), deviceBlock);
+        double t = pull * deviceBlock / deviceRate;
+        if (t > seconds) break;
+        if (t >= kSettleSeconds) {
+            if (settledPulls == 0) {
+                settledUnderruns = output->underruns();
+                settledOverruns = output->overruns();
+            }
+            ++settledPulls;
+            ratioSum += output->ratio();
+            fillSum += output->fill();
+            fillLow = std::min(fillLow, (double)output->fill());
+            fillHigh = std::max(fillHigh, (double)output->fill());
+        }
+        if (t >= nextReport) {
+            std::cout << std::fixed << std::setprecision(1) << "  t=" << std::setw(5) << t << " s  fill "
+                      << std::setw(7) << output->fill() << "  ratio " << std::setw(8) << (output->ratio() - 1.0) * 1e6
+                      << " ppm  underruns " << output->underruns() << "  overruns " << output->overruns() << std::endl;
+            nextReport += 5.0;
+        }
+        std::this_thread::sleep_until(at(t));
+    }
+    running.store(false, std::memory_order_relaxed);
+    engine.join();
+
+    if (settledPulls == 0) {
+        std::cout << "Run longer than " << kSettleSeconds << " s to check the settled loop" << std::endl;
+        return 1;
+    }
+    // Engine frames per device frame: the device running fast reads slower
+    double expectedPpm = (1.0 / (1.0 + driftPpm * 1e-6) - 1.0) * 1e6;
+    double ratioPpm = (ratioSum / settledPulls - 1.0) * 1e6;
+    double fillAverage = fillSum / settledPulls;
+    uint64_t underruns = output->underruns() - settledUnderruns;
+    uint64_t overruns = output->overruns() - settledOverruns;
+    bool ratioOk = std::abs(ratioPpm - expectedPpm) < kMaxRatioErrorPpm;
+    bool fillOk = fillHigh - fillAverage < kMaxFillSwing && fillAverage - fillLow < kMaxFillSwing;
+    bool pass = ratioOk && fillOk && underruns == 0 && overruns == 0;
+
+    std::cout << std::setprecision(2) << "Settled: ratio " << ratioPpm << " ppm (expected " << expectedPpm << ")"
+              << ", fill " << fillAverage << " (" << fillLow << ".." << fillHigh << ")"
+              << ", underruns " << underruns << ", overruns " << overruns << std::endl;
+    std::cout << (pass ? "Drift loop locked" : "FAIL") << std::endl;
+    return pass ? 0 : 1;
+}
@@ -0,0 +1,231 @@
+// Protection chain check: runs noise through ClubMixer::applyOutputDSP and
+// through a copy of the per-sample protection path ClubMixer had before the
+// chain was split out into compile-time stage sets, for a spread of stage
+// combinations and mixed block sizes, and reports whether the output and
+// peak level are bit-identical. The first kSettleFrames are skipped: the
+// chain now fades the look-ahead tap in from the dry input, where the old
+// path started from an empty delay line. Exits non-zero on a mismatch.
+// Build with `make check` or -DSHRED_BUILD_BENCHMARKS=ON.
+#include "ClubMixer.h"
+#include "TruePeak.h"
+#include <random>
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+#include <vector>
+#include <algorithm>
+
+namespace {
+
+const int kSettleFrames = 256;
+
+struct Stages {
+    bool softKnee, lookAhead, truePeak, brickwall, peakMeter, clipIndicator, autoGain;
+    float attackMs;
+};
+
+// The old ClubMixer protection path, one sample at a time with a flag test
+// per stage. Auto gain only reacted to the clipping indicator there, so it
+// is only checked with the indicator on.
+class ReferenceProtection {
+public:
+    explicit ReferenceProtection(const Stages& stages) : m_stages(stages) {
+        m_attackTime = stages.attackMs / 1000.0f;
+    }
+
+    void process(float* left, float* right, int frames) {
+        for (int i = 0; i < frames; ++i) {
+            float l = left[i];
+            float r = right[i];
+            if (m_stages.softKnee) {
+                l = softKneeCompress(l);
+                r = softKneeCompress(r);
+            }
+            if (m_stages.lookAhead || m_stages.truePeak) limit(l, r);
+            if (m_stages.brickwall) {
+                if (std::abs(l) > m_threshold) l = (l > 0) ? m_threshold : -m_threshold;
+                if (std::abs(r) > m_threshold) r = (r > 0) ? m_threshold : -m_threshold;
+            }
+            if (m_stages.peakMeter) {
+                m_peakLevel = std::max(m_peakLevel * 0.99f, std::max(std::abs(l), std::abs(r)));
+            }
+            if (m_stages.clipIndicator) {
+                m_clipping = std::abs(l) >= m_threshold || std::abs(r) >= m_threshold;
+            }
+            if (m_stages.autoGain) {
+                m_autoGain = m_clipping ? std::max(0.1f, m_autoGain * 0.999f) : std::min(1.0f, m_autoGain * 1.001f);
+                l *= m_autoGain;
+                r *= m_autoGain;
+            }
+            left[i] = l;
+            right[i] = r;
+        }
+    }
+
+    float peakLevel() const { return m_peakLevel; }
+
+private:
+    static constexpr int kMaxLookAhead = 2048;
+
+    float softKneeCompress(float input) const {
+        const float threshold = m_threshold * 0.8f;
+        const float knee = 0.1f;
+        if (std::abs(input) < threshold) return input;
+        float excess = std::abs(input) - threshold;
+        if (std::abs(input) < threshold + knee) {
+            float ratio = 1.0f + (m_ratio - 1.0f) * (excess / knee);
+            return (input > 0 ? 1 : -1) * (threshold + excess / ratio);
+        }
+        return (input > 0 ? 1 : -1) * (threshold + excess / m_ratio);
+    }
+
+    void limit(float& left, float& right) {
+        const unsigned mask = kMaxLookAhead - 1;
+        int length = std::max(1, std::min(kMaxLookAhead - 1 - TruePeakDetector::kDelay,
+                                          (int)std::lround(m_attackTime * 44100.0f)));
+        int delay = length + (m_stages.truePeak ? TruePeakDetector::kDelay : 0);
+        if (length != m_length || delay != m_delay) {
+            std::fill(m_left, m_left + kMaxLookAhead, 0.0f);
+            std::fill(m_right, m_right + kMaxLookAhead, 0.0f);
+            std::fill(m_gains, m_gains + kMaxLookAhead, 1.0f);
+            m_peakHead = m_peakTail = 0;
+            m_gainSum = length;
+            m_gain = 1.0f;
+            m_truePeakDetector.reset();
+            m_length = length;
+            m_delay = delay;
+            m_releaseCoeff = 1.0f - std::exp(-1.0f / (std::max(0.001f, m_releaseTime) * 44100.0f));
+        }
+        unsigned frame = m_frame++;
+
+        float peak = m_stages.truePeak ? m_truePeakDetector.process(left, right)
+                                       : std::max(std::abs(left), std::abs(right));
+        while (m_peakTail != m_peakHead && m_peakValues[(m_peakTail - 1) & mask] <= peak) {
+            --m_peakTail;
+        }
+        m_peakFrames[m_peakTail & mask] = frame;
+        m_peakValues[m_peakTail & mask] = peak;
+        ++m_peakTail;
+        if (frame - m_peakFrames[m_peakHead & mask] > (unsigned)length) {
+            ++m_peakHead;
+        }
+        float maxPeak = m_peakValues[m_peakHead & mask];
+        float target = maxPeak > m_threshold ? m_threshold / maxPeak : 1.0f;
+
+        unsigned slot = frame & mask;
+        unsigned oldest = (frame - length) & mask;
+        m_gainSum += target - m_gains[oldest];
+        m_gains[slot] = target;
+        if (slot == 0) {
+            m_gainSum = 0.0;
+            for (int i = 0; i < length; ++i) {
+                m_gainSum += m_gains[(frame - i) & mask];
+            }
+        }
+        float gain = (float)(m_gainSum / length);
+        if (gain < m_gain) {
+            m_gain = gain;
+        } else {
+            m_gain += (gain - m_gain) * m_releaseCoeff;
+        }
+
+        unsigned delayed = (frame - delay) & mask;
+        float delayedLeft = m_left[delayed];
+        float delayedRight = m_right[delayed];
+        m_left[slot] = left;
+        m_right[slot] = right;
+        left = delayedLeft * m_gain;
+        right = delayedRight * m_gain;
+    }
+
+    const Stages m_stages;
+    const float m_threshold = 0.9f;
+    const float m_ratio = 2.0f;
+    const float m_releaseTime = 0.1f;
+    float m_attackTime;
+    float m_peakLevel = 0.0f;
+    bool m_clipping = false;
+    float m_autoGain = 1.0f;
+
+    float m_left[kMaxLookAhead];
+    float m_right[kMaxLookAhead];
+    float m_gains[kMaxLookAhead];
+    unsigned m_peakFrames[kMaxLookAhead];
+    float m_peakValues[kMaxLookAhead];
+    unsigned m_peakHead = 0, m_peakTail = 0, m_frame = 0;
+    int m_length = 0, m_delay = 0;
+    double m_gainSum = 0.0;
+    float m_gain = 1.0f;
+    float m_releaseCoeff = 0.0f;
+    TruePeakDetector m_truePeakDetector;
+};
+
+}
+
+int main() {
+    // Noise with a slow swell, so every stage has something to do
+    const int totalFrames = 2 * 44100;
+    std::vector<float> inputLeft(totalFrames), inputRight(totalFrames);
+    std::mt19937 rng(3);
+    std::normal_distribution<float> noise(0.0f, 0.5f);
+    for (int i = 0; i < totalFrames; ++i) {
+        inputLeft[i] = noise(rng) * (1.0f + std::sin(i * 0.001f));
+        inputRight[i] = noise(rng);
+    }
+    const int blockSizes[] = {64, 128, 37, 512, 1000};
+
+    const Stages combinations[] = {
+        {true, false, false, true, true, false, false, 1.0f},    // the default chain
+        {true, true, false, true, true, false, false, 1.0f},
+        {false, true, false, false, true, true, false, 5.0f},
+        {true, false, true, true, true, false, false, 2.0f},
+        {false, false, false, false, false, false, false, 1.0f},
+        {true, true, true, true, true, true, true, 3.0f},
+        {false, true, false, true, false, true, true, 0.5f},
+    };
+
+    bool allMatch = true;
+    std::cout << "SK LA TP BW PK CI AG  attack  result" << std::endl;
+    for (const Stages& stages : combinations) {
+        ClubMixer mixer;
+        mixer.setSoftKneeCompressorEnabled(stages.softKnee);
+        mixer.setLookAheadLimiterEnabled(stages.lookAhead);
+        mixer.setTruePeakLimiterEnabled(stages.truePeak);
+        mixer.setBrickwallLimiterEnabled(stages.brickwall);
+        mixer.setPeakDetectionEnabled(stages.peakMeter);
+        mixer.setClippingIndicatorEnabled(stages.clipIndicator);
+        mixer.setAutoGainReductionEnabled(stages.autoGain);
+        mixer.setLimiterAttackTime(stages.attackMs);
+        ReferenceProtection reference(stages);
+
+        std::vector<float> left = inputLeft, right = inputRight;
+        std::vector<float> expectedLeft = inputLeft, expectedRight = inputRight;
+        for (int position = 0, block = 0; position < totalFrames; ++block) {
+            int frames = std::min(totalFrames - position, blockSizes[block % 5]);
+            mixer.applyOutputDSP(&left[position], &right[position], frames);
+            reference.process(&expectedLeft[position], &expectedRight[position], frames);
+            position += frames;
+        }
+
+        int mismatches = 0;
+        for (int i = kSettleFrames; i < totalFrames; ++i) {
+            mismatches += (left[i] != expectedLeft[i]) + (right[i] != expectedRight[i]);
+        }
+        bool peakMatches = mixer.getCurrentPeakLevel() == reference.peakLevel();
+        bool match = mismatches == 0 && peakMatches;
+        allMatch &= match;
+
+        for (bool on : {stages.softKnee, stages.lookAhead, stages.truePeak, stages.brickwall, stages.peakMeter,
+                        stages.clipIndicator, stages.autoGain}) {
+            std::cout << (on ? " * " : " . ");
+        }
+        std::cout << std::setw(5) << stages.attackMs << " ms  ";
+        if (match) {
+            std::cout << "identical" << std::endl;
+        } else {
+            std::cout << mismatches << " samples differ" << (peakMatches ? "" : ", peak level differs") << std::endl;
+        }
+    }
+    std::cout << (allMatch ? "All combinations bit-identical" : "MISMATCH") << std::endl;
+    return allMatch ? 0 : 1;
+}